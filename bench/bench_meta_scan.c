@@ -0,0 +1,136 @@
+/**
+ * bench_meta_scan - files per second of cgltf_vrm_parse_meta_file against the
+ * full cgltf_parse_file + cgltf_vrm_parse_cgltf_data path, on a synthetic corpus.
+ *
+ * Building (POSIX):
+ *   cc -O2 -I.. -I<path to cgltf> bench_meta_scan.c -o bench_meta_scan
+ *
+ * Usage:
+ *   bench_meta_scan [file_count] [texture_kb]
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#define CGLTF_IMPLEMENTATION
+#include "cgltf.h"
+#include "cgltf_vrm.h"
+
+#include "synth_vrm.h"
+
+#include <time.h>
+#include <unistd.h>
+
+static double bench_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv)
+{
+  int file_count = (argc > 1) ? atoi(argv[1]) : 256;
+  int texture_kb = (argc > 2) ? atoi(argv[2]) : 2048;
+  char dir[] = "/tmp/bench_meta_scan_XXXXXX";
+  char path[512];
+  size_t corpus_bytes = 0;
+  cgltf_options options;
+  int i;
+
+  if (file_count <= 0 || mkdtemp(dir) == NULL)
+  {
+    fprintf(stderr, "usage: bench_meta_scan [file_count] [texture_kb]\n");
+    return EXIT_FAILURE;
+  }
+
+  /* Corpus */
+  for (i = 0; i < file_count; ++i)
+  {
+    synth_vrm_config cfg;
+    size_t size;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.seed = (uint32_t)(i + 1);
+    cfg.bones = 20 + i % 36;
+    cfg.expressions = i % 8;
+    cfg.springs = 4 + i % 12;
+    cfg.joints_per_spring = 3 + i % 4;
+    cfg.colliders = 4 + i % 8;
+    cfg.mtoon_materials = 4 + i % 12;
+    cfg.texture_bytes = texture_kb * 1024;
+
+    unsigned char* glb = synth_vrm_glb(&cfg, &size);
+    snprintf(path, sizeof(path), "%s/avatar_%04d.vrm", dir, i);
+    FILE* file = fopen(path, "wb");
+    if (!file || fwrite(glb, 1, size, file) != size)
+    {
+      fprintf(stderr, "failed to write %s\n", path);
+      return EXIT_FAILURE;
+    }
+    fclose(file);
+    free(glb);
+    corpus_bytes += size;
+  }
+
+  memset(&options, 0, sizeof(options));
+
+  /* Metadata scan */
+  size_t bones = 0;
+  double start = bench_now();
+  for (i = 0; i < file_count; ++i)
+  {
+    cgltf_vrm_meta_summary summary;
+    snprintf(path, sizeof(path), "%s/avatar_%04d.vrm", dir, i);
+    if (cgltf_vrm_parse_meta_file(&options, path, &summary) != cgltf_result_success)
+    {
+      fprintf(stderr, "scan failed on %s\n", path);
+      return EXIT_FAILURE;
+    }
+    bones += summary.human_bones_count;
+    cgltf_vrm_meta_summary_free(&summary);
+  }
+  double scan_time = bench_now() - start;
+
+  /* Full parse */
+  size_t full_bones = 0;
+  start = bench_now();
+  for (i = 0; i < file_count; ++i)
+  {
+    cgltf_data* gltf = NULL;
+    cgltf_vrm_data vrm;
+    snprintf(path, sizeof(path), "%s/avatar_%04d.vrm", dir, i);
+    if (cgltf_parse_file(&options, path, &gltf) != cgltf_result_success)
+    {
+      fprintf(stderr, "cgltf_parse_file failed on %s\n", path);
+      return EXIT_FAILURE;
+    }
+    if (cgltf_vrm_parse_cgltf_data(&options, gltf, &vrm) != cgltf_result_success)
+    {
+      fprintf(stderr, "cgltf_vrm_parse_cgltf_data failed on %s\n", path);
+      cgltf_free(gltf);
+      return EXIT_FAILURE;
+    }
+    full_bones += vrm.core.humanoid.human_bones_count;
+    cgltf_vrm_free(&vrm);
+    cgltf_free(gltf);
+  }
+  double full_time = bench_now() - start;
+
+  if (bones != full_bones)
+  {
+    fprintf(stderr, "bone count mismatch: scan %zu, full %zu\n", bones, full_bones);
+  }
+
+  printf("corpus      : %d files, %.1f MiB\n", file_count, (double)corpus_bytes / (1024.0 * 1024.0));
+  printf("meta scan   : %10.1f files/s\n", file_count / scan_time);
+  printf("full parse  : %10.1f files/s\n", file_count / full_time);
+  printf("speedup     : %10.2fx\n", full_time / scan_time);
+
+  for (i = 0; i < file_count; ++i)
+  {
+    snprintf(path, sizeof(path), "%s/avatar_%04d.vrm", dir, i);
+    unlink(path);
+  }
+  rmdir(dir);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+/**
+ * bench_parse - cgltf_vrm_parse_cgltf_data and cgltf_vrm_free throughput, allocations
+ * and peak memory over synthetic avatars of increasing size.
+ *
+ * Building (POSIX):
+ *   cc -O2 -I.. -I<path to cgltf> bench_parse.c -o bench_parse
+ *
+ * Usage:
+ *   bench_parse [iterations]
+ *
+ * Prints one JSON object per scale point on stdout. Timings are the median of the
+ * iterations ; allocation counts and sizes are exact and stable between runs, so they
+ * can be diffed directly.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#define CGLTF_IMPLEMENTATION
+#include "cgltf.h"
+#include "cgltf_vrm.h"
+
+#include "synth_vrm.h"
+
+#include <time.h>
+
+typedef struct bench_scale
+{
+  const char* name;
+  synth_vrm_config config;
+} bench_scale;
+
+/* seed, bones, expressions, morph binds, material binds, springs, joints per spring, colliders, constrained nodes, materials, texture bytes */
+static const bench_scale bench_scales[] = {
+  { "minimal", { 1, 15, 0, 1, 0, 0, 0, 0, 0, 1, 256 } },
+  { "typical", { 2, 55, 8, 4, 1, 24, 4, 12, 4, 12, 256 } },
+  { "heavy", { 3, 55, 64, 16, 4, 128, 6, 48, 32, 48, 256 } },
+  { "extreme", { 4, 55, 256, 64, 8, 512, 8, 128, 256, 128, 256 } },
+};
+
+/* Counting allocator, each block is prefixed with its size. */
+typedef struct bench_memory
+{
+  size_t allocs;
+  size_t bytes;
+  size_t current;
+  size_t peak;
+} bench_memory;
+
+#define BENCH_HEADER 16
+
+static void* bench_alloc(void* user, cgltf_size size)
+{
+  bench_memory* memory = (bench_memory*)user;
+  unsigned char* block = (unsigned char*)malloc(size + BENCH_HEADER);
+  if (!block)
+  {
+    return NULL;
+  }
+  memcpy(block, &size, sizeof(size));
+  memory->allocs += 1;
+  memory->bytes += size;
+  memory->current += size;
+  if (memory->current > memory->peak)
+  {
+    memory->peak = memory->current;
+  }
+  return block + BENCH_HEADER;
+}
+
+static void bench_free(void* user, void* ptr)
+{
+  bench_memory* memory = (bench_memory*)user;
+  cgltf_size size;
+  if (!ptr)
+  {
+    return;
+  }
+  unsigned char* block = (unsigned char*)ptr - BENCH_HEADER;
+  memcpy(&size, block, sizeof(size));
+  memory->current -= size;
+  free(block);
+}
+
+static double bench_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int bench_compare_doubles(const void* a, const void* b)
+{
+  double da = *(const double*)a;
+  double db = *(const double*)b;
+  return (da > db) - (da < db);
+}
+
+int main(int argc, char** argv)
+{
+  int iterations = (argc > 1) ? atoi(argv[1]) : 200;
+  size_t s;
+
+  if (iterations <= 0)
+  {
+    fprintf(stderr, "usage: bench_parse [iterations]\n");
+    return EXIT_FAILURE;
+  }
+
+  double* parse_times = (double*)malloc(sizeof(double) * (size_t)iterations);
+  double* free_times = (double*)malloc(sizeof(double) * (size_t)iterations);
+
+  for (s = 0; s < sizeof(bench_scales) / sizeof(bench_scales[0]); ++s)
+  {
+    const bench_scale* scale = &bench_scales[s];
+    cgltf_options gltf_options;
+    cgltf_options options;
+    cgltf_data* gltf = NULL;
+    bench_memory memory;
+    size_t glb_size;
+    int i;
+
+    unsigned char* glb = synth_vrm_glb(&scale->config, &glb_size);
+
+    memset(&gltf_options, 0, sizeof(gltf_options));
+    if (cgltf_parse(&gltf_options, glb, glb_size, &gltf) != cgltf_result_success)
+    {
+      fprintf(stderr, "cgltf_parse failed on scale %s\n", scale->name);
+      return EXIT_FAILURE;
+    }
+
+    memset(&memory, 0, sizeof(memory));
+    memset(&options, 0, sizeof(options));
+    options.memory.alloc_func = bench_alloc;
+    options.memory.free_func = bench_free;
+    options.memory.user_data = &memory;
+
+    bench_memory first = memory;
+    cgltf_vrm_memory_report report;
+    for (i = 0; i < iterations; ++i)
+    {
+      cgltf_vrm_data vrm;
+
+      double start = bench_now();
+      if (cgltf_vrm_parse_cgltf_data(&options, gltf, &vrm) != cgltf_result_success)
+      {
+        fprintf(stderr, "cgltf_vrm_parse_cgltf_data failed on scale %s\n", scale->name);
+        return EXIT_FAILURE;
+      }
+      double parsed = bench_now();
+      if (i == 0)
+      {
+        cgltf_vrm_memory_stats(&vrm, &report);
+      }
+      cgltf_vrm_free(&vrm);
+      double freed = bench_now();
+
+      parse_times[i] = parsed - start;
+      free_times[i] = freed - parsed;
+      if (i == 0)
+      {
+        first = memory;
+      }
+    }
+
+    if (memory.current != 0)
+    {
+      fprintf(stderr, "%zu bytes leaked on scale %s\n", memory.current, scale->name);
+    }
+
+    qsort(parse_times, (size_t)iterations, sizeof(double), bench_compare_doubles);
+    qsort(free_times, (size_t)iterations, sizeof(double), bench_compare_doubles);
+    double parse_median = parse_times[iterations / 2];
+    double free_median = free_times[iterations / 2];
+
+    printf("{\"bench\":\"parse\",\"scale\":\"%s\",\"glb_bytes\":%zu,\"json_bytes\":%zu,\"iterations\":%d,"
+      "\"parse_ns\":%.0f,\"parse_min_ns\":%.0f,\"free_ns\":%.0f,\"json_mb_per_s\":%.2f,\"avatars_per_s\":%.1f,"
+      "\"allocs\":%zu,\"alloc_bytes\":%zu,\"peak_bytes\":%zu,\"vrm_bytes\":%zu,\"token_peak_bytes\":%zu}\n",
+      scale->name, glb_size, (size_t)gltf->json_size, iterations,
+      parse_median * 1e9, parse_times[0] * 1e9, free_median * 1e9,
+      (double)gltf->json_size / (parse_median * 1024.0 * 1024.0), 1.0 / (parse_median + free_median),
+      first.allocs, first.bytes, first.peak, report.total.bytes, report.parse_tokens.bytes);
+
+    cgltf_free(gltf);
+    free(glb);
+  }
+
+  free(parse_times);
+  free(free_times);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,452 @@
+/**
+ * bench_runtime - per frame cost of the runtime evaluators : spring bone stepping (collider update included),
+ * node constraints, expression weights to morph weights, and look at, for 1, 100 and 1000 avatars
+ * on one thread and on several.
+ *
+ * Building (POSIX):
+ *   cc -O2 -pthread -I.. -I<path to cgltf> bench_runtime.c -o bench_runtime -lm
+ *
+ * Usage:
+ *   bench_runtime [frames] [threads]
+ *
+ * Prints one JSON object per phase, avatar count and thread count on stdout. Times are wall clock, so
+ * `ns_per_avatar` is a throughput when several threads run. `joints` counts what a phase iterates per
+ * avatar : simulated spring joints, constraints, expressions, or 1 for look at. On Linux, `cycles` and
+ * `cache_misses` per avatar come from perf_event_open, they are null when the counters are not available
+ * (eg. perf_event_paranoid or a virtual machine without a PMU).
+ */
+#define _GNU_SOURCE
+
+#define CGLTF_IMPLEMENTATION
+#include "cgltf.h"
+#include "cgltf_vrm.h"
+
+#include "synth_vrm.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#define BENCH_MAX_THREADS 64
+
+/* seed, bones, expressions, morph binds, material binds, springs, joints per spring, colliders, constrained nodes, materials, texture bytes */
+static const synth_vrm_config bench_config = { 5, 55, 16, 4, 1, 32, 6, 16, 16, 12, 256 };
+
+static const size_t bench_avatar_counts[] = { 1, 100, 1000 };
+
+typedef enum bench_phase
+{
+  bench_phase_spring,
+  bench_phase_constraints,
+  bench_phase_expressions,
+  bench_phase_look_at,
+  bench_phase_count,
+} bench_phase;
+
+static const char* const bench_phase_names[bench_phase_count] = { "spring", "constraints", "expressions", "look_at" };
+
+/* Read only data shared by every avatar instance. */
+typedef struct bench_shared
+{
+  unsigned char* glb; /* cgltf_data.json and bin point into it */
+  cgltf_data* gltf;
+  cgltf_vrm_data vrm;
+  cgltf_vrm_node_constraint_set constraints;
+  cgltf_vrm_expression_table expressions;
+  cgltf_float* rest_world;
+  cgltf_float* rest_rotations;
+  cgltf_size head;
+} bench_shared;
+
+/* Per avatar runtime state. */
+typedef struct bench_avatar
+{
+  cgltf_float* world;
+  cgltf_float* rotations;
+  cgltf_vrm_spring_bone_collider_set colliders;
+  cgltf_vrm_spring_bone_state springs;
+  cgltf_float* weights;
+  cgltf_float* resolved;
+  cgltf_float* morph_weights;
+  cgltf_vrm_look_at_pose pose;
+} bench_avatar;
+
+typedef struct bench_job
+{
+  bench_shared const* shared;
+  bench_avatar* avatars;
+  size_t begin;
+  size_t end;
+  bench_phase phase;
+  int frames;
+} bench_job;
+
+static double bench_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* -------------------------------------------------------------------------- */
+/* -- Hardware counters -- */
+
+typedef struct bench_counters
+{
+  int fds[2]; /* cycles, cache misses, -1 when unavailable */
+} bench_counters;
+
+static void bench_counters_open(bench_counters* counters)
+{
+  counters->fds[0] = counters->fds[1] = -1;
+#ifdef __linux__
+  static const uint64_t configs[2] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES };
+  for (int i = 0; i < 2; ++i)
+  {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = configs[i];
+    attr.disabled = 1;
+    attr.inherit = 1; /* worker threads are created after the counters are opened */
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    counters->fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+#endif
+}
+
+static void bench_counters_start(bench_counters* counters)
+{
+#ifdef __linux__
+  for (int i = 0; i < 2; ++i)
+  {
+    if (counters->fds[i] >= 0)
+    {
+      ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#else
+  (void)counters;
+#endif
+}
+
+static void bench_counters_stop(bench_counters* counters, double* out_values)
+{
+  for (int i = 0; i < 2; ++i)
+  {
+    out_values[i] = -1.0;
+#ifdef __linux__
+    uint64_t value;
+    if (counters->fds[i] >= 0)
+    {
+      ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+      if (read(counters->fds[i], &value, sizeof(value)) == (ssize_t)sizeof(value))
+      {
+        out_values[i] = (double)value;
+      }
+    }
+#endif
+  }
+}
+
+static void bench_counters_close(bench_counters* counters)
+{
+  for (int i = 0; i < 2; ++i)
+  {
+    if (counters->fds[i] >= 0)
+    {
+      close(counters->fds[i]);
+    }
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* -- Avatars -- */
+
+static int bench_shared_init(bench_shared* shared)
+{
+  cgltf_options options;
+  size_t glb_size;
+
+  memset(shared, 0, sizeof(*shared));
+  memset(&options, 0, sizeof(options));
+  shared->glb = synth_vrm_glb(&bench_config, &glb_size);
+  if (cgltf_parse(&options, shared->glb, glb_size, &shared->gltf) != cgltf_result_success)
+  {
+    return 0;
+  }
+
+  if (cgltf_vrm_parse_cgltf_data(&options, shared->gltf, &shared->vrm) != cgltf_result_success ||
+    cgltf_vrm_node_constraint_set_init(&options, shared->gltf, &shared->vrm, &shared->constraints) != cgltf_result_success ||
+    cgltf_vrm_expression_table_init(&options, shared->gltf, &shared->vrm, &shared->expressions) != cgltf_result_success)
+  {
+    return 0;
+  }
+
+  cgltf_size nodes_count = shared->gltf->nodes_count;
+  shared->rest_world = (cgltf_float*)malloc(sizeof(cgltf_float) * 16 * nodes_count);
+  shared->rest_rotations = (cgltf_float*)malloc(sizeof(cgltf_float) * 4 * nodes_count);
+  for (cgltf_size n = 0; n < nodes_count; ++n)
+  {
+    cgltf_node_transform_world(&shared->gltf->nodes[n], shared->rest_world + 16 * n);
+    memcpy(shared->rest_rotations + 4 * n, shared->gltf->nodes[n].rotation, sizeof(cgltf_float) * 4);
+  }
+
+  for (cgltf_size b = 0; b < shared->vrm.core.humanoid.human_bones_count; ++b)
+  {
+    cgltf_vrm_humanoid_bone const* bone = &shared->vrm.core.humanoid.human_bones[b];
+    if (bone->type == cgltf_vrm_humanoid_bone_type_head && bone->node)
+    {
+      shared->head = (cgltf_size)(bone->node - shared->gltf->nodes);
+    }
+  }
+
+  return 1;
+}
+
+static void bench_shared_free(bench_shared* shared)
+{
+  free(shared->rest_world);
+  free(shared->rest_rotations);
+  cgltf_vrm_expression_table_free(&shared->expressions);
+  cgltf_vrm_node_constraint_set_free(&shared->constraints);
+  cgltf_vrm_free(&shared->vrm);
+  cgltf_free(shared->gltf);
+  free(shared->glb);
+}
+
+static int bench_avatar_init(bench_avatar* avatar, bench_shared const* shared)
+{
+  cgltf_options options;
+  cgltf_size nodes_count = shared->gltf->nodes_count;
+
+  memset(avatar, 0, sizeof(*avatar));
+  memset(&options, 0, sizeof(options));
+
+  avatar->world = (cgltf_float*)malloc(sizeof(cgltf_float) * 16 * nodes_count);
+  avatar->rotations = (cgltf_float*)malloc(sizeof(cgltf_float) * 4 * nodes_count);
+  avatar->weights = (cgltf_float*)calloc(shared->expressions.entries_count + 1, sizeof(cgltf_float));
+  avatar->resolved = (cgltf_float*)calloc(shared->expressions.entries_count + 1, sizeof(cgltf_float));
+  avatar->morph_weights = (cgltf_float*)calloc(shared->expressions.morph_targets_count + 1, sizeof(cgltf_float));
+  if (!avatar->world || !avatar->rotations || !avatar->weights || !avatar->resolved || !avatar->morph_weights)
+  {
+    return 0;
+  }
+
+  memcpy(avatar->world, shared->rest_world, sizeof(cgltf_float) * 16 * nodes_count);
+  memcpy(avatar->rotations, shared->rest_rotations, sizeof(cgltf_float) * 4 * nodes_count);
+
+  return cgltf_vrm_spring_bone_collider_set_init(&options, &shared->vrm.spring_bone, &avatar->colliders) == cgltf_result_success &&
+    cgltf_vrm_spring_bone_state_init(&options, shared->gltf, &shared->vrm.spring_bone, &avatar->springs) == cgltf_result_success;
+}
+
+static void bench_avatar_free(bench_avatar* avatar)
+{
+  cgltf_vrm_spring_bone_state_free(&avatar->springs);
+  cgltf_vrm_spring_bone_collider_set_free(&avatar->colliders);
+  free(avatar->world);
+  free(avatar->rotations);
+  free(avatar->weights);
+  free(avatar->resolved);
+  free(avatar->morph_weights);
+}
+
+static void bench_avatar_run(bench_shared const* shared, bench_avatar* avatar, bench_phase phase, int frame)
+{
+  cgltf_data const* gltf = shared->gltf;
+  cgltf_float t = (cgltf_float)frame * (1.0f / 60.0f);
+
+  switch (phase)
+  {
+    case bench_phase_spring:
+      /* the animated pose would be written here, the rest pose stands in for it */
+      memcpy(avatar->world, shared->rest_world, sizeof(cgltf_float) * 16 * gltf->nodes_count);
+      cgltf_vrm_spring_bone_collider_set_update(&avatar->colliders, gltf, &shared->vrm.spring_bone, avatar->world);
+      cgltf_vrm_spring_bone_state_step(&avatar->springs, gltf, &avatar->colliders, avatar->world, 1.0f / 60.0f);
+      break;
+
+    case bench_phase_constraints:
+      cgltf_vrm_node_constraint_set_evaluate(&shared->constraints, avatar->rotations, avatar->world);
+      break;
+
+    case bench_phase_expressions:
+      avatar->weights[(cgltf_size)frame % shared->expressions.entries_count] = 0.5f + 0.5f * sinf(t);
+      cgltf_vrm_expression_table_resolve_weights(&shared->expressions, avatar->weights, avatar->resolved);
+      memset(avatar->morph_weights, 0, sizeof(cgltf_float) * shared->expressions.morph_targets_count);
+      cgltf_vrm_expression_table_evaluate_morphs(&shared->expressions, avatar->resolved, avatar->morph_weights);
+      break;
+
+    case bench_phase_look_at:
+    {
+      cgltf_float const* head = avatar->world + 16 * shared->head;
+      cgltf_float target[3] = { head[12] + sinf(t), head[13] + 0.5f * cosf(t), head[14] + 1.0f };
+      cgltf_vrm_look_at_evaluate(&shared->vrm.core.look_at, head, target, &avatar->pose);
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+static void* bench_worker(void* arg)
+{
+  bench_job const* job = (bench_job const*)arg;
+
+  for (int f = 0; f < job->frames; ++f)
+  {
+    for (size_t a = job->begin; a < job->end; ++a)
+    {
+      bench_avatar_run(job->shared, &job->avatars[a], job->phase, f);
+    }
+  }
+
+  return NULL;
+}
+
+static size_t bench_phase_joints(bench_shared const* shared, bench_avatar const* avatar, bench_phase phase)
+{
+  switch (phase)
+  {
+    case bench_phase_spring: return avatar->springs.joints_count;
+    case bench_phase_constraints: return shared->constraints.constraints_count;
+    case bench_phase_expressions: return shared->expressions.entries_count;
+    default: return 1;
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char** argv)
+{
+  int frames = (argc > 1) ? atoi(argv[1]) : 600;
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  int threads = (argc > 2) ? atoi(argv[2]) : (int)((online > 0) ? online : 1);
+  int status = EXIT_SUCCESS;
+  bench_shared shared;
+
+  if (frames <= 0 || threads <= 0)
+  {
+    fprintf(stderr, "usage: bench_runtime [frames] [threads]\n");
+    return EXIT_FAILURE;
+  }
+  threads = (threads < BENCH_MAX_THREADS) ? threads : BENCH_MAX_THREADS;
+
+  if (!bench_shared_init(&shared))
+  {
+    fprintf(stderr, "failed to load the synthetic avatar\n");
+    bench_shared_free(&shared);
+    return EXIT_FAILURE;
+  }
+
+  for (size_t c = 0; status == EXIT_SUCCESS && c < sizeof(bench_avatar_counts) / sizeof(bench_avatar_counts[0]); ++c)
+  {
+    size_t avatars_count = bench_avatar_counts[c];
+    bench_avatar* avatars = (bench_avatar*)calloc(avatars_count, sizeof(bench_avatar));
+
+    if (!avatars)
+    {
+      fprintf(stderr, "out of memory\n");
+      status = EXIT_FAILURE;
+      break;
+    }
+
+    for (size_t a = 0; a < avatars_count; ++a)
+    {
+      if (!bench_avatar_init(&avatars[a], &shared))
+      {
+        fprintf(stderr, "out of memory\n");
+        status = EXIT_FAILURE;
+        break;
+      }
+    }
+
+    /* single threaded, then with every worker when there are more than one */
+    for (int pass = 0; status == EXIT_SUCCESS && pass < ((threads > 1) ? 2 : 1); ++pass)
+    {
+      size_t workers = pass ? (size_t)threads : 1;
+      workers = (workers < avatars_count) ? workers : avatars_count;
+
+      for (int p = 0; p < bench_phase_count; ++p)
+      {
+        pthread_t handles[BENCH_MAX_THREADS];
+        bench_job jobs[BENCH_MAX_THREADS];
+        bench_counters counters;
+        double values[2];
+
+        for (size_t w = 0; w < workers; ++w)
+        {
+          jobs[w].shared = &shared;
+          jobs[w].avatars = avatars;
+          jobs[w].begin = avatars_count * w / workers;
+          jobs[w].end = avatars_count * (w + 1) / workers;
+          jobs[w].phase = (bench_phase)p;
+          jobs[w].frames = frames;
+        }
+
+        bench_counters_open(&counters);
+        bench_counters_start(&counters);
+        double start = bench_now();
+        if (workers == 1)
+        {
+          bench_worker(&jobs[0]);
+        }
+        else
+        {
+          for (size_t w = 0; w < workers; ++w)
+          {
+            pthread_create(&handles[w], NULL, bench_worker, &jobs[w]);
+          }
+          for (size_t w = 0; w < workers; ++w)
+          {
+            pthread_join(handles[w], NULL);
+          }
+        }
+        double elapsed = bench_now() - start;
+        bench_counters_stop(&counters, values);
+        bench_counters_close(&counters);
+
+        double evaluations = (double)frames * (double)avatars_count;
+        double ns_per_avatar = elapsed * 1e9 / evaluations;
+        size_t joints = bench_phase_joints(&shared, &avatars[0], (bench_phase)p);
+        char cycles[32];
+        char misses[32];
+        strcpy(cycles, "null");
+        strcpy(misses, "null");
+        if (values[0] >= 0.0)
+        {
+          snprintf(cycles, sizeof(cycles), "%.0f", values[0] / evaluations);
+        }
+        if (values[1] >= 0.0)
+        {
+          snprintf(misses, sizeof(misses), "%.2f", values[1] / evaluations);
+        }
+
+        printf("{\"bench\":\"runtime\",\"phase\":\"%s\",\"avatars\":%zu,\"threads\":%zu,\"frames\":%d,\"joints\":%zu,"
+          "\"ns_per_avatar\":%.1f,\"ns_per_joint\":%.2f,\"cycles\":%s,\"cache_misses\":%s}\n",
+          bench_phase_names[p], avatars_count, workers, frames, joints,
+          ns_per_avatar, joints ? ns_per_avatar / (double)joints : 0.0, cycles, misses);
+      }
+    }
+
+    /* avatars left uninitialized after a failure are still zeroed, freeing them is a no-op */
+    for (size_t a = 0; a < avatars_count; ++a)
+    {
+      bench_avatar_free(&avatars[a]);
+    }
+    free(avatars);
+  }
+
+  bench_shared_free(&shared);
+
+  return status;
+}
@@ -0,0 +1,282 @@
+/**
+ * synth_vrm.h - deterministic synthetic VRM 1.0 generator used by the benchmarks.
+ *
+ * Emits a complete GLB in memory: VRMC_vrm (meta, humanoid, expressions),
+ * VRMC_springBone, VRMC_node_constraint and VRMC_materials_mtoon materials,
+ * plus an opaque binary chunk standing in for texture data. The same config and seed always
+ * produce the same bytes.
+ */
+#ifndef SYNTH_VRM_H_INCLUDED__
+#define SYNTH_VRM_H_INCLUDED__
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct synth_vrm_config
+{
+  uint32_t seed;
+
+  int bones;              /* humanoid bones, capped to the 55 VRM bone names */
+  int expressions;        /* custom expressions added after the 18 presets */
+  int morph_binds;        /* per expression, at least 1 */
+  int material_binds;     /* material color binds per expression, plus one texture transform bind when > 0 */
+  int springs;
+  int joints_per_spring;
+  int colliders;
+  int constrained_nodes;  /* extra nodes below the hips with a roll, aim or rotation constraint */
+  int mtoon_materials;
+  int texture_bytes;      /* size of the binary chunk referenced by a single image */
+} synth_vrm_config;
+
+static const char* const synth_vrm_bone_names[] = {
+  "hips", "spine", "chest", "upperChest", "neck", "head", "leftEye", "rightEye", "jaw",
+  "leftUpperLeg", "leftLowerLeg", "leftFoot", "leftToes", "rightUpperLeg", "rightLowerLeg", "rightFoot", "rightToes",
+  "leftShoulder", "leftUpperArm", "leftLowerArm", "leftHand", "rightShoulder", "rightUpperArm", "rightLowerArm", "rightHand",
+  "leftThumbMetacarpal", "leftThumbProximal", "leftThumbDistal", "leftIndexProximal", "leftIndexIntermediate", "leftIndexDistal",
+  "leftMiddleProximal", "leftMiddleIntermediate", "leftMiddleDistal", "leftRingProximal", "leftRingIntermediate", "leftRingDistal",
+  "leftLittleProximal", "leftLittleIntermediate", "leftLittleDistal",
+  "rightThumbMetacarpal", "rightThumbProximal", "rightThumbDistal", "rightIndexProximal", "rightIndexIntermediate", "rightIndexDistal",
+  "rightMiddleProximal", "rightMiddleIntermediate", "rightMiddleDistal", "rightRingProximal", "rightRingIntermediate", "rightRingDistal",
+  "rightLittleProximal", "rightLittleIntermediate", "rightLittleDistal",
+};
+
+static const char* const synth_vrm_preset_names[] = {
+  "happy", "angry", "sad", "relaxed", "surprised", "aa", "ih", "ou", "ee", "oh",
+  "blink", "blinkLeft", "blinkRight", "lookUp", "lookDown", "lookLeft", "lookRight", "neutral",
+};
+
+typedef struct synth_vrm_buffer
+{
+  char* data;
+  size_t size;
+  size_t capacity;
+} synth_vrm_buffer;
+
+static void synth_vrm_printf(synth_vrm_buffer* buf, const char* fmt, ...)
+{
+  for (;;)
+  {
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf->data + buf->size, buf->capacity - buf->size, fmt, args);
+    va_end(args);
+
+    if (n >= 0 && (size_t)n < buf->capacity - buf->size)
+    {
+      buf->size += (size_t)n;
+      return;
+    }
+
+    buf->capacity = buf->capacity ? 2 * buf->capacity : 4096;
+    buf->data = (char*)realloc(buf->data, buf->capacity);
+  }
+}
+
+static uint32_t synth_vrm_rand(uint32_t* state)
+{
+  /* xorshift32 */
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static float synth_vrm_randf(uint32_t* state)
+{
+  return (float)(synth_vrm_rand(state) & 0xFFFF) / 65535.0f;
+}
+
+/* Returns a malloc'ed GLB of *out_size bytes. */
+static unsigned char* synth_vrm_glb(const synth_vrm_config* cfg, size_t* out_size)
+{
+  synth_vrm_buffer json = { NULL, 0, 0 };
+  uint32_t rng = cfg->seed ? cfg->seed : 0x9E3779B9u;
+  int bones = cfg->bones < 55 ? cfg->bones : 55;
+  int spring_nodes = cfg->springs * cfg->joints_per_spring;
+  int constrained = cfg->constrained_nodes > 0 ? cfg->constrained_nodes : 0;
+  int nodes = bones + spring_nodes;
+  int expressions = 18 + cfg->expressions;
+  int morph_binds = cfg->morph_binds > 1 ? cfg->morph_binds : 1;
+  int material_binds = cfg->mtoon_materials > 0 ? cfg->material_binds : 0;
+  int i, j;
+
+  if (bones < 1) bones = 1;
+  nodes = bones + spring_nodes + constrained;
+
+  synth_vrm_printf(&json, "{\"asset\":{\"version\":\"2.0\",\"generator\":\"synth_vrm\"},");
+  synth_vrm_printf(&json, "\"extensionsUsed\":[\"VRMC_vrm\",\"VRMC_springBone\",\"VRMC_materials_mtoon\"%s],", constrained ? ",\"VRMC_node_constraint\"" : "");
+  synth_vrm_printf(&json, "\"scene\":0,\"scenes\":[{\"nodes\":[0]}],");
+
+  /* Nodes : the bones form a chain, each spring hangs below a bone, the constrained nodes below the hips. */
+  synth_vrm_printf(&json, "\"nodes\":[");
+  for (i = 0; i < nodes; ++i)
+  {
+    synth_vrm_printf(&json, "%s{\"name\":\"node_%d\",\"translation\":[%.3f,%.3f,%.3f]", i ? "," : "", i,
+      synth_vrm_randf(&rng) * 0.1f, 0.1f + synth_vrm_randf(&rng) * 0.1f, 0.0f);
+
+    int first_child = -1, second_child = -1;
+    if (i + 1 < bones) first_child = i + 1;
+    if (i < bones && i < cfg->springs) second_child = bones + i * cfg->joints_per_spring;
+    if (i >= bones && i < bones + spring_nodes && ((i - bones + 1) % cfg->joints_per_spring) != 0) first_child = i + 1; /* spring nodes imply joints_per_spring > 0 */
+
+    if (first_child >= 0 || second_child >= 0 || (i == 0 && constrained))
+    {
+      synth_vrm_printf(&json, ",\"children\":[");
+      if (first_child >= 0) synth_vrm_printf(&json, "%d", first_child);
+      if (second_child >= 0) synth_vrm_printf(&json, "%s%d", first_child >= 0 ? "," : "", second_child);
+      for (j = 0; i == 0 && j < constrained; ++j)
+      {
+        synth_vrm_printf(&json, "%s%d", (j || first_child >= 0 || second_child >= 0) ? "," : "", bones + spring_nodes + j);
+      }
+      synth_vrm_printf(&json, "]");
+    }
+
+    if (i >= bones + spring_nodes)
+    {
+      static const char* const types[] = { "roll", "aim", "rotation" };
+      static const char* const axes[] = { ",\"rollAxis\":\"Y\"", ",\"aimAxis\":\"PositiveY\"", "" };
+      int k = i - bones - spring_nodes;
+      synth_vrm_printf(&json, ",\"extensions\":{\"VRMC_node_constraint\":{\"specVersion\":\"1.0\",\"constraint\":{\"%s\":{\"source\":%d%s,\"weight\":%.3f}}}}",
+        types[k % 3], k % bones, axes[k % 3], 0.5f + 0.5f * synth_vrm_randf(&rng));
+    }
+    synth_vrm_printf(&json, "}");
+  }
+  synth_vrm_printf(&json, "],");
+
+  /* Texture data */
+  synth_vrm_printf(&json, "\"buffers\":[{\"byteLength\":%d}],", cfg->texture_bytes);
+  synth_vrm_printf(&json, "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%d}],", cfg->texture_bytes);
+  synth_vrm_printf(&json, "\"images\":[{\"bufferView\":0,\"mimeType\":\"image/png\"}],");
+  synth_vrm_printf(&json, "\"textures\":[{\"source\":0}],");
+
+  /* Materials */
+  synth_vrm_printf(&json, "\"materials\":[");
+  for (i = 0; i < cfg->mtoon_materials; ++i)
+  {
+    synth_vrm_printf(&json, "%s{\"name\":\"mtoon_%d\",\"pbrMetallicRoughness\":{\"baseColorFactor\":[1,1,1,1],\"baseColorTexture\":{\"index\":0}},", i ? "," : "", i);
+    synth_vrm_printf(&json, "\"extensions\":{\"VRMC_materials_mtoon\":{\"specVersion\":\"1.0\",\"transparentWithZWrite\":%s,\"renderQueueOffsetNumber\":%d,",
+      (i & 1) ? "true" : "false", (int)(synth_vrm_rand(&rng) % 10));
+    synth_vrm_printf(&json, "\"shadeColorFactor\":[%.3f,%.3f,%.3f],\"shadeMultiplyTexture\":{\"index\":0},\"shadingToonyFactor\":0.9,\"shadingShiftFactor\":0.0,",
+      synth_vrm_randf(&rng), synth_vrm_randf(&rng), synth_vrm_randf(&rng));
+    synth_vrm_printf(&json, "\"giEqualizationFactor\":0.9,\"matcapFactor\":[1,1,1],\"parametricRimColorFactor\":[0,0,0],\"parametricRimFresnelPowerFactor\":5.0,\"parametricRimLiftFactor\":0.0,\"rimLightingMixFactor\":1.0,");
+    synth_vrm_printf(&json, "\"outlineWidthMode\":\"%s\",\"outlineWidthFactor\":0.002,\"outlineColorFactor\":[0,0,0],\"outlineLightingMixFactor\":1.0,",
+      (i % 3 == 0) ? "worldCoordinates" : "none");
+    synth_vrm_printf(&json, "\"uvAnimationScrollXSpeedFactor\":%s,\"uvAnimationScrollYSpeedFactor\":0,\"uvAnimationRotationSpeedFactor\":0}}}",
+      (i % 4 == 0) ? "0.5" : "0");
+  }
+  synth_vrm_printf(&json, "],");
+
+  /* VRMC_vrm */
+  synth_vrm_printf(&json, "\"extensions\":{\"VRMC_vrm\":{\"specVersion\":\"1.0\",");
+  synth_vrm_printf(&json, "\"meta\":{\"name\":\"synthetic avatar %u\",\"version\":\"1.0\",\"authors\":[\"synth_vrm\",\"author %u\"],", cfg->seed, synth_vrm_rand(&rng) % 1000);
+  synth_vrm_printf(&json, "\"licenseUrl\":\"https://vrm.dev/licenses/1.0/\",\"thumbnailImage\":0,\"avatarPermission\":\"%s\",\"commercialUsage\":\"%s\",",
+    (cfg->seed & 1) ? "everyone" : "onlyAuthor", (cfg->seed & 2) ? "corporation" : "personalNonProfit");
+  synth_vrm_printf(&json, "\"creditNotation\":\"required\",\"allowRedistribution\":false,\"modification\":\"prohibited\",\"allowExcessivelyViolentUsage\":false,\"allowExcessivelySexualUsage\":false,");
+  synth_vrm_printf(&json, "\"allowPoliticalOrReligiousUsage\":false,\"allowAntisocialOrHateUsage\":false},");
+
+  synth_vrm_printf(&json, "\"humanoid\":{\"humanBones\":{");
+  for (i = 0; i < bones; ++i)
+  {
+    synth_vrm_printf(&json, "%s\"%s\":{\"node\":%d}", i ? "," : "", synth_vrm_bone_names[i], i);
+  }
+  synth_vrm_printf(&json, "}},");
+
+  synth_vrm_printf(&json, "\"expressions\":{\"preset\":{");
+  for (i = 0; i < expressions; ++i)
+  {
+    if (i == 18)
+    {
+      synth_vrm_printf(&json, "},\"custom\":{");
+    }
+    if (i < 18)
+    {
+      synth_vrm_printf(&json, "%s\"%s\":{", i ? "," : "", synth_vrm_preset_names[i]);
+    }
+    else
+    {
+      synth_vrm_printf(&json, "%s\"custom_%d\":{", (i > 18) ? "," : "", i - 18);
+    }
+    synth_vrm_printf(&json, "\"isBinary\":false,\"morphTargetBinds\":[");
+    for (j = 0; j < morph_binds; ++j)
+    {
+      synth_vrm_printf(&json, "%s{\"node\":0,\"index\":%d,\"weight\":1.0}", j ? "," : "", i + j * expressions);
+    }
+    synth_vrm_printf(&json, "]");
+    if (material_binds > 0)
+    {
+      synth_vrm_printf(&json, ",\"materialColorBinds\":[");
+      for (j = 0; j < material_binds; ++j)
+      {
+        synth_vrm_printf(&json, "%s{\"material\":%d,\"type\":\"%s\",\"targetValue\":[%.3f,%.3f,%.3f,1]}", j ? "," : "", (i + j) % cfg->mtoon_materials,
+          (j & 1) ? "shadeColor" : "color", synth_vrm_randf(&rng), synth_vrm_randf(&rng), synth_vrm_randf(&rng));
+      }
+      synth_vrm_printf(&json, "],\"textureTransformBinds\":[{\"material\":%d,\"scale\":[1,1],\"offset\":[%.3f,0]}]", i % cfg->mtoon_materials, synth_vrm_randf(&rng));
+    }
+    synth_vrm_printf(&json, "}");
+  }
+  synth_vrm_printf(&json, "}}},");
+
+  /* VRMC_springBone */
+  synth_vrm_printf(&json, "\"VRMC_springBone\":{\"specVersion\":\"1.0\",\"colliders\":[");
+  for (i = 0; i < cfg->colliders; ++i)
+  {
+    if (i & 1)
+    {
+      synth_vrm_printf(&json, "%s{\"node\":%d,\"shape\":{\"capsule\":{\"offset\":[0,0,0],\"radius\":%.3f,\"tail\":[0,0.1,0]}}}", i ? "," : "", i % bones, 0.02f + synth_vrm_randf(&rng) * 0.05f);
+    }
+    else
+    {
+      synth_vrm_printf(&json, "%s{\"node\":%d,\"shape\":{\"sphere\":{\"offset\":[0,0.05,0],\"radius\":%.3f}}}", i ? "," : "", i % bones, 0.02f + synth_vrm_randf(&rng) * 0.05f);
+    }
+  }
+  synth_vrm_printf(&json, "],\"colliderGroups\":[{\"name\":\"body\",\"colliders\":[");
+  for (i = 0; i < cfg->colliders; ++i)
+  {
+    synth_vrm_printf(&json, "%s%d", i ? "," : "", i);
+  }
+  synth_vrm_printf(&json, "]}],\"springs\":[");
+  for (i = 0; i < cfg->springs; ++i)
+  {
+    synth_vrm_printf(&json, "%s{\"name\":\"spring_%d\",\"joints\":[", i ? "," : "", i);
+    for (j = 0; j < cfg->joints_per_spring; ++j)
+    {
+      synth_vrm_printf(&json, "%s{\"node\":%d,\"hitRadius\":0.02,\"stiffness\":%.3f,\"gravityPower\":0,\"gravityDir\":[0,-1,0],\"dragForce\":0.4}",
+        j ? "," : "", bones + i * cfg->joints_per_spring + j, 0.5f + synth_vrm_randf(&rng));
+    }
+    synth_vrm_printf(&json, "]%s}", cfg->colliders > 0 ? ",\"colliderGroups\":[0]" : "");
+  }
+  synth_vrm_printf(&json, "]}}}");
+
+  /* GLB container, both chunks padded to 4 bytes. */
+  {
+    uint32_t json_length = (uint32_t)((json.size + 3) & ~(size_t)3);
+    uint32_t bin_length = (uint32_t)((cfg->texture_bytes + 3) & ~3);
+    uint32_t total = 12 + 8 + json_length + (bin_length ? 8 + bin_length : 0);
+    unsigned char* glb = (unsigned char*)malloc(total);
+    uint32_t header[5] = { 0x46546C67u, 2u, total, json_length, 0x4E4F534Au };
+    uint32_t bin_header[2] = { bin_length, 0x004E4942u };
+
+    memcpy(glb, header, sizeof(header));
+    memcpy(glb + 20, json.data, json.size);
+    memset(glb + 20 + json.size, ' ', json_length - json.size);
+    if (bin_length)
+    {
+      memcpy(glb + 20 + json_length, bin_header, sizeof(bin_header));
+      for (i = 0; i < (int)bin_length; ++i)
+      {
+        glb[28 + json_length + i] = (unsigned char)synth_vrm_rand(&rng);
+      }
+    }
+
+    free(json.data);
+    *out_size = total;
+    return glb;
+  }
+}
+
+#endif /* SYNTH_VRM_H_INCLUDED__ */
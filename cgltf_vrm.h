@@ -43,9 +43,70 @@ typedef enum cgltf_vrm_spec_version
 
 /* VRMC_vrm.humanoid */
 
+typedef enum cgltf_vrm_humanoid_bone_type
+{
+  cgltf_vrm_humanoid_bone_type_hips,
+  cgltf_vrm_humanoid_bone_type_spine,
+  cgltf_vrm_humanoid_bone_type_chest,
+  cgltf_vrm_humanoid_bone_type_upper_chest,
+  cgltf_vrm_humanoid_bone_type_neck,
+  cgltf_vrm_humanoid_bone_type_head,
+  cgltf_vrm_humanoid_bone_type_left_eye,
+  cgltf_vrm_humanoid_bone_type_right_eye,
+  cgltf_vrm_humanoid_bone_type_jaw,
+  cgltf_vrm_humanoid_bone_type_left_upper_leg,
+  cgltf_vrm_humanoid_bone_type_left_lower_leg,
+  cgltf_vrm_humanoid_bone_type_left_foot,
+  cgltf_vrm_humanoid_bone_type_left_toes,
+  cgltf_vrm_humanoid_bone_type_right_upper_leg,
+  cgltf_vrm_humanoid_bone_type_right_lower_leg,
+  cgltf_vrm_humanoid_bone_type_right_foot,
+  cgltf_vrm_humanoid_bone_type_right_toes,
+  cgltf_vrm_humanoid_bone_type_left_shoulder,
+  cgltf_vrm_humanoid_bone_type_left_upper_arm,
+  cgltf_vrm_humanoid_bone_type_left_lower_arm,
+  cgltf_vrm_humanoid_bone_type_left_hand,
+  cgltf_vrm_humanoid_bone_type_right_shoulder,
+  cgltf_vrm_humanoid_bone_type_right_upper_arm,
+  cgltf_vrm_humanoid_bone_type_right_lower_arm,
+  cgltf_vrm_humanoid_bone_type_right_hand,
+  cgltf_vrm_humanoid_bone_type_left_thumb_metacarpal,
+  cgltf_vrm_humanoid_bone_type_left_thumb_proximal,
+  cgltf_vrm_humanoid_bone_type_left_thumb_distal,
+  cgltf_vrm_humanoid_bone_type_left_index_proximal,
+  cgltf_vrm_humanoid_bone_type_left_index_intermediate,
+  cgltf_vrm_humanoid_bone_type_left_index_distal,
+  cgltf_vrm_humanoid_bone_type_left_middle_proximal,
+  cgltf_vrm_humanoid_bone_type_left_middle_intermediate,
+  cgltf_vrm_humanoid_bone_type_left_middle_distal,
+  cgltf_vrm_humanoid_bone_type_left_ring_proximal,
+  cgltf_vrm_humanoid_bone_type_left_ring_intermediate,
+  cgltf_vrm_humanoid_bone_type_left_ring_distal,
+  cgltf_vrm_humanoid_bone_type_left_little_proximal,
+  cgltf_vrm_humanoid_bone_type_left_little_intermediate,
+  cgltf_vrm_humanoid_bone_type_left_little_distal,
+  cgltf_vrm_humanoid_bone_type_right_thumb_metacarpal,
+  cgltf_vrm_humanoid_bone_type_right_thumb_proximal,
+  cgltf_vrm_humanoid_bone_type_right_thumb_distal,
+  cgltf_vrm_humanoid_bone_type_right_index_proximal,
+  cgltf_vrm_humanoid_bone_type_right_index_intermediate,
+  cgltf_vrm_humanoid_bone_type_right_index_distal,
+  cgltf_vrm_humanoid_bone_type_right_middle_proximal,
+  cgltf_vrm_humanoid_bone_type_right_middle_intermediate,
+  cgltf_vrm_humanoid_bone_type_right_middle_distal,
+  cgltf_vrm_humanoid_bone_type_right_ring_proximal,
+  cgltf_vrm_humanoid_bone_type_right_ring_intermediate,
+  cgltf_vrm_humanoid_bone_type_right_ring_distal,
+  cgltf_vrm_humanoid_bone_type_right_little_proximal,
+  cgltf_vrm_humanoid_bone_type_right_little_intermediate,
+  cgltf_vrm_humanoid_bone_type_right_little_distal,
+  cgltf_vrm_humanoid_bone_type_max_enum,
+} cgltf_vrm_humanoid_bone_type;
+
 typedef struct cgltf_vrm_humanoid_bone
 {
   char* name;
+  cgltf_vrm_humanoid_bone_type type; /* max_enum for unknown names */
   cgltf_node* node;
 } cgltf_vrm_humanoid_bone;
 
@@ -161,8 +222,11 @@ typedef struct cgltf_vrm_expression_morph_target_bind
 typedef enum cgltf_vrm_expression_material_color_bind_type
 {
   cgltf_vrm_expression_material_color_bind_type_color,
-  cgltf_vrm_expression_material_color_bind_type_uv_scale,
-  cgltf_vrm_expression_material_color_bind_type_uv_offset,
+  cgltf_vrm_expression_material_color_bind_type_emission_color,
+  cgltf_vrm_expression_material_color_bind_type_shade_color,
+  cgltf_vrm_expression_material_color_bind_type_matcap_color,
+  cgltf_vrm_expression_material_color_bind_type_rim_color,
+  cgltf_vrm_expression_material_color_bind_type_outline_color,
   cgltf_vrm_expression_material_color_bind_type_max_enum,
 } cgltf_vrm_expression_material_color_bind_type;
 
@@ -261,15 +325,20 @@ typedef struct cgltf_vrm_core
 typedef enum cgltf_vrm_spring_bone_collider_shape {
   cgltf_vrm_spring_bone_collider_shape_sphere,
   cgltf_vrm_spring_bone_collider_shape_capsule,
+  cgltf_vrm_spring_bone_collider_shape_plane, /* VRMC_springBone_extended_collider */
   cgltf_vrm_spring_bone_collider_shape_max_enum,
 } cgltf_vrm_spring_bone_collider_shape;
 
+/* When VRMC_springBone_extended_collider is present its shape replaces the base one. */
 typedef struct cgltf_vrm_spring_bone_collider {
   cgltf_node* node;
   cgltf_vrm_spring_bone_collider_shape shape;
   cgltf_float offset[3];
   cgltf_float radius;
   cgltf_float tail[3];
+  cgltf_float normal[3]; /* plane */
+  cgltf_bool inside; /* sphere and capsule, joints are kept inside the shape */
+  cgltf_bool has_extended_shape;
 } cgltf_vrm_spring_bone_collider;
 
 
@@ -427,7 +496,60 @@ typedef struct cgltf_vrm_mtoon
   cgltf_float uv_animation_scroll_x_speed_factor;
   cgltf_float uv_animation_scroll_y_speed_factor;
   cgltf_float uv_animation_rotation_speed_factor;
-} cgltf_vrm_mtoon;
+} cgltf_vrm_mtoon; /* absent textures have an index of -1 */
+
+/* -------------------------------------------------------------------------- */
+/* -- VRMC_vrm_animation -- */
+
+/* The animated values live in the glTF animations : human bones are driven by rotation
+ * channels (and translation for the hips), expressions by the X translation of their node,
+ * and the look at target by the rotation of its node. */
+
+typedef struct cgltf_vrm_animation_expression
+{
+  char* name;
+  cgltf_node* node;
+} cgltf_vrm_animation_expression;
+
+typedef struct cgltf_vrm_animation
+{
+  cgltf_vrm_spec_version spec_version;
+
+  cgltf_vrm_humanoid humanoid;
+
+  cgltf_vrm_animation_expression* preset_expressions;
+  cgltf_size preset_expressions_count;
+
+  cgltf_vrm_animation_expression* custom_expressions;
+  cgltf_size custom_expressions_count;
+
+  cgltf_bool has_look_at;
+  cgltf_node* look_at_node;
+  cgltf_float look_at_offset_from_head_bone[3];
+} cgltf_vrm_animation;
+
+/* -------------------------------------------------------------------------- */
+/* -- String interning -- */
+
+/* Deduplicated storage for the names found in VRM data (human bones, expressions,
+ * collider groups, springs). Equal names share the same pointer, so they can be
+ * compared with `==`. A pool can be shared by many cgltf_vrm_data but is not thread safe. */
+typedef struct cgltf_vrm_string_pool
+{
+  cgltf_memory_options memory;
+
+  cgltf_uint* slots; /* open addressing table holding string index + 1, 0 marks an empty slot */
+  cgltf_size slots_count;
+
+  char** strings;
+  cgltf_uint* hashes;
+  cgltf_size strings_count;
+  cgltf_size strings_capacity;
+
+  char* blocks; /* chained storage blocks, each one starts with a pointer to the previous */
+  cgltf_size block_used;
+  cgltf_size block_size;
+} cgltf_vrm_string_pool;
 
 /* -------------------------------------------------------------------------- */
 
@@ -460,1692 +582,9296 @@ typedef struct cgltf_vrm_data
   cgltf_vrm_extended_material* extended_materials;
   cgltf_size extended_materials_count;
 
+  cgltf_vrm_animation animation;
+  cgltf_bool has_animation;
+
+  cgltf_vrm_string_pool* string_pool; /* holds the names when set, they are then not freed with the data */
+
+  /* Temporary token buffers of the load that built this data : most bytes alive at once and allocation count. */
+  cgltf_size parse_token_peak_bytes;
+  cgltf_size parse_token_allocations;
+
   cgltf_memory_options memory; /* tmp? */
   /*cgltf_data const* data;*/
 } cgltf_vrm_data;
 
 /* -------------------------------------------------------------------------- */
+/* -- Memory accounting -- */
 
-cgltf_result cgltf_vrm_parse_cgltf_data(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data* vrm);
+typedef struct cgltf_vrm_memory_usage
+{
+  cgltf_size bytes; /* as requested from the allocator, without its own overhead */
+  cgltf_size allocations;
+} cgltf_vrm_memory_usage;
 
-/*cgltf_result cgltf_vrm_parse_file(cgltf_options const* options, char const* filename, cgltf_vrm_data** out_data);
+/* Blocks owned by a cgltf_vrm_data, per subsystem. Names held by a string pool are not counted. */
+typedef struct cgltf_vrm_memory_report
+{
+  cgltf_vrm_memory_usage humanoid; /* human bones and their names */
+  cgltf_vrm_memory_usage meta; /* meta strings and authors */
+  cgltf_vrm_memory_usage first_person;
+  cgltf_vrm_memory_usage expressions; /* preset and custom expressions, their names and binds */
+  cgltf_vrm_memory_usage spring_bone; /* colliders, collider groups, springs and joints */
+  cgltf_vrm_memory_usage extended_nodes;
+  cgltf_vrm_memory_usage extended_materials;
+  cgltf_vrm_memory_usage animation;
 
-cgltf_result cgltf_vrm_parse(cgltf_options const* options, void const* data, cgltf_size size, cgltf_vrm_data** out_data);*/
+  cgltf_vrm_memory_usage total; /* sum of the above */
 
-void cgltf_vrm_free(cgltf_vrm_data* vrm);
+  /* Token buffers of the load, released once it ended : peak bytes alive at once and allocation count. */
+  cgltf_vrm_memory_usage parse_tokens;
+} cgltf_vrm_memory_report;
 
 /* -------------------------------------------------------------------------- */
+/* -- Profiling -- */
 
-#ifdef __cplusplus
-}
-#endif
+/* Named zones around the load stages, the JSON sections and the runtime evaluators, only reported when the
+ * implementation is compiled with CGLTF_VRM_PROFILE defined. Names are string literals. `begin` returns a value
+ * handed back to the matching `end` (eg. a packed TracyCZoneCtx), zones nest and end on the thread that began them. */
+typedef uint64_t (*cgltf_vrm_profile_begin_func)(void* user_data, char const* name);
+typedef void (*cgltf_vrm_profile_end_func)(void* user_data, uint64_t zone);
 
-#endif /* CGLTF_VRM_H_INCLUDED__ */
+typedef struct cgltf_vrm_profiler
+{
+  cgltf_vrm_profile_begin_func begin;
+  cgltf_vrm_profile_end_func end;
+  void* user_data;
+} cgltf_vrm_profiler;
 
 /* -------------------------------------------------------------------------- */
+/* -- Diagnostics -- */
 
-#if defined(__INTELLISENSE__) || defined(__JETBRAINS_IDE__)
-#define CGLTF_IMPLEMENTATION
-#endif
+typedef enum cgltf_vrm_diagnostic_kind
+{
+  cgltf_vrm_diagnostic_kind_skipped_key, /* unknown key, its value is skipped */
+  cgltf_vrm_diagnostic_kind_bad_enum, /* string matching no value, the field is set to its max_enum */
+  cgltf_vrm_diagnostic_kind_index_out_of_range, /* node, material, image or texture index outside the glTF arrays */
+  cgltf_vrm_diagnostic_kind_max_enum,
+} cgltf_vrm_diagnostic_kind;
 
-#ifdef CGLTF_IMPLEMENTATION
+typedef struct cgltf_vrm_diagnostic
+{
+  cgltf_vrm_diagnostic_kind kind;
+  char const* path; /* object holding the token, eg. "VRMC_vrm.meta." */
+  cgltf_int owner_index; /* node of VRMC_node_constraint or material of VRMC_materials_mtoon, -1 for the root extensions */
+  char const* token; /* in the JSON chunk, not NUL terminated */
+  cgltf_size token_length;
+  cgltf_size offset; /* of the token in its JSON chunk */
+} cgltf_vrm_diagnostic;
 
-#define CGLTF_VRM_JSON_LOG(suffixTag) \
-  fwrite((char*)json_chunk + tokens[i].start, 1, tokens[i].end - tokens[i].start, stderr); \
-  fprintf(stderr, suffixTag "\n");
+/* Receives the records of one load as they are found, `diagnostic` and its strings only live during the call. */
+typedef void (*cgltf_vrm_diagnostic_func)(void* user_data, cgltf_vrm_diagnostic const* diagnostic);
 
-#define CGLTF_VRM_JSON_SKIP() \
-  i = cgltf_skip_json(tokens, i+1);
+/* -------------------------------------------------------------------------- */
+/* -- Staged loading -- */
 
-#if defined(NDEBUG)
-#define CGLTF_VRM_LOG_SKIPPED(prefixTag) \
-  CGLTF_VRM_JSON_SKIP()
-#else
-#define CGLTF_VRM_LOG_SKIPPED(prefixTag) \
-  fprintf(stderr, "%s", prefixTag); \
-  CGLTF_VRM_JSON_LOG(" [skipped]") \
-  CGLTF_VRM_JSON_SKIP()
-#endif
+typedef enum cgltf_vrm_load_stage
+{
+  cgltf_vrm_load_stage_tokenize,
+  cgltf_vrm_load_stage_root_extensions,
+  cgltf_vrm_load_stage_node_constraints,
+  cgltf_vrm_load_stage_materials_mtoon,
+  cgltf_vrm_load_stage_fixup_pointers,
+  cgltf_vrm_load_stage_done,
+  cgltf_vrm_load_stage_max_enum,
+} cgltf_vrm_load_stage;
+
+typedef enum cgltf_vrm_load_status
+{
+  cgltf_vrm_load_status_in_progress,
+  cgltf_vrm_load_status_done,
+  cgltf_vrm_load_status_cancelled,
+  cgltf_vrm_load_status_failed,
+  cgltf_vrm_load_status_max_enum,
+} cgltf_vrm_load_status;
+
+/* Called after each step with the stage worked on and its completion in [0, 1]. */
+typedef void (*cgltf_vrm_progress_func)(void* user_data, cgltf_vrm_load_stage stage, cgltf_float progress);
+
+/* Limits for untrusted files, 0 leaves one unbounded. They are checked before the matching allocation, going over
+ * one fails the load with cgltf_vrm_result_budget_exceeded. */
+typedef struct cgltf_vrm_budget
+{
+  cgltf_size max_tokens; /* per JSON chunk (root extension, node constraint or MToon material) */
+  cgltf_size max_human_bones;
+  cgltf_size max_expressions; /* preset and custom together */
+  cgltf_size max_binds_per_expression; /* morph target, material color and texture transform binds together */
+  cgltf_size max_springs;
+  cgltf_size max_joints_per_spring;
+  cgltf_size max_colliders;
+  cgltf_size max_mtoon_materials;
+  cgltf_size max_bytes; /* alive at once among the blocks requested by the load, token buffers included */
+} cgltf_vrm_budget;
+
+/* cgltf_result of a load stopped by a cgltf_vrm_budget limit, clear of the cgltf_result values. */
+#define cgltf_vrm_result_budget_exceeded ((cgltf_result)(cgltf_result_max_enum + 1))
+
+typedef struct cgltf_vrm_options
+{
+  cgltf_vrm_progress_func progress_func;
+  void* progress_user_data;
 
-#define CGLTF_VRM_RET_STRING_TYPE(typeBase, suffix) \
-  if (cgltf_json_strcmp(tokens, json_chunk, #suffix) == 0) { return typeBase##suffix; }
+  /* Optional cancellation token, polled between stages and inside the node / material loops. */
+  volatile cgltf_int const* cancel;
 
-static
-cgltf_vrm_spec_version cgltf_vrm_string_to_spec_version(jsmntok_t const* tokens, uint8_t const* json_chunk)
-{
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_spec_version_, v_1_0)
-  return cgltf_vrm_spec_version_max_enum;
-}
+  /* Maximum number of extensions, nodes or materials processed per step, 0 processes a whole stage per step. */
+  cgltf_size step_budget;
 
-static
-cgltf_vrm_meta_avatar_permission_type cgltf_vrm_string_to_meta_avatar_permission(jsmntok_t const* tokens, uint8_t const* json_chunk)
-{
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_avatar_permission_type_, only_author)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_avatar_permission_type_, only_separately_licensed_person)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_avatar_permission_type_, everyone)
-  return cgltf_vrm_meta_avatar_permission_type_max_enum;
-}
+  /* Optional pool to intern names into, usually shared across loaded avatars. Must outlive the data. */
+  cgltf_vrm_string_pool* string_pool;
 
-static
-cgltf_vrm_meta_commercial_usage_type cgltf_vrm_string_to_meta_commercial_usage(jsmntok_t const* tokens, uint8_t const* json_chunk)
+  /* Optional profiler of this load, the one given to cgltf_vrm_set_profiler is used when NULL. */
+  cgltf_vrm_profiler const* profiler;
+
+  cgltf_vrm_budget budget;
+
+  /* Optional diagnostics sink, nothing is recorded without one. Each kind is reported at most diagnostics_per_kind
+   * times per load (0 means 16), cgltf_vrm_loader.diagnostics_count keeps counting past it. */
+  cgltf_vrm_diagnostic_func diagnostic_func;
+  void* diagnostic_user_data;
+  cgltf_size diagnostics_per_kind;
+} cgltf_vrm_options;
+
+typedef struct cgltf_vrm_loader
 {
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_commercial_usage_type_, personal_non_profit)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_commercial_usage_type_, personal_profit)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_commercial_usage_type_, corporation)
-  return cgltf_vrm_meta_commercial_usage_type_max_enum;
-}
+  cgltf_options options;
+  cgltf_vrm_options vrm_options;
+  cgltf_data const* gltf;
+  cgltf_vrm_data* vrm;
+
+  cgltf_vrm_load_stage stage;
+  cgltf_vrm_load_status status;
+  cgltf_result result; /* only meaningful once status is failed */
+  cgltf_size cursor;
+
+  void** root_tokens; /* one token buffer per gltf->data_extensions entry */
+  cgltf_size* root_token_bytes;
+  cgltf_size token_bytes; /* token buffers currently alive */
+
+  /* With a byte budget, options.memory counts the requests before handing them to this allocator. The loader
+   * must then stay at the same address until cgltf_vrm_loader_free. */
+  cgltf_memory_options memory;
+  cgltf_size budget_bytes;
+  cgltf_bool budget_exceeded;
+
+  /* Size of every block alive in options.memory, open addressed by address. Allocated from `memory`, not counted. */
+  void** budget_blocks;
+  cgltf_size* budget_block_sizes;
+  cgltf_size budget_blocks_capacity; /* 0 or a power of two */
+  cgltf_size budget_blocks_count;
+  cgltf_size mtoon_materials_count;
+
+  cgltf_size diagnostics_count[cgltf_vrm_diagnostic_kind_max_enum]; /* found, reported or not */
+} cgltf_vrm_loader;
 
-static
-cgltf_vrm_meta_credit_notation_type cgltf_vrm_string_to_meta_credit_notation(jsmntok_t const* tokens, uint8_t const* json_chunk)
+/* -------------------------------------------------------------------------- */
+/* -- Metadata scan -- */
+
+/* VRMC_vrm.meta and complexity counts, read from the JSON chunk only. */
+typedef struct cgltf_vrm_meta_summary
 {
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_credit_notation_type_, required)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_credit_notation_type_, unnecessary)
-  return cgltf_vrm_meta_credit_notation_type_max_enum;
-}
+  cgltf_bool is_vrm; /* VRMC_vrm was found */
+  cgltf_vrm_spec_version spec_version;
 
-static
-cgltf_vrm_meta_modification_type cgltf_vrm_string_to_meta_modification(jsmntok_t const* tokens, uint8_t const* json_chunk)
+  cgltf_vrm_meta meta; /* meta.thumbnail_image is not resolved, see thumbnail_image_index */
+  cgltf_int thumbnail_image_index; /* -1 when there is none */
+
+  cgltf_size human_bones_count;
+  cgltf_size expressions_count; /* preset and custom */
+  cgltf_size springs_count;
+  cgltf_size spring_joints_count;
+  cgltf_size colliders_count;
+  cgltf_size materials_count;
+  cgltf_size mtoon_materials_count;
+
+  cgltf_memory_options memory;
+} cgltf_vrm_meta_summary;
+
+/* -------------------------------------------------------------------------- */
+/* -- Content hash -- */
+
+typedef struct cgltf_vrm_hash128
 {
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_modification_type_, prohibited)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_modification_type_, allow_modification)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_modification_type_, allow_modification_redistribution)
-  return cgltf_vrm_meta_modification_type_max_enum;
-}
+  uint64_t low;
+  uint64_t high;
+} cgltf_vrm_hash128;
+
+/* One hash per subsystem, computed over semantic content only : nodes and materials are
+ * hashed by index, names are kept only where they are keys (human bones, expressions),
+ * dictionary order is ignored, and -0 / NaN floats are normalized. Image and mesh data
+ * are not part of it, so avatars differing only by their textures hash the same. */
+typedef struct cgltf_vrm_content_hash
+{
+  cgltf_vrm_hash128 humanoid;
+  cgltf_vrm_hash128 expressions;
+  cgltf_vrm_hash128 look_at;
+  cgltf_vrm_hash128 first_person;
+  cgltf_vrm_hash128 spring_bone;
+  cgltf_vrm_hash128 node_constraints;
+  cgltf_vrm_hash128 materials_mtoon;
 
-static
-cgltf_vrm_first_person_mesh_annotation_type cgltf_vrm_string_to_first_person_mesh_annotation(jsmntok_t const* tokens, uint8_t const* json_chunk)
+  cgltf_vrm_hash128 all; /* combination of the above */
+} cgltf_vrm_content_hash;
+
+/* -------------------------------------------------------------------------- */
+/* -- Animation sampling -- */
+
+typedef enum cgltf_vrm_animation_track_target
 {
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_first_person_mesh_annotation_type_, auto)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_first_person_mesh_annotation_type_, first_person_only)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_first_person_mesh_annotation_type_, third_person_only)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_first_person_mesh_annotation_type_, both)
-  return cgltf_vrm_first_person_mesh_annotation_type_max_enum;
-}
+  cgltf_vrm_animation_track_target_bone_rotation,
+  cgltf_vrm_animation_track_target_look_at_rotation,
+  cgltf_vrm_animation_track_target_hips_translation,
+  cgltf_vrm_animation_track_target_expression,
+  cgltf_vrm_animation_track_target_max_enum,
+} cgltf_vrm_animation_track_target;
+
+/* Keyframes are stored structure of arrays : `times`, then one array of keys_count floats per
+ * component. Cubic splines hold three such blocks : in tangents, values and out tangents. */
+typedef struct cgltf_vrm_animation_track
+{
+  cgltf_vrm_animation_track_target target;
+  cgltf_int index; /* humanoid bone type or expression index */
+  cgltf_interpolation_type interpolation;
+  cgltf_size components; /* 4 for rotations, 3 for translations, 1 for weights */
+
+  cgltf_size keys_count;
+  cgltf_float* times;
+  cgltf_float* values;
+} cgltf_vrm_animation_track;
+
+/* A glTF animation bound to humanoid bones and expressions. Rotation tracks come first. */
+typedef struct cgltf_vrm_animation_clip
+{
+  cgltf_float duration;
 
-static
-cgltf_vrm_expression_override_type cgltf_vrm_string_to_expression_override(jsmntok_t const* tokens, uint8_t const* json_chunk)
+  cgltf_vrm_animation_track* tracks;
+  cgltf_size tracks_count;
+  cgltf_size rotation_tracks_count;
+
+  cgltf_int bone_tracks[cgltf_vrm_humanoid_bone_type_max_enum]; /* -1 when not animated */
+  cgltf_int hips_translation_track;
+  cgltf_int look_at_track;
+
+  char const** expression_names; /* preset then custom, owned by the cgltf_vrm_data */
+  cgltf_int* expression_tracks;
+  cgltf_size expressions_count;
+
+  cgltf_float* keys; /* storage for every track */
+  cgltf_memory_options memory;
+} cgltf_vrm_animation_clip;
+
+/* Sampling state and results for one playback of a clip. Keyframe cursors make forward playback
+ * amortized O(1) per track, seeking backward or far ahead falls back to a binary search. */
+typedef struct cgltf_vrm_animation_sampler
 {
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_expression_override_type_, none)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_expression_override_type_, block)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_expression_override_type_, blend)
-  return cgltf_vrm_expression_override_type_max_enum;
-}
+  cgltf_vrm_animation_clip const* clip;
 
-static
-cgltf_vrm_look_at_type cgltf_vrm_string_to_look_at(jsmntok_t const* tokens, uint8_t const* json_chunk)
+  cgltf_size* cursors;
+  cgltf_float* scratch;
+
+  cgltf_float bone_rotations[cgltf_vrm_humanoid_bone_type_max_enum][4]; /* x y z w, identity when not animated */
+  cgltf_float hips_translation[3];
+  cgltf_float look_at_rotation[4];
+  cgltf_float* expression_weights;
+
+  cgltf_memory_options memory;
+} cgltf_vrm_animation_sampler;
+
+/* -------------------------------------------------------------------------- */
+/* -- Spring bone collision -- */
+
+/* World space colliders stored as structure of arrays with one layout for every shape : spheres are
+ * capsules whose tail is their head, planes keep their normal in `tail`, inside shapes flip `sign`. */
+typedef struct cgltf_vrm_spring_bone_collider_set
 {
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_look_at_type_, bone)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_look_at_type_, expression)
-  return cgltf_vrm_look_at_type_max_enum;
-}
+  cgltf_size colliders_count;
 
-static
-cgltf_vrm_spring_bone_collider_shape cgltf_vrm_string_to_spring_bone_collider_shape(jsmntok_t const* tokens, uint8_t const* json_chunk)
+  cgltf_float* head[3];
+  cgltf_float* tail[3];
+  cgltf_float* radius;
+  cgltf_float* sign;  /* 1 pushes joints out of the shape, -1 keeps them inside */
+  cgltf_float* plane; /* 1 for planes, 0 otherwise */
+
+  cgltf_float* storage;
+  cgltf_memory_options memory;
+} cgltf_vrm_spring_bone_collider_set;
+
+/* -------------------------------------------------------------------------- */
+/* -- Expression table -- */
+
+/* Expressions compiled for per frame evaluation : every bind lives in one contiguous array per kind,
+ * expressions only hold ranges into them and their names are kept aside. */
+
+typedef enum cgltf_vrm_expression_group
 {
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_spring_bone_collider_shape_, sphere)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_spring_bone_collider_shape_, capsule)
-  return cgltf_vrm_spring_bone_collider_shape_max_enum;
-}
+  cgltf_vrm_expression_group_none,
+  cgltf_vrm_expression_group_blink,   /* blink, blinkLeft, blinkRight */
+  cgltf_vrm_expression_group_look_at, /* lookUp, lookDown, lookLeft, lookRight */
+  cgltf_vrm_expression_group_mouth,   /* aa, ih, ou, ee, oh */
+  cgltf_vrm_expression_group_max_enum,
+} cgltf_vrm_expression_group;
+
+typedef struct cgltf_vrm_expression_table_entry
+{
+  cgltf_uint morph_binds_offset;
+  cgltf_uint morph_binds_count;
+  cgltf_uint material_color_binds_offset;
+  cgltf_uint material_color_binds_count;
+  cgltf_uint texture_transform_binds_offset;
+  cgltf_uint texture_transform_binds_count;
+
+  uint8_t is_binary;
+  uint8_t group; /* cgltf_vrm_expression_group */
+  uint8_t override_blink; /* cgltf_vrm_expression_override_type */
+  uint8_t override_look_at;
+  uint8_t override_mouth;
+} cgltf_vrm_expression_table_entry;
+
+/* A (node, morph target index) pair, morph binds refer to it by index. */
+typedef struct cgltf_vrm_expression_morph_target
+{
+  cgltf_node* node;
+  cgltf_int index;
+} cgltf_vrm_expression_morph_target;
 
-static
-cgltf_vrm_node_constraint_type cgltf_vrm_string_to_node_constraint_type(jsmntok_t const* tokens, uint8_t const* json_chunk)
+typedef struct cgltf_vrm_expression_table_morph_bind
 {
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_type_, roll)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_type_, aim)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_type_, rotation)
-  return cgltf_vrm_node_constraint_type_max_enum;
-}
+  cgltf_uint target;
+  cgltf_float weight;
+} cgltf_vrm_expression_table_morph_bind;
 
-static
-cgltf_vrm_node_constraint_roll_axis cgltf_vrm_string_to_node_constraint_roll_axis(jsmntok_t const* tokens, uint8_t const* json_chunk)
+typedef struct cgltf_vrm_expression_table_material_color_bind
 {
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_roll_axis_, x)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_roll_axis_, y)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_roll_axis_, z)
-  return cgltf_vrm_node_constraint_roll_axis_max_enum;
-}
+  cgltf_uint material; /* index in the table materials */
+  cgltf_vrm_expression_material_color_bind_type type;
+  cgltf_float target_value[4];
+  cgltf_float delta[4]; /* target_value - material value */
+} cgltf_vrm_expression_table_material_color_bind;
 
-static
-cgltf_vrm_node_constraint_aim_axis cgltf_vrm_string_to_node_constraint_aim_axis(jsmntok_t const* tokens, uint8_t const* json_chunk)
+typedef struct cgltf_vrm_expression_table_texture_transform_bind
 {
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_aim_axis_, positive_x)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_aim_axis_, positive_y)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_aim_axis_, positive_z)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_aim_axis_, negative_x)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_aim_axis_, negative_y)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_aim_axis_, negative_z)
-  return cgltf_vrm_node_constraint_aim_axis_max_enum;
-}
+  cgltf_uint material; /* index in the table materials */
+  cgltf_float scale[2];
+  cgltf_float offset[2];
+} cgltf_vrm_expression_table_texture_transform_bind;
 
-static
-cgltf_vrm_mtoon_outline_width_mode cgltf_vrm_string_to_mtoon_outline_width_mode(jsmntok_t const* tokens, uint8_t const* json_chunk)
+typedef struct cgltf_vrm_expression_table
 {
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_mtoon_outline_width_mode_, none)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_mtoon_outline_width_mode_, world_coordinates)
-  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_mtoon_outline_width_mode_, screen_coordinates)
-  return cgltf_vrm_mtoon_outline_width_mode_max_enum;
-}
+  cgltf_vrm_expression_table_entry* entries; /* preset then custom expressions */
+  cgltf_size entries_count;
+  char const** names; /* owned by the cgltf_vrm_data */
 
-/* ----------- VRMC_vrm ----------- */
+  cgltf_vrm_expression_morph_target* morph_targets; /* sorted by node then index */
+  cgltf_size morph_targets_count;
 
-static
-int cgltf_vrm_parse_json_humanoid(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_humanoid* out)
-{
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
-  ++i;
+  cgltf_vrm_expression_table_morph_bind* morph_binds; /* sorted by target inside each expression */
+  cgltf_size morph_binds_count;
 
-  if (cgltf_json_strcmp(tokens + i, json_chunk, "humanBones") == 0)
-  {
-    ++i;
-    out->human_bones_count = tokens[i].size;
-    out->human_bones = (cgltf_vrm_humanoid_bone*)cgltf_calloc(options, sizeof(cgltf_vrm_humanoid_bone), out->human_bones_count);
-    if (!out->human_bones)
-    {
-      return CGLTF_ERROR_NOMEM;
-    }
+  cgltf_vrm_expression_table_material_color_bind* material_color_binds;
+  cgltf_size material_color_binds_count;
 
-    ++i;
-    for (cgltf_size j = 0; j < out->human_bones_count; ++j)
-    {
-      cgltf_vrm_humanoid_bone *bone = &out->human_bones[j];
+  cgltf_vrm_expression_table_texture_transform_bind* texture_transform_binds;
+  cgltf_size texture_transform_binds_count;
 
-        if (tokens[i].type == JSMN_OBJECT) {
-            // the object looks like this:
-            //{
-            //  "bone": "hips",
-            //  "node": 1,
-            //  "useDefaultValues": true
-            //}
-            int object = i; // remember where the object was
-            i += 1;
-            for (int k = 0; k < 3; ++k) {
-                if (cgltf_json_strcmp(tokens + i, json_chunk, "bone") == 0) {
-                    i += 1; // skip "bone"
-                    i = cgltf_parse_json_string(options, tokens, i, json_chunk, &bone->name);
-                }
-                if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0) {
-                    i += 1; // skip "node"
-                    int nodeIndex = cgltf_json_to_int(tokens + i, json_chunk); // this just adds 1
-                    bone->node = CGLTF_PTRINDEX(cgltf_node, nodeIndex);
-                    i = cgltf_skip_json(tokens, i);
-                }
+  cgltf_uint* materials; /* indices in cgltf_data.materials of every bound material, sorted */
+  cgltf_size materials_count;
 
-                /*if (cgltf_json_strcmp(tokens + i, json_chunk, "useDefaultValues") == 0) {
-                    i += 1; // skip "useDefaultValues"
-                    // this value is not currently tracked
-                    if (cgltf_json_strcmp(tokens + i, json_chunk, "true") == 0) {
-                        //printf("useDefaultValues\n");
-                    } else {
-                        //printf("not useDefaultValues\n");
-                    }
-                    i = cgltf_skip_json(tokens, i);
-                }*/
-            }
-            i = cgltf_skip_json(tokens, object); // skip all the other data in this object
-        } else {
-            // this clause is what the original code did, is it correct?
-            CGLTF_CHECK_KEY(tokens[i]);
-            i = cgltf_parse_json_string(options, tokens, i, json_chunk, &bone->name);
+  cgltf_memory_options memory;
+} cgltf_vrm_expression_table;
 
-            i += 2;
-            bone->node = CGLTF_PTRINDEX(cgltf_node, cgltf_json_to_int(tokens + i, json_chunk));
-            i = cgltf_skip_json(tokens, i);
-        }
-    }
-  }
+/* Blended expression changes of one material, to be added to its own parameters. */
+typedef struct cgltf_vrm_material_delta
+{
+  cgltf_uint material; /* index in cgltf_data.materials */
+  cgltf_uint color_mask; /* bit (1 << cgltf_vrm_expression_material_color_bind_type) for each written color */
+  cgltf_bool has_texture_transform;
 
-  return i;
-}
+  cgltf_float colors[cgltf_vrm_expression_material_color_bind_type_max_enum][4];
+  cgltf_float uv_scale[2]; /* delta, add to 1 when the material has no texture transform */
+  cgltf_float uv_offset[2];
+} cgltf_vrm_material_delta;
 
-static
-int cgltf_vrm_parse_json_meta(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_meta* out)
+/* Only the materials touched by an active expression are written, in `deltas`. */
+typedef struct cgltf_vrm_material_delta_buffer
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  cgltf_vrm_material_delta* deltas;
+  cgltf_size deltas_count;
 
-  memset(out, 0, sizeof(cgltf_vrm_meta));
+  cgltf_int* slots; /* per table material, index in deltas or -1 */
+  cgltf_size slots_count;
 
-  int size = tokens[i].size;
-  ++i;
+  cgltf_memory_options memory;
+} cgltf_vrm_material_delta_buffer;
 
-  for (int j = 0; j < size; ++j)
-  {
-    CGLTF_CHECK_KEY(tokens[i]);
+/* -------------------------------------------------------------------------- */
+/* -- MToon parameter blocks -- */
 
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "name") == 0)
-    {
-      i = cgltf_parse_json_string(options, tokens, i + 1, json_chunk, &out->name);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "licenseUrl") == 0)
-    {
-      i = cgltf_parse_json_string(options, tokens, i + 1, json_chunk, &out->license_url);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "authors") == 0)
-    {
-      i = cgltf_parse_json_array(options, tokens, i + 1, json_chunk, sizeof(char*), (void**)&out->authors, &out->authors_count);
-      if (i < 0)
-      {
-        return i;
+typedef enum cgltf_vrm_mtoon_texture_slot
+{
+  cgltf_vrm_mtoon_texture_slot_base_color,
+  cgltf_vrm_mtoon_texture_slot_shade_multiply,
+  cgltf_vrm_mtoon_texture_slot_shading_shift,
+  cgltf_vrm_mtoon_texture_slot_normal,
+  cgltf_vrm_mtoon_texture_slot_emissive,
+  cgltf_vrm_mtoon_texture_slot_matcap,
+  cgltf_vrm_mtoon_texture_slot_rim_multiply,
+  cgltf_vrm_mtoon_texture_slot_outline_width_multiply,
+  cgltf_vrm_mtoon_texture_slot_uv_animation_mask,
+  cgltf_vrm_mtoon_texture_slot_max_enum
+} cgltf_vrm_mtoon_texture_slot;
+
+typedef enum cgltf_vrm_mtoon_block_flag
+{
+  cgltf_vrm_mtoon_block_flag_double_sided = 1 << 0,
+  cgltf_vrm_mtoon_block_flag_transparent_with_z_write = 1 << 1,
+  cgltf_vrm_mtoon_block_flag_unlit = 1 << 2,
+} cgltf_vrm_mtoon_block_flag;
+
+/* One MToon material laid out as a std140 / std430 uniform block (vec3 + float pairs, then scalar vec4s),
+ * 144 bytes. The matching GLSL declaration follows the member order with `vec4` / `vec3` / `float` / `uint`. */
+typedef struct cgltf_vrm_mtoon_block
+{
+  cgltf_float base_color_factor[4];
+  cgltf_float shade_color_factor[3];
+  cgltf_float shading_shift_factor;
+  cgltf_float emissive_factor[3]; /* multiplied by KHR_materials_emissive_strength */
+  cgltf_float shading_toony_factor;
+  cgltf_float matcap_factor[3];
+  cgltf_float gi_equalization_factor;
+  cgltf_float parametric_rim_color_factor[3];
+  cgltf_float parametric_rim_fresnel_power_factor;
+  cgltf_float outline_color_factor[3];
+  cgltf_float outline_width_factor;
+
+  cgltf_float parametric_rim_lift_factor;
+  cgltf_float rim_lighting_mix_factor;
+  cgltf_float outline_lighting_mix_factor;
+  cgltf_float shading_shift_texture_scale;
+
+  cgltf_float uv_animation_scroll_x_speed_factor;
+  cgltf_float uv_animation_scroll_y_speed_factor;
+  cgltf_float uv_animation_rotation_speed_factor;
+  cgltf_float alpha_cutoff;
+
+  cgltf_uint outline_width_mode; /* cgltf_vrm_mtoon_outline_width_mode */
+  cgltf_uint alpha_mode; /* cgltf_alpha_mode */
+  cgltf_uint texture_mask; /* bit (1 << cgltf_vrm_mtoon_texture_slot) for each bound texture */
+  cgltf_uint flags; /* cgltf_vrm_mtoon_block_flag */
+} cgltf_vrm_mtoon_block;
+
+typedef struct cgltf_vrm_mtoon_texture_binding
+{
+  cgltf_int texture; /* index in cgltf_data.textures, -1 when unbound */
+  cgltf_int tex_coord;
+} cgltf_vrm_mtoon_texture_binding;
+
+/* Shader variant selection bits, the low bits are the bound textures (1 << cgltf_vrm_mtoon_texture_slot). */
+typedef enum cgltf_vrm_mtoon_feature
+{
+  cgltf_vrm_mtoon_feature_outline_world = 1 << 16,
+  cgltf_vrm_mtoon_feature_outline_screen = 1 << 17,
+  cgltf_vrm_mtoon_feature_transparent_with_z_write = 1 << 18,
+  cgltf_vrm_mtoon_feature_rim = 1 << 19,
+  cgltf_vrm_mtoon_feature_matcap = 1 << 20,
+  cgltf_vrm_mtoon_feature_uv_animation = 1 << 21,
+  cgltf_vrm_mtoon_feature_alpha_mask = 1 << 22,
+  cgltf_vrm_mtoon_feature_alpha_blend = 1 << 23,
+  cgltf_vrm_mtoon_feature_double_sided = 1 << 24,
+} cgltf_vrm_mtoon_feature;
+
+/* UV animation of one MToon material at a given time. The shader applies the scroll then the rotation
+ * (around the UV center), both scaled by the mask texture when there is one ; `matrix` is that transform
+ * for an unmasked texel, as two columns and a translation (u' = m0 u + m2 v + m4, v' = m1 u + m3 v + m5).
+ * Masked materials must use `scroll * mask` and `rotation * mask` per texel, not the matrix. Their phases are
+ * left unwrapped, a wrap would make the scaled value jump, so restart `time` when float precision matters. */
+typedef struct cgltf_vrm_mtoon_uv_transform
+{
+  cgltf_float matrix[6];
+  cgltf_float scroll[2]; /* speed * time, wrapped to [0, 1) without mask */
+  cgltf_float rotation; /* radians, wrapped to [0, 2pi) without mask */
+} cgltf_vrm_mtoon_uv_transform;
+
+/* The animated MToon materials (non zero speeds) of an avatar, with their speeds kept as separate arrays. */
+typedef struct cgltf_vrm_mtoon_uv_animations
+{
+  cgltf_uint* materials; /* index in cgltf_data.materials */
+  cgltf_bool* has_mask;
+  cgltf_size count;
+
+  cgltf_float* scroll_x_speeds;
+  cgltf_float* scroll_y_speeds;
+  cgltf_float* rotation_speeds;
+
+  cgltf_vrm_mtoon_uv_transform* transforms; /* written by cgltf_vrm_mtoon_uv_animations_evaluate */
+
+  cgltf_memory_options memory;
+} cgltf_vrm_mtoon_uv_animations;
+
+/* A primitive drawn with an outlined MToon material. */
+typedef struct cgltf_vrm_outline_primitive
+{
+  cgltf_primitive const* primitive;
+  cgltf_size mesh; /* index in cgltf_data.meshes */
+  cgltf_size primitive_index; /* in the mesh */
+  cgltf_uint material;
+
+  cgltf_int width_texture; /* outline width multiply texture, -1 when none */
+  cgltf_int width_tex_coord;
+
+  cgltf_size vertices_offset; /* first vertex in cgltf_vrm_outline_normals.normals */
+  cgltf_size vertices_count;
+} cgltf_vrm_outline_primitive;
+
+/* Extra vertex stream for the outline pass : normals averaged over the vertices sharing a position, so that
+ * hard edges do not split the outline. It only depends on the avatar and can be shared by its instances. */
+typedef struct cgltf_vrm_outline_normals
+{
+  cgltf_vrm_outline_primitive* primitives;
+  cgltf_size primitives_count;
+
+  cgltf_float* normals; /* 4 per vertex : smoothed normal and outline width multiplier (1 when not sampled) */
+  cgltf_size vertices_count;
+
+  cgltf_memory_options memory;
+} cgltf_vrm_outline_normals;
+
+/* Returns the outline width multiplier (the G channel in MToon) of `texture` at (u, v). */
+typedef cgltf_float (*cgltf_vrm_outline_width_sample_func)(void* user_data, cgltf_int texture, cgltf_float u, cgltf_float v);
+
+/* Draw order classes, in submission order. */
+typedef enum cgltf_vrm_mtoon_transparency
+{
+  cgltf_vrm_mtoon_transparency_opaque,
+  cgltf_vrm_mtoon_transparency_cutout,
+  cgltf_vrm_mtoon_transparency_transparent_with_z_write,
+  cgltf_vrm_mtoon_transparency_transparent,
+  cgltf_vrm_mtoon_transparency_max_enum
+} cgltf_vrm_mtoon_transparency;
+
+/* Distinct MToon materials, shared by every avatar added to the cache. Not thread safe. */
+typedef struct cgltf_vrm_mtoon_cache
+{
+  cgltf_vrm_mtoon_block* blocks;
+  cgltf_vrm_mtoon_texture_binding* textures; /* cgltf_vrm_mtoon_texture_slot_max_enum per block, after remapping */
+  cgltf_uint* feature_keys;
+  cgltf_uint* hashes;
+  cgltf_size blocks_count;
+  cgltf_size blocks_capacity;
+
+  cgltf_uint* slots; /* open addressing table holding block index + 1, 0 marks an empty slot */
+  cgltf_size slots_count;
+
+  cgltf_memory_options memory;
+} cgltf_vrm_mtoon_cache;
+
+/* -------------------------------------------------------------------------- */
+/* -- Texture usage -- */
+
+/* The first roles match cgltf_vrm_mtoon_texture_slot. */
+typedef enum cgltf_vrm_texture_role
+{
+  cgltf_vrm_texture_role_base_color,
+  cgltf_vrm_texture_role_shade_multiply,
+  cgltf_vrm_texture_role_shading_shift,
+  cgltf_vrm_texture_role_normal,
+  cgltf_vrm_texture_role_emissive,
+  cgltf_vrm_texture_role_matcap,
+  cgltf_vrm_texture_role_rim_multiply,
+  cgltf_vrm_texture_role_outline_width_multiply,
+  cgltf_vrm_texture_role_uv_animation_mask,
+  cgltf_vrm_texture_role_metallic_roughness, /* non MToon materials */
+  cgltf_vrm_texture_role_occlusion,
+  cgltf_vrm_texture_role_thumbnail, /* VRMC_vrm.meta.thumbnailImage, an image without texture */
+  cgltf_vrm_texture_role_max_enum
+} cgltf_vrm_texture_role;
+
+#define CGLTF_VRM_TEXTURE_UNUSED 0xffffffffu
+
+/* One reference to a texture (or to the thumbnail image) by a material. */
+typedef struct cgltf_vrm_texture_use
+{
+  cgltf_int texture; /* index in cgltf_data.textures, -1 for the thumbnail */
+  cgltf_int image; /* index in cgltf_data.images, -1 when the texture has none */
+  cgltf_int material; /* index in cgltf_data.materials, -1 for the thumbnail */
+  cgltf_vrm_texture_role role;
+  cgltf_uint priority; /* lower loads first */
+  cgltf_bool animated; /* UV animated by MToon or an expression texture transform bind */
+} cgltf_vrm_texture_use;
+
+typedef struct cgltf_vrm_texture_usage
+{
+  cgltf_vrm_texture_use* uses; /* sorted by priority, then image and material */
+  cgltf_size uses_count;
+
+  cgltf_uint* texture_roles; /* per glTF texture, bit (1 << cgltf_vrm_texture_role) for each use, 0 when unreferenced */
+  cgltf_uint* texture_priorities; /* per glTF texture, best use priority or CGLTF_VRM_TEXTURE_UNUSED */
+  cgltf_size textures_count;
+
+  cgltf_uint* image_priorities; /* per glTF image, best use priority or CGLTF_VRM_TEXTURE_UNUSED */
+  cgltf_size images_count;
+
+  cgltf_memory_options memory;
+} cgltf_vrm_texture_usage;
+
+/* -------------------------------------------------------------------------- */
+/* -- Spring bone simulation -- */
+
+/* Simulated joints, every spring joint but the last one of its spring, stored as structure of arrays
+ * in spring order : each spring is a contiguous range and a joint always comes after its parent. */
+typedef struct cgltf_vrm_spring_bone_state
+{
+  cgltf_size joints_count;
+  cgltf_uint* nodes; /* head node of each joint, index in cgltf_data.nodes */
+  cgltf_uint* tails; /* tail node, the next joint of the spring */
+  cgltf_int* parents; /* parent node of the head, -1 for roots */
+
+  cgltf_size springs_count;
+  cgltf_uint* spring_joints; /* springs_count + 1 offsets into the joints */
+  cgltf_uint* spring_colliders; /* springs_count + 1 offsets into `colliders` */
+  cgltf_int* colliders; /* colliders of every collider group of each spring */
+
+  cgltf_float* rest_rotation[4]; /* local rest transform of the head */
+  cgltf_float* rest_translation[3];
+  cgltf_float* rest_scale[3];
+  cgltf_float* bone_axis[3]; /* normalized tail position in the head space */
+  cgltf_float* bone_length; /* world space */
+  cgltf_float* stiffness;
+  cgltf_float* drag;
+  cgltf_float* gravity[3]; /* gravityDir * gravityPower */
+  cgltf_float* hit_radius;
+
+  cgltf_float* prev_tail[3];
+  cgltf_float* current_tail[3];
+  cgltf_float* rotation[4]; /* local rotation of the head after the last step */
+
+  cgltf_float* storage;
+  cgltf_memory_options memory;
+} cgltf_vrm_spring_bone_state;
+
+/* -------------------------------------------------------------------------- */
+/* -- Node constraints -- */
+
+/* Constraints ordered so that a constrained source is solved before the nodes it drives. */
+typedef struct cgltf_vrm_node_constraint_set
+{
+  cgltf_size constraints_count;
+  cgltf_uint* nodes; /* destination, index in cgltf_data.nodes */
+  cgltf_uint* sources;
+  cgltf_int* parents; /* parent node of the destination, -1 for roots */
+  uint8_t* types; /* cgltf_vrm_node_constraint_type */
+  uint8_t* axes; /* cgltf_vrm_node_constraint_roll_axis or cgltf_vrm_node_constraint_aim_axis */
+  cgltf_float* weights;
+
+  cgltf_float* dst_rest_rotation[4];
+  cgltf_float* src_rest_rotation[4];
+
+  cgltf_float* storage;
+  cgltf_memory_options memory;
+} cgltf_vrm_node_constraint_set;
+
+/* -------------------------------------------------------------------------- */
+/* -- Look at -- */
+
+typedef struct cgltf_vrm_look_at_pose
+{
+  cgltf_float yaw; /* degrees in the head space, positive toward +X (the avatar left) */
+  cgltf_float pitch; /* degrees, positive up */
+
+  cgltf_float left_eye[4]; /* bone type : rotations to apply after the eye rest rotations */
+  cgltf_float right_eye[4];
+
+  cgltf_float weights[4]; /* expression type : lookUp, lookDown, lookLeft and lookRight weights */
+} cgltf_vrm_look_at_pose;
+
+/* -------------------------------------------------------------------------- */
+/* -- Referenced nodes -- */
+
+/* glTF nodes as a bitset and as a dense ascending list. */
+typedef struct cgltf_vrm_node_set
+{
+  cgltf_size nodes_count;
+  cgltf_uint* nodes;
+
+  cgltf_size gltf_nodes_count;
+  uint32_t* bits; /* node n is bit n % 32 of word n / 32 */
+
+  cgltf_memory_options memory;
+} cgltf_vrm_node_set;
+
+/* -------------------------------------------------------------------------- */
+/* -- Skeleton -- */
+
+/* The referenced nodes linearized depth first : a parent always comes before its children,
+ * so world matrices are computed in one forward pass. */
+typedef struct cgltf_vrm_skeleton
+{
+  cgltf_size nodes_count;
+  cgltf_uint* nodes; /* index in cgltf_data.nodes of each linear node */
+  cgltf_int* parents; /* linear index of the parent, -1 for roots */
+
+  cgltf_size gltf_nodes_count;
+  cgltf_int* linear_indices; /* per glTF node, linear index or -1 when outside the skeleton */
+
+  cgltf_float* translation[3]; /* local transform, the rest pose after init */
+  cgltf_float* rotation[4];
+  cgltf_float* scale[3];
+
+  cgltf_float* storage;
+  cgltf_memory_options memory;
+} cgltf_vrm_skeleton;
+
+/* -------------------------------------------------------------------------- */
+/* -- Retargeting -- */
+
+typedef enum cgltf_vrm_retarget_bone
+{
+  cgltf_vrm_retarget_bone_none, /* not in the target, left untouched */
+  cgltf_vrm_retarget_bone_mapped, /* pre * source * post */
+  cgltf_vrm_retarget_bone_rest, /* not in the source, the target rest rotation `post` is written */
+  cgltf_vrm_retarget_bone_max_enum,
+} cgltf_vrm_retarget_bone;
+
+/* Carries local rotations from a source humanoid to a target one, through the world space delta from the rest pose.
+ * With ParentRest the rest world rotation of the glTF parent of a bone and Rest its rest local rotation :
+ *   pre = inverse(targetParentRest) * sourceParentRest
+ *   post = inverse(sourceRest) * inverse(sourceParentRest) * targetParentRest * targetRest
+ * Holds no pointer, it can be cached and stored as is. */
+typedef struct cgltf_vrm_retarget_table
+{
+  cgltf_float pre_rotations[cgltf_vrm_humanoid_bone_type_max_enum][4];
+  cgltf_float post_rotations[cgltf_vrm_humanoid_bone_type_max_enum][4];
+  uint8_t bones[cgltf_vrm_humanoid_bone_type_max_enum]; /* cgltf_vrm_retarget_bone */
+  cgltf_float hips_scale; /* target hips rest height / source hips rest height */
+} cgltf_vrm_retarget_table;
+
+/* -------------------------------------------------------------------------- */
+/* -- Two bone IK -- */
+
+typedef enum cgltf_vrm_limb
+{
+  cgltf_vrm_limb_left_leg, /* upperLeg, lowerLeg, foot */
+  cgltf_vrm_limb_right_leg,
+  cgltf_vrm_limb_left_arm, /* upperArm, lowerArm, hand */
+  cgltf_vrm_limb_right_arm,
+  cgltf_vrm_limb_max_enum,
+} cgltf_vrm_limb;
+
+/* Limbs of any number of avatars as structure of arrays. Positions, targets and poles are in world space. */
+typedef struct cgltf_vrm_two_bone_ik_batch
+{
+  cgltf_size limbs_count;
+
+  cgltf_float* upper_position[3];
+  cgltf_float* lower_position[3];
+  cgltf_float* end_position[3];
+  cgltf_float* parent_rotation[4]; /* world rotation of the parent of the upper bone */
+  cgltf_float* lower_parent_rotation[4]; /* of the parent of the lower bone, the upper bone or a twist node below it */
+  cgltf_float* upper_rotation[4]; /* local rotations, solved in place */
+  cgltf_float* lower_rotation[4];
+
+  cgltf_float* target[3]; /* where the end bone should be */
+  cgltf_float* pole[3]; /* the middle joint bends toward it */
+  cgltf_float* weight; /* 0 leaves the limb unchanged, 0 after init */
+
+  cgltf_float* storage;
+  cgltf_memory_options memory;
+} cgltf_vrm_two_bone_ik_batch;
+
+/* -------------------------------------------------------------------------- */
+
+cgltf_result cgltf_vrm_parse_cgltf_data(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data* vrm);
+
+/* Staged alternative to cgltf_vrm_parse_cgltf_data : call cgltf_vrm_loader_step until it stops returning
+ * cgltf_vrm_load_status_in_progress, then cgltf_vrm_loader_free. On failure or cancellation `vrm` is released. */
+cgltf_result cgltf_vrm_loader_init(cgltf_vrm_loader* loader, cgltf_options const* options, cgltf_vrm_options const* vrm_options, cgltf_data const* gltf, cgltf_vrm_data* vrm);
+
+cgltf_vrm_load_status cgltf_vrm_loader_step(cgltf_vrm_loader* loader);
+
+void cgltf_vrm_loader_free(cgltf_vrm_loader* loader);
+
+/* Profiler of the runtime evaluators and of the loads without one, NULL disables it. Not thread safe,
+ * set it before starting workers. Has no effect unless the implementation defines CGLTF_VRM_PROFILE. */
+void cgltf_vrm_set_profiler(cgltf_vrm_profiler const* profiler);
+
+cgltf_result cgltf_vrm_string_pool_init(cgltf_vrm_string_pool* pool, cgltf_memory_options const* memory);
+
+/* Returns the pooled copy of the `length` first bytes of `str`, adding it when needed. NULL when out of memory. */
+char const* cgltf_vrm_string_pool_intern(cgltf_vrm_string_pool* pool, char const* str, cgltf_size length);
+
+/* Returns the pooled copy of `str` or NULL when it was never interned, useful to get comparison keys ("hips", "blink"..). */
+char const* cgltf_vrm_string_pool_find(cgltf_vrm_string_pool const* pool, char const* str);
+
+void cgltf_vrm_string_pool_free(cgltf_vrm_string_pool* pool);
+
+/* Reads VRMC_vrm.meta and counts from a .vrm / .glb (header and JSON chunk only) or .gltf buffer,
+ * without building a cgltf_data. Release with cgltf_vrm_meta_summary_free. */
+cgltf_result cgltf_vrm_parse_meta(cgltf_options const* options, void const* data, cgltf_size size, cgltf_vrm_meta_summary* out);
+
+/* Same as cgltf_vrm_parse_meta, only the GLB header and JSON chunk are read from the file. */
+cgltf_result cgltf_vrm_parse_meta_file(cgltf_options const* options, char const* path, cgltf_vrm_meta_summary* out);
+
+void cgltf_vrm_meta_summary_free(cgltf_vrm_meta_summary* summary);
+
+cgltf_vrm_humanoid_bone_type cgltf_vrm_humanoid_bone_type_from_name(char const* name);
+
+char const* cgltf_vrm_humanoid_bone_type_name(cgltf_vrm_humanoid_bone_type type);
+
+/* Binds `animation` to the VRMC_vrm_animation humanoid and expressions of `vrm` (or its VRMC_vrm humanoid
+ * when there is none) and copies the keyframes. Channels that do not target them are ignored. */
+cgltf_result cgltf_vrm_animation_clip_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_animation const* animation, cgltf_vrm_animation_clip* clip);
+
+void cgltf_vrm_animation_clip_free(cgltf_vrm_animation_clip* clip);
+
+/* The clip must outlive the sampler. */
+cgltf_result cgltf_vrm_animation_sampler_init(cgltf_vrm_animation_sampler* sampler, cgltf_vrm_animation_clip const* clip);
+
+/* Evaluates every track at `time` (clamped to the clip range) into the sampler results. */
+void cgltf_vrm_animation_sampler_sample(cgltf_vrm_animation_sampler* sampler, cgltf_float time);
+
+void cgltf_vrm_animation_sampler_free(cgltf_vrm_animation_sampler* sampler);
+
+cgltf_result cgltf_vrm_spring_bone_collider_set_init(cgltf_options const* options, cgltf_vrm_spring_bone const* spring_bone, cgltf_vrm_spring_bone_collider_set* set);
+
+/* Moves the colliders to their nodes. `world_matrices` holds one column major matrix per node of `gltf`,
+ * when NULL they are computed with cgltf_node_transform_world. */
+void cgltf_vrm_spring_bone_collider_set_update(cgltf_vrm_spring_bone_collider_set* set, cgltf_data const* gltf, cgltf_vrm_spring_bone const* spring_bone, cgltf_float const* world_matrices);
+
+/* Resolves `count` joint spheres (centers as separate component arrays) against the listed colliders,
+ * in order. Returns the number of contacts. */
+cgltf_size cgltf_vrm_spring_bone_collide(cgltf_vrm_spring_bone_collider_set const* set, cgltf_int const* colliders, cgltf_size colliders_count, cgltf_size count, cgltf_float* x, cgltf_float* y, cgltf_float* z, cgltf_float const* radius);
+
+void cgltf_vrm_spring_bone_collider_set_free(cgltf_vrm_spring_bone_collider_set* set);
+
+/* The table refers to names and nodes of `vrm` and `gltf`, which must outlive it. */
+cgltf_result cgltf_vrm_expression_table_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_expression_table* table);
+
+/* Applies isBinary and the blink / lookAt / mouth overrides to entries_count weights. */
+void cgltf_vrm_expression_table_resolve_weights(cgltf_vrm_expression_table const* table, cgltf_float const* weights, cgltf_float* out_weights);
+
+/* Accumulates resolved expression weights into morph_targets_count morph target weights. */
+void cgltf_vrm_expression_table_evaluate_morphs(cgltf_vrm_expression_table const* table, cgltf_float const* weights, cgltf_float* out_morph_weights);
+
+void cgltf_vrm_expression_table_free(cgltf_vrm_expression_table* table);
+
+cgltf_result cgltf_vrm_material_delta_buffer_init(cgltf_vrm_material_delta_buffer* buffer, cgltf_vrm_expression_table const* table);
+
+/* Blends the material color and texture transform binds of the resolved expression weights. */
+void cgltf_vrm_expression_table_evaluate_materials(cgltf_vrm_expression_table const* table, cgltf_float const* weights, cgltf_vrm_material_delta_buffer* buffer);
+
+void cgltf_vrm_material_delta_buffer_free(cgltf_vrm_material_delta_buffer* buffer);
+
+/* Packs the MToon materials of `vrm`, in material order, into `blocks_count` consecutive blocks, their textures into
+ * cgltf_vrm_mtoon_texture_slot_max_enum bindings per block and, when not NULL, the index of each block material into
+ * `out_materials`. Returns the number of MToon materials, when `out_blocks` is NULL only counts them. */
+cgltf_size cgltf_vrm_mtoon_pack(cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_mtoon_block* out_blocks, cgltf_size blocks_count, cgltf_vrm_mtoon_texture_binding* out_textures, cgltf_uint* out_materials);
+
+/* cgltf_vrm_mtoon_feature bits of an MToon material, materials sharing a key can share a shader variant. */
+cgltf_uint cgltf_vrm_mtoon_feature_key(cgltf_data const* gltf, cgltf_material const* material, cgltf_vrm_mtoon const* mtoon);
+
+cgltf_result cgltf_vrm_mtoon_cache_init(cgltf_vrm_mtoon_cache* cache, cgltf_memory_options const* memory);
+
+/* Adds the MToon materials of `vrm` and writes, for each of the gltf->materials_count materials, the index of its
+ * cache block or -1 into `out_blocks`. Textures are compared through `texture_ids` (an id per glTF texture, eg. from
+ * image content hashes) when given, otherwise by index, which only deduplicates within one avatar. */
+cgltf_result cgltf_vrm_mtoon_cache_add(cgltf_vrm_mtoon_cache* cache, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_int const* texture_ids, cgltf_int* out_blocks);
+
+void cgltf_vrm_mtoon_cache_free(cgltf_vrm_mtoon_cache* cache);
+
+cgltf_result cgltf_vrm_mtoon_uv_animations_init(cgltf_options const* options, cgltf_vrm_data const* vrm, cgltf_vrm_mtoon_uv_animations* animations);
+
+/* Writes the transforms of every animated material at `time`, in seconds. */
+void cgltf_vrm_mtoon_uv_animations_evaluate(cgltf_vrm_mtoon_uv_animations* animations, double time);
+
+void cgltf_vrm_mtoon_uv_animations_free(cgltf_vrm_mtoon_uv_animations* animations);
+
+/* Lists the primitives of `gltf` drawn with an MToon material with an outline and sizes their stream. */
+cgltf_result cgltf_vrm_outline_normals_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_outline_normals* normals);
+
+/* Computes the stream of one primitive, the outline width texture is sampled when `sample` is not NULL.
+ * Primitives are independent and can be computed from several threads when the memory callbacks are thread safe.
+ * Returns cgltf_result_data_too_short when the positions or normals cannot be unpacked, eg. buffers not loaded. */
+cgltf_result cgltf_vrm_outline_normals_compute(cgltf_vrm_outline_normals* normals, cgltf_size primitive, cgltf_vrm_outline_width_sample_func sample, void* user_data);
+
+void cgltf_vrm_outline_normals_free(cgltf_vrm_outline_normals* normals);
+
+/* Render queue of a material (2000 opaque, 2450 cutout, 2501 + [0, 9] transparent with Z write, 3000 + [-9, 0]
+ * transparent) from its alpha mode and the clamped renderQueueOffsetNumber. `mtoon` may be NULL. */
+cgltf_int cgltf_vrm_mtoon_render_queue(cgltf_material const* material, cgltf_vrm_mtoon const* mtoon, cgltf_vrm_mtoon_transparency* out_transparency);
+
+/* 64-bit draw sort key, from the most significant bits : render queue (12), transparency (2),
+ * feature key (25) and material id (25, eg. a cgltf_vrm_mtoon_cache block index). */
+uint64_t cgltf_vrm_mtoon_sort_key(cgltf_material const* material, cgltf_vrm_mtoon const* mtoon, cgltf_uint feature_key, cgltf_uint material_id);
+
+/* Stable radix sort of `count` draws by key, `indices` is sorted along. `tmp_keys` and `tmp_indices`
+ * are scratch arrays of `count` elements. */
+void cgltf_vrm_sort_draws(uint64_t* keys, cgltf_uint* indices, cgltf_size count, uint64_t* tmp_keys, cgltf_uint* tmp_indices);
+
+/* Builds the texture usage of `gltf` and `vrm`. `role_priorities` holds cgltf_vrm_texture_role_max_enum priorities,
+ * NULL uses base color first, then shade, normal / emissive / shading shift, outline / masks, matcap / rim, thumbnail. */
+cgltf_result cgltf_vrm_texture_usage_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_uint const* role_priorities, cgltf_vrm_texture_usage* usage);
+
+void cgltf_vrm_texture_usage_free(cgltf_vrm_texture_usage* usage);
+
+/* Gathers the springs of `spring_bone`, tails start at their rest world position. Centers are not supported,
+ * joints are simulated in world space. */
+cgltf_result cgltf_vrm_spring_bone_state_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_spring_bone const* spring_bone, cgltf_vrm_spring_bone_state* state);
+
+/* Moves the tails back to the pose of `world_matrices` (one matrix per node of `gltf`), eg. after a teleport. */
+void cgltf_vrm_spring_bone_state_reset(cgltf_vrm_spring_bone_state* state, cgltf_float const* world_matrices);
+
+/* Advances the simulation by `delta_time` seconds. `world_matrices` holds one column major matrix per node of `gltf`
+ * for the animated pose, the matrices of the joints and of the last tail of each spring are updated in place.
+ * `colliders` must have been updated for this pose, it may be NULL. */
+void cgltf_vrm_spring_bone_state_step(cgltf_vrm_spring_bone_state* state, cgltf_data const* gltf, cgltf_vrm_spring_bone_collider_set const* colliders, cgltf_float* world_matrices, cgltf_float delta_time);
+
+void cgltf_vrm_spring_bone_state_free(cgltf_vrm_spring_bone_state* state);
+
+cgltf_result cgltf_vrm_node_constraint_set_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_node_constraint_set* set);
+
+/* Writes the rotation of every constrained node into `local_rotations` (x y z w per node of `gltf`), which also holds
+ * the source rotations. Aim constraints read node positions and parent rotations from `world_matrices` (one column
+ * major matrix per node of `gltf`), which is not updated and may be NULL when there are none. */
+void cgltf_vrm_node_constraint_set_evaluate(cgltf_vrm_node_constraint_set const* set, cgltf_float* local_rotations, cgltf_float const* world_matrices);
+
+void cgltf_vrm_node_constraint_set_free(cgltf_vrm_node_constraint_set* set);
+
+/* Yaw and pitch of `target` seen from the head (offsetFromHeadBone applied), mapped through the range maps
+ * of `look_at` into eye rotations and look expression weights. */
+void cgltf_vrm_look_at_evaluate(cgltf_vrm_look_at const* look_at, cgltf_float const* head_world_matrix, cgltf_float const* target, cgltf_vrm_look_at_pose* out);
+
+/* Nodes whose transform can change at runtime : human bones (eyes included) of VRMC_vrm and VRMC_vrm_animation,
+ * the look at node of the latter, spring joints and centers, colliders, constraint destinations and sources,
+ * and all their ancestors. Every other node keeps its rest transform relative to its closest referenced ancestor. */
+cgltf_result cgltf_vrm_node_set_init_referenced(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_node_set* set);
+
+cgltf_bool cgltf_vrm_node_set_contains(cgltf_vrm_node_set const* set, cgltf_size node_index);
+
+void cgltf_vrm_node_set_free(cgltf_vrm_node_set* set);
+
+cgltf_result cgltf_vrm_skeleton_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_skeleton* skeleton);
+
+/* Composes the local transforms into `world_matrices`, one column major matrix per linear node (`nodes_count`
+ * matrices). The runtime evaluators take one matrix per glTF node instead, see cgltf_vrm_skeleton_scatter_world. */
+void cgltf_vrm_skeleton_compute_world(cgltf_vrm_skeleton const* skeleton, cgltf_float* world_matrices);
+
+/* Copies the linear `world_matrices` of cgltf_vrm_skeleton_compute_world to their glTF node in `node_world_matrices`
+ * (`gltf_nodes_count` matrices), the layout read by the spring bone, constraint and IK evaluators. Matrices of the
+ * nodes outside the skeleton are left untouched. */
+void cgltf_vrm_skeleton_scatter_world(cgltf_vrm_skeleton const* skeleton, cgltf_float const* world_matrices, cgltf_float* node_world_matrices);
+
+void cgltf_vrm_skeleton_free(cgltf_vrm_skeleton* skeleton);
+
+/* `source` NULL stands for a normalized humanoid, whose rest rotations are all identity, such as the
+ * VRM 1.0 normalized pose. Its hips scale is then 1. */
+cgltf_result cgltf_vrm_retarget_table_init(cgltf_vrm_humanoid const* source, cgltf_vrm_humanoid const* target, cgltf_vrm_retarget_table* table);
+
+/* Retargets `count` poses, each made of one x y z w rotation per cgltf_vrm_humanoid_bone_type as in
+ * cgltf_vrm_animation_sampler.bone_rotations, and of a hips translation (both hips arrays may be NULL). */
+void cgltf_vrm_retarget_apply(cgltf_vrm_retarget_table const* table, cgltf_size count, cgltf_float const* source_rotations, cgltf_float const* source_hips_translations, cgltf_float* target_rotations, cgltf_float* target_hips_translations);
+
+/* Writes the glTF node indices of the upper, lower and end bones of `limb` to `nodes`, -1 for missing bones.
+ * Returns 0 when one is missing. */
+cgltf_bool cgltf_vrm_humanoid_limb_nodes(cgltf_data const* gltf, cgltf_vrm_humanoid const* humanoid, cgltf_vrm_limb limb, cgltf_int* nodes);
+
+cgltf_result cgltf_vrm_two_bone_ik_batch_init(cgltf_options const* options, cgltf_size limbs_count, cgltf_vrm_two_bone_ik_batch* batch);
+
+/* Loads limb `index` from the per glTF node `local_rotations` (x y z w) and `world_matrices` (column major) of the current pose,
+ * `nodes` as given by cgltf_vrm_humanoid_limb_nodes. Targets, poles and weights are set by the caller. */
+void cgltf_vrm_two_bone_ik_batch_gather(cgltf_vrm_two_bone_ik_batch* batch, cgltf_size index, cgltf_data const* gltf, cgltf_int const* nodes, cgltf_float const* local_rotations, cgltf_float const* world_matrices);
+
+/* Bends the lower bone so that the end reaches the target (clamped to the limb length), aims the upper bone at it,
+ * then turns the limb around the upper bone to target axis toward the pole. Results are blended by the weights. */
+void cgltf_vrm_two_bone_ik_solve(cgltf_vrm_two_bone_ik_batch* batch);
+
+/* Stores the solved local rotations of limb `index`. Evaluate the node constraints afterwards so that twist bones
+ * follow the limb, aim constraints need world matrices updated for the solved pose. */
+void cgltf_vrm_two_bone_ik_batch_scatter(cgltf_vrm_two_bone_ik_batch const* batch, cgltf_size index, cgltf_int const* nodes, cgltf_float* local_rotations);
+
+void cgltf_vrm_two_bone_ik_batch_free(cgltf_vrm_two_bone_ik_batch* batch);
+
+/* Walks `vrm` to report what it holds, works whatever cgltf_memory_options it was loaded with. Strings count
+ * their length + 1, escaped JSON strings were allocated a few bytes larger. */
+void cgltf_vrm_memory_stats(cgltf_vrm_data const* vrm, cgltf_vrm_memory_report* out);
+
+/* Stable across runs and platforms, `gltf` must be the data `vrm` was parsed from. */
+void cgltf_vrm_hash(cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_content_hash* out);
+
+/*cgltf_result cgltf_vrm_parse_file(cgltf_options const* options, char const* filename, cgltf_vrm_data** out_data);
+
+cgltf_result cgltf_vrm_parse(cgltf_options const* options, void const* data, cgltf_size size, cgltf_vrm_data** out_data);*/
+
+void cgltf_vrm_free(cgltf_vrm_data* vrm);
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CGLTF_VRM_H_INCLUDED__ */
+
+/* -------------------------------------------------------------------------- */
+
+#if defined(__INTELLISENSE__) || defined(__JETBRAINS_IDE__)
+#define CGLTF_IMPLEMENTATION
+#endif
+
+#ifdef CGLTF_IMPLEMENTATION
+
+#include <math.h>
+
+#define CGLTF_VRM_JSON_SKIP() \
+  i = cgltf_skip_json(tokens, i+1);
+
+/* Diagnostics of the token at `i`, for parsers holding `ctx`, `tokens`, `i` and `json_chunk`. Without a sink
+ * they only cost the test of diagnostic_func. */
+#define CGLTF_VRM_DIAGNOSE(kind, path) \
+  if (ctx->vrm_options->diagnostic_func != NULL) { cgltf_vrm_diagnose(ctx, kind, path, tokens + i, json_chunk); }
+
+#define CGLTF_VRM_LOG_SKIPPED(prefixTag) \
+  CGLTF_VRM_DIAGNOSE(cgltf_vrm_diagnostic_kind_skipped_key, prefixTag) \
+  CGLTF_VRM_JSON_SKIP()
+
+/* cgltf_vrm_string_to_* map unknown strings to max_enum. */
+#define CGLTF_VRM_CHECK_ENUM(value, maxEnum, path) \
+  if ((value) == (maxEnum)) { CGLTF_VRM_DIAGNOSE(cgltf_vrm_diagnostic_kind_bad_enum, path) }
+
+#define CGLTF_VRM_DIAGNOSTICS_PER_KIND 16
+
+/* Size of a glTF array for cgltf_vrm_parse_json_index, the context may have no glTF. */
+#define CGLTF_VRM_GLTF_COUNT(member) ((ctx->gltf != NULL) ? ctx->gltf->member : 0)
+
+#define CGLTF_VRM_RET_STRING_TYPE(typeBase, suffix) \
+  if (cgltf_json_strcmp(tokens, json_chunk, #suffix) == 0) { return typeBase##suffix; }
+
+/* For enum values whose JSON spelling differs from the C suffix (eg. "onlyAuthor"). */
+#define CGLTF_VRM_RET_STRING_TYPE_AS(typeBase, suffix, str) \
+  if (cgltf_json_strcmp(tokens, json_chunk, str) == 0) { return typeBase##suffix; }
+
+/* ----------- Profiling ----------- */
+
+static cgltf_vrm_profiler const* cgltf_vrm_default_profiler = NULL;
+
+void cgltf_vrm_set_profiler(cgltf_vrm_profiler const* profiler)
+{
+  cgltf_vrm_default_profiler = profiler;
+}
+
+/* Zones compile to nothing without CGLTF_VRM_PROFILE. BEGIN declares `zone`, keep it and its END in one block. */
+#ifdef CGLTF_VRM_PROFILE
+static
+uint64_t cgltf_vrm_profile_begin(cgltf_vrm_profiler const* profiler, char const* name)
+{
+  profiler = profiler ? profiler : cgltf_vrm_default_profiler;
+  return (profiler && profiler->begin) ? profiler->begin(profiler->user_data, name) : 0;
+}
+
+static
+void cgltf_vrm_profile_end(cgltf_vrm_profiler const* profiler, uint64_t zone)
+{
+  profiler = profiler ? profiler : cgltf_vrm_default_profiler;
+  if (profiler && profiler->end)
+  {
+    profiler->end(profiler->user_data, zone);
+  }
+}
+
+#define CGLTF_VRM_PROFILE_BEGIN(profiler, zone, name) uint64_t zone = cgltf_vrm_profile_begin(profiler, name)
+#define CGLTF_VRM_PROFILE_END(profiler, zone) cgltf_vrm_profile_end(profiler, zone)
+#else
+#define CGLTF_VRM_PROFILE_BEGIN(profiler, zone, name)
+#define CGLTF_VRM_PROFILE_END(profiler, zone)
+#endif
+
+static
+cgltf_vrm_spec_version cgltf_vrm_string_to_spec_version(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_spec_version_, v_1_0, "1.0")
+  return cgltf_vrm_spec_version_max_enum;
+}
+
+static
+cgltf_vrm_meta_avatar_permission_type cgltf_vrm_string_to_meta_avatar_permission(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_meta_avatar_permission_type_, only_author, "onlyAuthor")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_meta_avatar_permission_type_, only_separately_licensed_person, "onlySeparatelyLicensedPerson")
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_avatar_permission_type_, everyone)
+  return cgltf_vrm_meta_avatar_permission_type_max_enum;
+}
+
+static
+cgltf_vrm_meta_commercial_usage_type cgltf_vrm_string_to_meta_commercial_usage(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_meta_commercial_usage_type_, personal_non_profit, "personalNonProfit")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_meta_commercial_usage_type_, personal_profit, "personalProfit")
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_commercial_usage_type_, corporation)
+  return cgltf_vrm_meta_commercial_usage_type_max_enum;
+}
+
+static
+cgltf_vrm_meta_credit_notation_type cgltf_vrm_string_to_meta_credit_notation(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_credit_notation_type_, required)
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_credit_notation_type_, unnecessary)
+  return cgltf_vrm_meta_credit_notation_type_max_enum;
+}
+
+static
+cgltf_vrm_meta_modification_type cgltf_vrm_string_to_meta_modification(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_meta_modification_type_, prohibited)
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_meta_modification_type_, allow_modification, "allowModification")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_meta_modification_type_, allow_modification_redistribution, "allowModificationRedistribution")
+  return cgltf_vrm_meta_modification_type_max_enum;
+}
+
+static
+cgltf_vrm_first_person_mesh_annotation_type cgltf_vrm_string_to_first_person_mesh_annotation(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_first_person_mesh_annotation_type_, auto)
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_first_person_mesh_annotation_type_, first_person_only, "firstPersonOnly")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_first_person_mesh_annotation_type_, third_person_only, "thirdPersonOnly")
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_first_person_mesh_annotation_type_, both)
+  return cgltf_vrm_first_person_mesh_annotation_type_max_enum;
+}
+
+static
+cgltf_vrm_expression_override_type cgltf_vrm_string_to_expression_override(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_expression_override_type_, none)
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_expression_override_type_, block)
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_expression_override_type_, blend)
+  return cgltf_vrm_expression_override_type_max_enum;
+}
+
+static
+cgltf_vrm_expression_material_color_bind_type cgltf_vrm_string_to_expression_material_color_bind(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_expression_material_color_bind_type_, color)
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_expression_material_color_bind_type_, emission_color, "emissionColor")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_expression_material_color_bind_type_, shade_color, "shadeColor")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_expression_material_color_bind_type_, matcap_color, "matcapColor")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_expression_material_color_bind_type_, rim_color, "rimColor")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_expression_material_color_bind_type_, outline_color, "outlineColor")
+  return cgltf_vrm_expression_material_color_bind_type_max_enum;
+}
+
+static
+cgltf_vrm_look_at_type cgltf_vrm_string_to_look_at(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_look_at_type_, bone)
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_look_at_type_, expression)
+  return cgltf_vrm_look_at_type_max_enum;
+}
+
+static
+cgltf_vrm_spring_bone_collider_shape cgltf_vrm_string_to_spring_bone_collider_shape(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_spring_bone_collider_shape_, sphere)
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_spring_bone_collider_shape_, capsule)
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_spring_bone_collider_shape_, plane)
+  return cgltf_vrm_spring_bone_collider_shape_max_enum;
+}
+
+static
+cgltf_vrm_node_constraint_type cgltf_vrm_string_to_node_constraint_type(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_type_, roll)
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_type_, aim)
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_node_constraint_type_, rotation)
+  return cgltf_vrm_node_constraint_type_max_enum;
+}
+
+static
+cgltf_vrm_node_constraint_roll_axis cgltf_vrm_string_to_node_constraint_roll_axis(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_node_constraint_roll_axis_, x, "X")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_node_constraint_roll_axis_, y, "Y")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_node_constraint_roll_axis_, z, "Z")
+  return cgltf_vrm_node_constraint_roll_axis_max_enum;
+}
+
+static
+cgltf_vrm_node_constraint_aim_axis cgltf_vrm_string_to_node_constraint_aim_axis(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_node_constraint_aim_axis_, positive_x, "PositiveX")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_node_constraint_aim_axis_, positive_y, "PositiveY")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_node_constraint_aim_axis_, positive_z, "PositiveZ")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_node_constraint_aim_axis_, negative_x, "NegativeX")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_node_constraint_aim_axis_, negative_y, "NegativeY")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_node_constraint_aim_axis_, negative_z, "NegativeZ")
+  return cgltf_vrm_node_constraint_aim_axis_max_enum;
+}
+
+static
+cgltf_vrm_mtoon_outline_width_mode cgltf_vrm_string_to_mtoon_outline_width_mode(jsmntok_t const* tokens, uint8_t const* json_chunk)
+{
+  CGLTF_VRM_RET_STRING_TYPE(cgltf_vrm_mtoon_outline_width_mode_, none)
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_mtoon_outline_width_mode_, world_coordinates, "worldCoordinates")
+  CGLTF_VRM_RET_STRING_TYPE_AS(cgltf_vrm_mtoon_outline_width_mode_, screen_coordinates, "screenCoordinates")
+  return cgltf_vrm_mtoon_outline_width_mode_max_enum;
+}
+
+/* ----------- String interning ----------- */
+
+#define CGLTF_VRM_STRING_POOL_BLOCK_SIZE 4096
+
+static
+cgltf_uint cgltf_vrm_hash_string(char const* str, cgltf_size length)
+{
+  /* FNV-1a */
+  cgltf_uint hash = 2166136261u;
+  for (cgltf_size i = 0; i < length; ++i)
+  {
+    hash ^= (uint8_t)str[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static
+cgltf_size cgltf_vrm_string_pool_probe(cgltf_vrm_string_pool const* pool, char const* str, cgltf_size length, cgltf_uint hash)
+{
+  cgltf_size mask = pool->slots_count - 1;
+  cgltf_size slot = hash & mask;
+
+  for (;;)
+  {
+    cgltf_uint entry = pool->slots[slot];
+    if (entry == 0)
+    {
+      return slot;
+    }
+
+    cgltf_size index = entry - 1;
+    if ((pool->hashes[index] == hash) && (strncmp(pool->strings[index], str, length) == 0) && (pool->strings[index][length] == '\0'))
+    {
+      return slot;
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+static
+cgltf_bool cgltf_vrm_string_pool_grow(cgltf_vrm_string_pool* pool)
+{
+  cgltf_memory_options* memory = &pool->memory;
+
+  /* String arrays */
+  if (pool->strings_count == pool->strings_capacity)
+  {
+    cgltf_size capacity = (pool->strings_capacity > 0) ? 2 * pool->strings_capacity : 64;
+    char** strings = (char**)memory->alloc_func(memory->user_data, capacity * sizeof(char*));
+    cgltf_uint* hashes = (cgltf_uint*)memory->alloc_func(memory->user_data, capacity * sizeof(cgltf_uint));
+    if (!strings || !hashes)
+    {
+      if (strings) memory->free_func(memory->user_data, strings);
+      if (hashes) memory->free_func(memory->user_data, hashes);
+      return 0;
+    }
+    if (pool->strings_count > 0)
+    {
+      memcpy(strings, pool->strings, pool->strings_count * sizeof(char*));
+      memcpy(hashes, pool->hashes, pool->strings_count * sizeof(cgltf_uint));
+    }
+    if (pool->strings) memory->free_func(memory->user_data, pool->strings);
+    if (pool->hashes) memory->free_func(memory->user_data, pool->hashes);
+    pool->strings = strings;
+    pool->hashes = hashes;
+    pool->strings_capacity = capacity;
+  }
+
+  /* Hash table, kept at most half full */
+  if (2 * (pool->strings_count + 1) > pool->slots_count)
+  {
+    cgltf_size slots_count = (pool->slots_count > 0) ? 2 * pool->slots_count : 128;
+    cgltf_uint* slots = (cgltf_uint*)memory->alloc_func(memory->user_data, slots_count * sizeof(cgltf_uint));
+    if (!slots)
+    {
+      return 0;
+    }
+    memset(slots, 0, slots_count * sizeof(cgltf_uint));
+
+    for (cgltf_size i = 0; i < pool->strings_count; ++i)
+    {
+      cgltf_size slot = pool->hashes[i] & (slots_count - 1);
+      while (slots[slot] != 0)
+      {
+        slot = (slot + 1) & (slots_count - 1);
+      }
+      slots[slot] = (cgltf_uint)(i + 1);
+    }
+
+    if (pool->slots) memory->free_func(memory->user_data, pool->slots);
+    pool->slots = slots;
+    pool->slots_count = slots_count;
+  }
+
+  return 1;
+}
+
+static
+char* cgltf_vrm_string_pool_store(cgltf_vrm_string_pool* pool, char const* str, cgltf_size length)
+{
+  cgltf_size const header = sizeof(char*);
+
+  if (pool->blocks == NULL || pool->block_used + length + 1 > pool->block_size)
+  {
+    cgltf_size block_size = header + length + 1;
+    if (block_size < CGLTF_VRM_STRING_POOL_BLOCK_SIZE)
+    {
+      block_size = CGLTF_VRM_STRING_POOL_BLOCK_SIZE;
+    }
+
+    char* block = (char*)pool->memory.alloc_func(pool->memory.user_data, block_size);
+    if (!block)
+    {
+      return NULL;
+    }
+    memcpy(block, &pool->blocks, header);
+    pool->blocks = block;
+    pool->block_used = header;
+    pool->block_size = block_size;
+  }
+
+  char* out = pool->blocks + pool->block_used;
+  memcpy(out, str, length);
+  out[length] = '\0';
+  pool->block_used += length + 1;
+
+  return out;
+}
+
+cgltf_result cgltf_vrm_string_pool_init(cgltf_vrm_string_pool* pool, cgltf_memory_options const* memory)
+{
+  if (pool == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  memset(pool, 0, sizeof(cgltf_vrm_string_pool));
+
+  if (memory != NULL)
+  {
+    pool->memory = *memory;
+  }
+  if (pool->memory.alloc_func == NULL)
+  {
+    pool->memory.alloc_func = &cgltf_default_alloc;
+  }
+  if (pool->memory.free_func == NULL)
+  {
+    pool->memory.free_func = &cgltf_default_free;
+  }
+
+  return cgltf_result_success;
+}
+
+char const* cgltf_vrm_string_pool_intern(cgltf_vrm_string_pool* pool, char const* str, cgltf_size length)
+{
+  cgltf_uint hash = cgltf_vrm_hash_string(str, length);
+
+  if (pool->slots_count > 0)
+  {
+    cgltf_size slot = cgltf_vrm_string_pool_probe(pool, str, length, hash);
+    if (pool->slots[slot] != 0)
+    {
+      return pool->strings[pool->slots[slot] - 1];
+    }
+  }
+
+  if (!cgltf_vrm_string_pool_grow(pool))
+  {
+    return NULL;
+  }
+
+  char* copy = cgltf_vrm_string_pool_store(pool, str, length);
+  if (!copy)
+  {
+    return NULL;
+  }
+
+  cgltf_size slot = cgltf_vrm_string_pool_probe(pool, str, length, hash);
+  pool->strings[pool->strings_count] = copy;
+  pool->hashes[pool->strings_count] = hash;
+  pool->slots[slot] = (cgltf_uint)(++pool->strings_count);
+
+  return copy;
+}
+
+char const* cgltf_vrm_string_pool_find(cgltf_vrm_string_pool const* pool, char const* str)
+{
+  if (pool == NULL || pool->slots_count == 0)
+  {
+    return NULL;
+  }
+
+  cgltf_size length = strlen(str);
+  cgltf_size slot = cgltf_vrm_string_pool_probe(pool, str, length, cgltf_vrm_hash_string(str, length));
+
+  return (pool->slots[slot] != 0) ? pool->strings[pool->slots[slot] - 1] : NULL;
+}
+
+void cgltf_vrm_string_pool_free(cgltf_vrm_string_pool* pool)
+{
+  if (!pool)
+  {
+    return;
+  }
+
+  while (pool->blocks != NULL)
+  {
+    char* previous;
+    memcpy(&previous, pool->blocks, sizeof(char*));
+    pool->memory.free_func(pool->memory.user_data, pool->blocks);
+    pool->blocks = previous;
+  }
+
+  if (pool->slots) pool->memory.free_func(pool->memory.user_data, pool->slots);
+  if (pool->strings) pool->memory.free_func(pool->memory.user_data, pool->strings);
+  if (pool->hashes) pool->memory.free_func(pool->memory.user_data, pool->hashes);
+
+  memset(pool, 0, sizeof(cgltf_vrm_string_pool));
+}
+
+#undef CGLTF_VRM_STRING_POOL_BLOCK_SIZE
+
+/* ----------- Parsing context ----------- */
+
+typedef struct cgltf_vrm_parse_context
+{
+  cgltf_options* options;
+  cgltf_vrm_string_pool* strings;
+  cgltf_vrm_options const* vrm_options; /* profiler, budget and diagnostics sink */
+  cgltf_data const* gltf; /* bounds of the glTF indices, NULL when there is none */
+  cgltf_size* diagnostics_count; /* per kind, shared by the chunks of a load */
+  cgltf_int owner_index; /* see cgltf_vrm_diagnostic.owner_index */
+  cgltf_size expressions_count; /* parsed so far, checked against budget.max_expressions */
+} cgltf_vrm_parse_context;
+
+static
+void cgltf_vrm_diagnose(cgltf_vrm_parse_context* ctx, cgltf_vrm_diagnostic_kind kind, char const* path, jsmntok_t const* token, uint8_t const* json_chunk)
+{
+  cgltf_vrm_options const* vrm_options = ctx->vrm_options;
+  cgltf_size limit = (vrm_options->diagnostics_per_kind > 0) ? vrm_options->diagnostics_per_kind : CGLTF_VRM_DIAGNOSTICS_PER_KIND;
+
+  if (++ctx->diagnostics_count[kind] > limit)
+  {
+    return;
+  }
+
+  cgltf_vrm_diagnostic diagnostic;
+  diagnostic.kind = kind;
+  diagnostic.path = path;
+  diagnostic.owner_index = ctx->owner_index;
+  diagnostic.token = (char const*)json_chunk + token->start;
+  diagnostic.token_length = (cgltf_size)(token->end - token->start);
+  diagnostic.offset = (cgltf_size)token->start;
+  vrm_options->diagnostic_func(vrm_options->diagnostic_user_data, &diagnostic);
+}
+
+/* Index value at `i`, reported when outside [0, count). `count` is ignored when the context has no glTF. */
+static
+int cgltf_vrm_parse_json_index(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_size count, char const* path)
+{
+  int index = cgltf_json_to_int(tokens + i, json_chunk);
+
+  if ((index < 0) || ((ctx->gltf != NULL) && ((cgltf_size)index >= count)))
+  {
+    CGLTF_VRM_DIAGNOSE(cgltf_vrm_diagnostic_kind_index_out_of_range, path)
+  }
+  return index;
+}
+
+/* Parse error of a cgltf_vrm_budget limit, clear of the CGLTF_ERROR_* values. */
+#define CGLTF_VRM_ERROR_BUDGET -16
+
+static
+cgltf_bool cgltf_vrm_over_budget(cgltf_size limit, cgltf_size count)
+{
+  return (limit > 0) && (count > limit);
+}
+
+/* Parse a name, interned when the context holds a string pool. */
+static
+int cgltf_vrm_parse_json_name(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, char** out_string)
+{
+  if (ctx->strings == NULL)
+  {
+    return cgltf_parse_json_string(ctx->options, tokens, i, json_chunk, out_string);
+  }
+
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_STRING);
+  if (*out_string)
+  {
+    return CGLTF_ERROR_JSON;
+  }
+
+  char const* name = cgltf_vrm_string_pool_intern(ctx->strings, (char const*)json_chunk + tokens[i].start, (cgltf_size)(tokens[i].end - tokens[i].start));
+  if (!name)
+  {
+    return CGLTF_ERROR_NOMEM;
+  }
+  *out_string = (char*)name;
+
+  return i + 1;
+}
+
+/* Defaults used by cgltf when no allocator is given. */
+static
+void cgltf_vrm_fix_memory_options(cgltf_options* options)
+{
+  if (options->memory.alloc_func == NULL)
+  {
+    options->memory.alloc_func = &cgltf_default_alloc;
+  }
+  if (options->memory.free_func == NULL)
+  {
+    options->memory.free_func = &cgltf_default_free;
+  }
+}
+
+/* ----------- VRMC_vrm ----------- */
+
+static const char* const cgltf_vrm_humanoid_bone_names[cgltf_vrm_humanoid_bone_type_max_enum] = {
+  "hips", "spine", "chest", "upperChest", "neck", "head", "leftEye", "rightEye", "jaw", "leftUpperLeg",
+  "leftLowerLeg", "leftFoot", "leftToes", "rightUpperLeg", "rightLowerLeg", "rightFoot", "rightToes",
+  "leftShoulder", "leftUpperArm", "leftLowerArm", "leftHand", "rightShoulder", "rightUpperArm",
+  "rightLowerArm", "rightHand", "leftThumbMetacarpal", "leftThumbProximal", "leftThumbDistal",
+  "leftIndexProximal", "leftIndexIntermediate", "leftIndexDistal", "leftMiddleProximal",
+  "leftMiddleIntermediate", "leftMiddleDistal", "leftRingProximal", "leftRingIntermediate", "leftRingDistal",
+  "leftLittleProximal", "leftLittleIntermediate", "leftLittleDistal", "rightThumbMetacarpal",
+  "rightThumbProximal", "rightThumbDistal", "rightIndexProximal", "rightIndexIntermediate",
+  "rightIndexDistal", "rightMiddleProximal", "rightMiddleIntermediate", "rightMiddleDistal",
+  "rightRingProximal", "rightRingIntermediate", "rightRingDistal", "rightLittleProximal",
+  "rightLittleIntermediate", "rightLittleDistal",
+};
+
+cgltf_vrm_humanoid_bone_type cgltf_vrm_humanoid_bone_type_from_name(char const* name)
+{
+  for (int i = 0; name && i < cgltf_vrm_humanoid_bone_type_max_enum; ++i)
+  {
+    if (strcmp(name, cgltf_vrm_humanoid_bone_names[i]) == 0)
+    {
+      return (cgltf_vrm_humanoid_bone_type)i;
+    }
+  }
+  return cgltf_vrm_humanoid_bone_type_max_enum;
+}
+
+char const* cgltf_vrm_humanoid_bone_type_name(cgltf_vrm_humanoid_bone_type type)
+{
+  return ((unsigned)type < cgltf_vrm_humanoid_bone_type_max_enum) ? cgltf_vrm_humanoid_bone_names[type] : NULL;
+}
+
+static
+int cgltf_vrm_parse_json_humanoid(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_humanoid* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  ++i;
+
+  if (cgltf_json_strcmp(tokens + i, json_chunk, "humanBones") == 0)
+  {
+    ++i;
+    if (tokens[i].type != JSMN_OBJECT && tokens[i].type != JSMN_ARRAY)
+    {
+      return CGLTF_ERROR_JSON;
+    }
+    if (cgltf_vrm_over_budget(ctx->vrm_options->budget.max_human_bones, tokens[i].size))
+    {
+      return CGLTF_VRM_ERROR_BUDGET;
+    }
+    out->human_bones = (cgltf_vrm_humanoid_bone*)cgltf_calloc(ctx->options, sizeof(cgltf_vrm_humanoid_bone), tokens[i].size);
+    if (!out->human_bones)
+    {
+      return CGLTF_ERROR_NOMEM;
+    }
+    out->human_bones_count = tokens[i].size;
+
+    ++i;
+    for (cgltf_size j = 0; j < out->human_bones_count; ++j)
+    {
+      cgltf_vrm_humanoid_bone *bone = &out->human_bones[j];
+
+        if (tokens[i].type == JSMN_OBJECT) {
+            // the object looks like this:
+            //{
+            //  "bone": "hips",
+            //  "node": 1,
+            //  "useDefaultValues": true
+            //}
+            int object = i; // remember where the object was
+            i += 1;
+            for (int k = 0; k < 3; ++k) {
+                if (cgltf_json_strcmp(tokens + i, json_chunk, "bone") == 0) {
+                    i += 1; // skip "bone"
+                    i = cgltf_vrm_parse_json_name(ctx, tokens, i, json_chunk, &bone->name);
+                    if (i < 0) {
+                        return i;
+                    }
+                }
+                if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0) {
+                    i += 1; // skip "node"
+                    int nodeIndex = cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(nodes_count), "humanoid.humanBones."); // this just adds 1
+                    bone->node = CGLTF_PTRINDEX(cgltf_node, nodeIndex);
+                    i = cgltf_skip_json(tokens, i);
+                }
+
+                /*if (cgltf_json_strcmp(tokens + i, json_chunk, "useDefaultValues") == 0) {
+                    i += 1; // skip "useDefaultValues"
+                    // this value is not currently tracked
+                    if (cgltf_json_strcmp(tokens + i, json_chunk, "true") == 0) {
+                        //printf("useDefaultValues\n");
+                    } else {
+                        //printf("not useDefaultValues\n");
+                    }
+                    i = cgltf_skip_json(tokens, i);
+                }*/
+            }
+            i = cgltf_skip_json(tokens, object); // skip all the other data in this object
+        } else {
+            // this clause is what the original code did, is it correct?
+            CGLTF_CHECK_KEY(tokens[i]);
+            i = cgltf_vrm_parse_json_name(ctx, tokens, i, json_chunk, &bone->name);
+            if (i < 0) {
+                return i;
+            }
+
+            i += 2;
+            bone->node = CGLTF_PTRINDEX(cgltf_node, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(nodes_count), "humanoid.humanBones."));
+            i = cgltf_skip_json(tokens, i);
+        }
+    }
+  }
+
+  for (cgltf_size j = 0; j < out->human_bones_count; ++j)
+  {
+    out->human_bones[j].type = cgltf_vrm_humanoid_bone_type_from_name(out->human_bones[j].name);
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_meta(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_meta* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  memset(out, 0, sizeof(cgltf_vrm_meta));
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "name") == 0)
+    {
+      i = cgltf_parse_json_string(ctx->options, tokens, i + 1, json_chunk, &out->name);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "licenseUrl") == 0)
+    {
+      i = cgltf_parse_json_string(ctx->options, tokens, i + 1, json_chunk, &out->license_url);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "authors") == 0)
+    {
+      i = cgltf_parse_json_array(ctx->options, tokens, i + 1, json_chunk, sizeof(char*), (void**)&out->authors, &out->authors_count);
+      if (i < 0)
+      {
+        return i;
+      }
+      for (cgltf_size k = 0; k < out->authors_count; ++k)
+      {
+        i = cgltf_parse_json_string(ctx->options, tokens, i, json_chunk, &out->authors[k]);
+        if (i < 0)
+        {
+          return i;
+        }
+      }
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "thumbnailImage") == 0)
+    {
+      out->has_thumbnail_image = 1;
+      ++i;
+      out->thumbnail_image = CGLTF_PTRINDEX(cgltf_image, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(images_count), "VRMC_vrm.meta."));
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "version") == 0)
+    {
+      i = cgltf_parse_json_string(ctx->options, tokens, i + 1, json_chunk, &out->version);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "copyrightInformation") == 0)
+    {
+      i = cgltf_parse_json_string(ctx->options, tokens, i + 1, json_chunk, &out->copyright_information);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "contactInformation") == 0)
+    {
+      i = cgltf_parse_json_string(ctx->options, tokens, i + 1, json_chunk, &out->contact_information);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "allowAntisocialOrHateUsage") == 0)
+    {
+      ++i;
+      out->allow_antisocial_or_hate_usage = cgltf_json_to_bool(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "allowExcessivelySexualUsage") == 0)
+    {
+      ++i;
+      out->allow_excessively_sexual_usage = cgltf_json_to_bool(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "allowExcessivelyViolentUsage") == 0)
+    {
+      ++i;
+      out->allow_excessively_violent_usage = cgltf_json_to_bool(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "allowPoliticalOrReligiousUsage") == 0)
+    {
+      ++i;
+      out->allow_political_or_religious_usage = cgltf_json_to_bool(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "avatarPermission") == 0)
+    {
+      ++i;
+      out->avatar_permission = cgltf_vrm_string_to_meta_avatar_permission(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->avatar_permission, cgltf_vrm_meta_avatar_permission_type_max_enum, "VRMC_vrm.meta.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "commercialUsage") == 0)
+    {
+      ++i;
+      out->commercial_usage = cgltf_vrm_string_to_meta_commercial_usage(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->commercial_usage, cgltf_vrm_meta_commercial_usage_type_max_enum, "VRMC_vrm.meta.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "creditNotation") == 0)
+    {
+      ++i;
+      out->credit_notation = cgltf_vrm_string_to_meta_credit_notation(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->credit_notation, cgltf_vrm_meta_credit_notation_type_max_enum, "VRMC_vrm.meta.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "modification") == 0)
+    {
+      ++i;
+      out->modification = cgltf_vrm_string_to_meta_modification(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->modification, cgltf_vrm_meta_modification_type_max_enum, "VRMC_vrm.meta.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "allowRedistribution") == 0)
+    {
+      ++i;
+      out->allow_redistribution = cgltf_json_to_bool(tokens + i, json_chunk);
+      ++i;
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.meta.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_first_person(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_first_person* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens+i, json_chunk, "meshAnnotations") == 0)
+    {
+      i = cgltf_parse_json_array(ctx->options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_first_person_mesh_annotation), (void**)&out->mesh_annotations, &out->mesh_annotations_count);
+
+      if (i < 0)
+      {
+        return i;
+      }
+      for (cgltf_size k = 0; k < out->mesh_annotations_count; ++k)
+      {
+        cgltf_size nElems = tokens[i].size;
+        ++i;
+
+        for (cgltf_size l = 0; l < nElems; ++l)
+        {
+          if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0)
+          {
+            ++i;
+            out->mesh_annotations[k].node = CGLTF_PTRINDEX(cgltf_node, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(nodes_count), "VRMC_vrm.firstPerson.meshAnnotations."));
+            ++i;
+          }
+          else if (cgltf_json_strcmp(tokens + i, json_chunk, "type") == 0)
+          {
+            ++i;
+            out->mesh_annotations[k].type = cgltf_vrm_string_to_first_person_mesh_annotation(tokens + i, json_chunk);
+            CGLTF_VRM_CHECK_ENUM(out->mesh_annotations[k].type, cgltf_vrm_first_person_mesh_annotation_type_max_enum, "VRMC_vrm.firstPerson.meshAnnotations.")
+            ++i;
+          }
+        }
+        if (i < 0)
+        {
+          return i;
+        }
+      }
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.firstPerson.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_expression_morph_target_binds(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_expression_morph_target_bind* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  cgltf_size size = tokens[i].size;
+  ++i;
+
+  for (cgltf_size j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "index") == 0)
+    {
+      ++i;
+      out->index = cgltf_json_to_int(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0)
+    {
+      ++i;
+      out->node = CGLTF_PTRINDEX(cgltf_node, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(nodes_count), "VRMC_vrm.expressions.morphTargetBinds."));
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "weight") == 0)
+    {
+      ++i;
+      out->weight = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.expressions.morphTargetBinds.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_expression_material_color_binds(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_expression_material_color_bind* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  cgltf_size size = tokens[i].size;
+  ++i;
+
+  out->type = cgltf_vrm_expression_material_color_bind_type_max_enum;
+
+  for (cgltf_size j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "material") == 0)
+    {
+      ++i;
+      out->material = CGLTF_PTRINDEX(cgltf_material, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(materials_count), "VRMC_vrm.expressions.materialColorBinds."));
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "type") == 0)
+    {
+      ++i;
+      out->type = cgltf_vrm_string_to_expression_material_color_bind(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->type, cgltf_vrm_expression_material_color_bind_type_max_enum, "VRMC_vrm.expressions.materialColorBinds.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "targetValue") == 0)
+    {
+      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->target_value, 4);
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.expressions.materialColorBinds.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_expression_texture_transform_binds(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_expression_texture_transform_bind* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  cgltf_size size = tokens[i].size;
+  ++i;
+
+  out->scale[0] = 1.0f;
+  out->scale[1] = 1.0f;
+
+  for (cgltf_size j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "material") == 0)
+    {
+      ++i;
+      out->material = CGLTF_PTRINDEX(cgltf_material, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(materials_count), "VRMC_vrm.expressions.textureTransformBinds."));
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "scale") == 0)
+    {
+      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->scale, 2);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "offset") == 0)
+    {
+      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->offset, 2);
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.expressions.textureTransformBinds.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+cgltf_size cgltf_vrm_expression_binds_count(cgltf_vrm_expression const* expression)
+{
+  return expression->morph_target_binds_count + expression->material_color_binds_count + expression->texture_transform_binds_count;
+}
+
+static
+int cgltf_vrm_parse_json_expressions_dict(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_expression** out, cgltf_size *out_size, char const* tag)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  ctx->expressions_count += tokens[i].size;
+  if (cgltf_vrm_over_budget(ctx->vrm_options->budget.max_expressions, ctx->expressions_count))
+  {
+    return CGLTF_VRM_ERROR_BUDGET;
+  }
+
+  *out = (cgltf_vrm_expression*)cgltf_calloc(ctx->options, sizeof(cgltf_vrm_expression), tokens[i].size);
+  if (!*out)
+  {
+    return CGLTF_ERROR_NOMEM;
+  }
+  *out_size = tokens[i].size;
+  ++i;
+
+  for (cgltf_size j = 0; j < *out_size; ++j)
+  {
+    cgltf_vrm_expression *expression = &(*out)[j];
+
+    CGLTF_CHECK_KEY(tokens[i]);
+    i = cgltf_vrm_parse_json_name(ctx, tokens, i, json_chunk, &expression->name);
+    if (i < 0)
+    {
+      return i;
+    }
+
+    cgltf_size nElems = tokens[i].size;
+    ++i;
+
+    for (cgltf_size k = 0; k < nElems; ++k)
+    {
+      CGLTF_CHECK_KEY(tokens[i]);
+
+      if (cgltf_json_strcmp(tokens+i, json_chunk, "isBinary") == 0)
+      {
+        ++i;
+        expression->is_binary = cgltf_json_to_bool(tokens + i, json_chunk);
+        ++i;
+      }
+      else if (cgltf_json_strcmp(tokens+i, json_chunk, "overrideBlink") == 0)
+      {
+        ++i;
+        expression->override_blink = cgltf_vrm_string_to_expression_override(tokens + i, json_chunk);
+        CGLTF_VRM_CHECK_ENUM(expression->override_blink, cgltf_vrm_expression_override_type_max_enum, tag)
+        ++i;
+      }
+      else if (cgltf_json_strcmp(tokens+i, json_chunk, "overrideMouth") == 0)
+      {
+        ++i;
+        expression->override_mouth = cgltf_vrm_string_to_expression_override(tokens + i, json_chunk);
+        CGLTF_VRM_CHECK_ENUM(expression->override_mouth, cgltf_vrm_expression_override_type_max_enum, tag)
+        ++i;
+      }
+      else if (cgltf_json_strcmp(tokens+i, json_chunk, "overrideLookAt") == 0)
+      {
+        ++i;
+        expression->override_look_at = cgltf_vrm_string_to_expression_override(tokens + i, json_chunk);
+        CGLTF_VRM_CHECK_ENUM(expression->override_look_at, cgltf_vrm_expression_override_type_max_enum, tag)
+        ++i;
+      }
+      else if (cgltf_json_strcmp(tokens+i, json_chunk, "morphTargetBinds") == 0)
+      {
+        if (cgltf_vrm_over_budget(ctx->vrm_options->budget.max_binds_per_expression, cgltf_vrm_expression_binds_count(expression) + tokens[i + 1].size))
+        {
+          return CGLTF_VRM_ERROR_BUDGET;
+        }
+        i = cgltf_parse_json_array(ctx->options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_expression_morph_target_bind), (void**)&expression->morph_target_binds, &expression->morph_target_binds_count);
+        if (i < 0)
+        {
+          return i;
+        }
+        for (cgltf_size l = 0; l < expression->morph_target_binds_count; ++l)
+        {
+          i = cgltf_vrm_parse_json_expression_morph_target_binds(ctx, tokens, i, json_chunk, &expression->morph_target_binds[l]);
+          if (i < 0)
+          {
+            return i;
+          }
+        }
+      }
+      else if (cgltf_json_strcmp(tokens+i, json_chunk, "materialColorBinds") == 0)
+      {
+        if (cgltf_vrm_over_budget(ctx->vrm_options->budget.max_binds_per_expression, cgltf_vrm_expression_binds_count(expression) + tokens[i + 1].size))
+        {
+          return CGLTF_VRM_ERROR_BUDGET;
+        }
+        i = cgltf_parse_json_array(ctx->options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_expression_material_color_bind), (void**)&expression->material_color_binds, &expression->material_color_binds_count);
+        if (i < 0)
+        {
+          return i;
+        }
+        for (cgltf_size l = 0; l < expression->material_color_binds_count; ++l)
+        {
+          i = cgltf_vrm_parse_json_expression_material_color_binds(ctx, tokens, i, json_chunk, &expression->material_color_binds[l]);
+          if (i < 0)
+          {
+            return i;
+          }
+        }
+      }
+      else if (cgltf_json_strcmp(tokens+i, json_chunk, "textureTransformBinds") == 0)
+      {
+        if (cgltf_vrm_over_budget(ctx->vrm_options->budget.max_binds_per_expression, cgltf_vrm_expression_binds_count(expression) + tokens[i + 1].size))
+        {
+          return CGLTF_VRM_ERROR_BUDGET;
+        }
+        i = cgltf_parse_json_array(ctx->options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_expression_texture_transform_bind), (void**)&expression->texture_transform_binds, &expression->texture_transform_binds_count);
+        if (i < 0)
+        {
+          return i;
+        }
+        for (cgltf_size l = 0; l < expression->texture_transform_binds_count; ++l)
+        {
+          i = cgltf_vrm_parse_json_expression_texture_transform_binds(ctx, tokens, i, json_chunk, &expression->texture_transform_binds[l]);
+          if (i < 0)
+          {
+            return i;
+          }
+        }
+      }
+      else
+      {
+        CGLTF_VRM_LOG_SKIPPED(tag)
+      }
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_expressions(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_expressions* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  memset(out, 0, sizeof(cgltf_vrm_expressions));
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens+i, json_chunk, "preset") == 0)
+    {
+      i = cgltf_vrm_parse_json_expressions_dict(ctx, tokens, i + 1, json_chunk, &out->preset, &out->preset_count, "VRMC_vrm.expressions.preset");
+    }
+    else if (cgltf_json_strcmp(tokens+i, json_chunk, "custom") == 0)
+    {
+      i = cgltf_vrm_parse_json_expressions_dict(ctx, tokens, i + 1, json_chunk, &out->custom, &out->custom_count, "VRMC_vrm.expressions.custom");
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.expressions.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_look_at_range_map(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_look_at_range_map* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  cgltf_size size = tokens[i].size;
+  ++i;
+
+  for (cgltf_size j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "inputMaxValue") == 0)
+    {
+      ++i;
+      out->input_max_value = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outputScale") == 0)
+    {
+      ++i;
+      out->output_scale = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.lookAt.rangeMap??")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_look_at(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_look_at* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  memset(out, 0, sizeof(cgltf_vrm_look_at));
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "type") == 0)
+    {
+      ++i;
+      out->type = cgltf_vrm_string_to_look_at(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->type, cgltf_vrm_look_at_type_max_enum, "VRMC_vrm.lookAt.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "offsetFromHeadBone") == 0)
+    {
+      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->offset_from_head_bone, 3);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rangeMapHorizontalInner") == 0)
+    {
+      i = cgltf_vrm_parse_json_look_at_range_map(ctx, tokens, i + 1, json_chunk, &out->range_map_horizontal_inner);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rangeMapHorizontalOuter") == 0)
+    {
+      i = cgltf_vrm_parse_json_look_at_range_map(ctx, tokens, i + 1, json_chunk, &out->range_map_horizontal_outer);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rangeMapVerticalUp") == 0)
+    {
+      i = cgltf_vrm_parse_json_look_at_range_map(ctx, tokens, i + 1, json_chunk, &out->range_map_vertical_up);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rangeMapVerticalDown") == 0)
+    {
+      i = cgltf_vrm_parse_json_look_at_range_map(ctx, tokens, i + 1, json_chunk, &out->range_map_vertical_down);
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.lookAt.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_vrm(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_core* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  memset(out, 0, sizeof(cgltf_vrm_core));
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "specVersion") == 0)
+    {
+      ++i;
+      out->spec_version = cgltf_vrm_string_to_spec_version(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->spec_version, cgltf_vrm_spec_version_max_enum, "VRMC_vrm.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "humanoid") == 0)
+    {
+      CGLTF_VRM_PROFILE_BEGIN(ctx->vrm_options->profiler, zone, "VRMC_vrm.humanoid");
+      i = cgltf_vrm_parse_json_humanoid(ctx, tokens, i + 1, json_chunk, &out->humanoid);
+      CGLTF_VRM_PROFILE_END(ctx->vrm_options->profiler, zone);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "meta") == 0)
+    {
+      CGLTF_VRM_PROFILE_BEGIN(ctx->vrm_options->profiler, zone, "VRMC_vrm.meta");
+      i = cgltf_vrm_parse_json_meta(ctx, tokens, i + 1, json_chunk, &out->meta);
+      CGLTF_VRM_PROFILE_END(ctx->vrm_options->profiler, zone);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "firstPerson") == 0)
+    {
+      CGLTF_VRM_PROFILE_BEGIN(ctx->vrm_options->profiler, zone, "VRMC_vrm.firstPerson");
+      i = cgltf_vrm_parse_json_first_person(ctx, tokens, i + 1, json_chunk, &out->first_person);
+      CGLTF_VRM_PROFILE_END(ctx->vrm_options->profiler, zone);
+      out->has_first_person = 1;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "expressions") == 0)
+    {
+      CGLTF_VRM_PROFILE_BEGIN(ctx->vrm_options->profiler, zone, "VRMC_vrm.expressions");
+      i = cgltf_vrm_parse_json_expressions(ctx, tokens, i + 1, json_chunk, &out->expressions);
+      CGLTF_VRM_PROFILE_END(ctx->vrm_options->profiler, zone);
+      out->has_expressions = 1;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "lookAt") == 0)
+    {
+      CGLTF_VRM_PROFILE_BEGIN(ctx->vrm_options->profiler, zone, "VRMC_vrm.lookAt");
+      i = cgltf_vrm_parse_json_look_at(ctx, tokens, i + 1, json_chunk, &out->look_at);
+      CGLTF_VRM_PROFILE_END(ctx->vrm_options->profiler, zone);
+      out->has_look_at = 1;
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+/* ----------- VRMC_springBone ----------- */
+
+/* Parses a shape object ({ "sphere": {..} }, { "capsule": {..} } or { "plane": {..} }). */
+static
+int cgltf_vrm_parse_json_spring_bone_collider_shape(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone_collider* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    /* Unknown shapes are skipped, a shape parsed before them is kept. */
+    cgltf_vrm_spring_bone_collider_shape shape = cgltf_vrm_string_to_spring_bone_collider_shape(tokens + i, json_chunk);
+    if (shape == cgltf_vrm_spring_bone_collider_shape_max_enum)
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.colliders.shape.")
+      if (i < 0)
+      {
+        return i;
+      }
+      continue;
+    }
+    out->shape = shape;
+    ++i;
+
+    CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+    int elems = tokens[i].size;
+    ++i;
+
+    if (out->shape == cgltf_vrm_spring_bone_collider_shape_plane)
+    {
+      out->normal[0] = 0.0f;
+      out->normal[1] = 0.0f;
+      out->normal[2] = 1.0f;
+    }
+
+    for (int k = 0; k < elems; ++k)
+    {
+      CGLTF_CHECK_KEY(tokens[i]);
+
+      if (cgltf_json_strcmp(tokens + i, json_chunk, "radius") == 0)
+      {
+        ++i;
+        out->radius = cgltf_json_to_float(tokens + i, json_chunk);
+        ++i;
+      }
+      else if (cgltf_json_strcmp(tokens + i, json_chunk, "offset") == 0)
+      {
+        i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->offset, 3);
+      }
+      else if (cgltf_json_strcmp(tokens + i, json_chunk, "tail") == 0)
+      {
+        i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->tail, 3);
+      }
+      else if (cgltf_json_strcmp(tokens + i, json_chunk, "normal") == 0)
+      {
+        i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->normal, 3);
+      }
+      else if (cgltf_json_strcmp(tokens + i, json_chunk, "inside") == 0)
+      {
+        ++i;
+        out->inside = cgltf_json_to_bool(tokens + i, json_chunk);
+        ++i;
+      }
+      else
+      {
+        CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.colliders.shape.")
+      }
+
+      if (i < 0)
+      {
+        return i;
+      }
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_spring_bone_extended_collider(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone_collider* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "shape") == 0)
+    {
+      i = cgltf_vrm_parse_json_spring_bone_collider_shape(ctx, tokens, i + 1, json_chunk, out);
+      out->has_extended_shape = (out->shape != cgltf_vrm_spring_bone_collider_shape_max_enum);
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone_extended_collider.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_spring_bone_colliders(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone_collider* out)
+{
+  cgltf_vrm_spring_bone_collider extended;
+
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  memset(&extended, 0, sizeof(extended));
+  extended.shape = cgltf_vrm_spring_bone_collider_shape_max_enum;
+
+  cgltf_size size = tokens[i].size;
+  ++i;
+
+  for (cgltf_size j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0)
+    {
+      ++i;
+      out->node = CGLTF_PTRINDEX(cgltf_node, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(nodes_count), "VRMC_springBone.colliders."));
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shape") == 0)
+    {
+      i = cgltf_vrm_parse_json_spring_bone_collider_shape(ctx, tokens, i + 1, json_chunk, out);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "extensions") == 0)
+    {
+      ++i;
+      CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+      int extensions = tokens[i].size;
+      ++i;
+
+      for (int k = 0; k < extensions; ++k)
+      {
+        CGLTF_CHECK_KEY(tokens[i]);
+
+        if (cgltf_json_strcmp(tokens + i, json_chunk, "VRMC_springBone_extended_collider") == 0)
+        {
+          i = cgltf_vrm_parse_json_spring_bone_extended_collider(ctx, tokens, i + 1, json_chunk, &extended);
+        }
+        else
+        {
+          CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.colliders.extensions.")
+        }
+
+        if (i < 0)
+        {
+          return i;
+        }
+      }
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.colliders.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  if (extended.has_extended_shape)
+  {
+    extended.node = out->node;
+    *out = extended;
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_spring_bone_collider_groups(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone_collider_group* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  cgltf_size size = tokens[i].size;
+  ++i;
+
+  for (cgltf_size j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "name") == 0)
+    {
+      i = cgltf_vrm_parse_json_name(ctx, tokens, i + 1, json_chunk, &out->name);
+      if (i < 0)
+      {
+        return i;
+      }
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "colliders") == 0)
+    {
+      i = cgltf_parse_json_array(ctx->options, tokens, i + 1, json_chunk, sizeof(int), (void**)&out->colliders, &out->colliders_count);
+      if (i < 0)
+      {
+        return i;
+      }
+      for (cgltf_size k = 0; k < out->colliders_count; ++k)
+      {
+        out->colliders[k] = cgltf_json_to_int(tokens + i, json_chunk);
+        ++i;
+      }
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.colliderGroups.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_spring_bone_spring_joint(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone_spring_joint* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  memset(out, 0, sizeof(cgltf_vrm_spring_bone_spring_joint));
+  out->stiffness = 1.0f;
+  out->gravity_dir[1] = -1.0f;
+  out->drag_force = 0.5f;
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0)
+    {
+      ++i;
+      out->node = CGLTF_PTRINDEX(cgltf_node, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(nodes_count), "VRMC_springBone.springJoints."));
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "dragForce") == 0)
+    {
+      ++i;
+      out->drag_force = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "hitRadius") == 0)
+    {
+      ++i;
+      out->hit_radius = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "stiffness") == 0)
+    {
+      ++i;
+      out->stiffness = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "gravityPower") == 0)
+    {
+      ++i;
+      out->gravity_power = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "gravityDir") == 0)
+    {
+      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->gravity_dir, 3);
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.springJoints.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_spring_bone_springs(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone_spring* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  cgltf_size size = tokens[i].size;
+  ++i;
+
+  for (cgltf_size j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "name") == 0)
+    {
+      i = cgltf_vrm_parse_json_name(ctx, tokens, i + 1, json_chunk, &out->name);
+      if (i < 0)
+      {
+        return i;
+      }
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "joints") == 0)
+    {
+      if (cgltf_vrm_over_budget(ctx->vrm_options->budget.max_joints_per_spring, tokens[i + 1].size))
+      {
+        return CGLTF_VRM_ERROR_BUDGET;
+      }
+      i = cgltf_parse_json_array(ctx->options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_spring_bone_spring_joint), (void**)&out->joints, &out->joints_count);
+      if (i < 0)
+      {
+        return i;
+      }
+      for (cgltf_size k = 0; k < out->joints_count; ++k)
+      {
+        i = cgltf_vrm_parse_json_spring_bone_spring_joint(ctx, tokens, i, json_chunk, &out->joints[k]);
+        if (i < 0)
+        {
+          return i;
+        }
+      }
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "colliderGroups") == 0)
+    {
+      i = cgltf_parse_json_array(ctx->options, tokens, i + 1, json_chunk, sizeof(int), (void**)&out->collider_groups, &out->collider_groups_count);
+      if (i < 0)
+      {
+        return i;
+      }
+      for (cgltf_size k = 0; k < out->collider_groups_count; ++k)
+      {
+        out->collider_groups[k] = cgltf_json_to_int(tokens + i, json_chunk);
+        ++i;
+      }
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "center") == 0)
+    {
+      ++i;
+      out->center = CGLTF_PTRINDEX(cgltf_node, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(nodes_count), "VRMC_springBone.springs."));
+      ++i;
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.springs.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_spring_bone(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  memset(out, 0, sizeof(cgltf_vrm_spring_bone));
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "specVersion") == 0)
+    {
+      ++i;
+      out->spec_version = cgltf_vrm_string_to_spec_version(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->spec_version, cgltf_vrm_spec_version_max_enum, "VRMC_springBone.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "colliders") == 0)
+    {
+      if (cgltf_vrm_over_budget(ctx->vrm_options->budget.max_colliders, tokens[i + 1].size))
+      {
+        return CGLTF_VRM_ERROR_BUDGET;
+      }
+      CGLTF_VRM_PROFILE_BEGIN(ctx->vrm_options->profiler, zone, "VRMC_springBone.colliders");
+      i = cgltf_parse_json_array(ctx->options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_spring_bone_collider), (void**)&out->colliders, &out->colliders_count);
+      for (cgltf_size k = 0; (i >= 0) && (k < out->colliders_count); ++k)
+      {
+        i = cgltf_vrm_parse_json_spring_bone_colliders(ctx, tokens, i, json_chunk, &out->colliders[k]);
+      }
+      CGLTF_VRM_PROFILE_END(ctx->vrm_options->profiler, zone);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "colliderGroups") == 0)
+    {
+      CGLTF_VRM_PROFILE_BEGIN(ctx->vrm_options->profiler, zone, "VRMC_springBone.colliderGroups");
+      i = cgltf_parse_json_array(ctx->options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_spring_bone_collider_group), (void**)&out->collider_groups, &out->collider_groups_count);
+      for (cgltf_size k = 0; (i >= 0) && (k < out->collider_groups_count); ++k)
+      {
+        i = cgltf_vrm_parse_json_spring_bone_collider_groups(ctx, tokens, i, json_chunk, &out->collider_groups[k]);
+      }
+      CGLTF_VRM_PROFILE_END(ctx->vrm_options->profiler, zone);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "springs") == 0)
+    {
+      if (cgltf_vrm_over_budget(ctx->vrm_options->budget.max_springs, tokens[i + 1].size))
+      {
+        return CGLTF_VRM_ERROR_BUDGET;
+      }
+      CGLTF_VRM_PROFILE_BEGIN(ctx->vrm_options->profiler, zone, "VRMC_springBone.springs");
+      i = cgltf_parse_json_array(ctx->options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_spring_bone_spring), (void**)&out->springs, &out->springs_count);
+      for (cgltf_size k = 0; (i >= 0) && (k < out->springs_count); ++k)
+      {
+        i = cgltf_vrm_parse_json_spring_bone_springs(ctx, tokens, i, json_chunk, &out->springs[k]);
+      }
+      CGLTF_VRM_PROFILE_END(ctx->vrm_options->profiler, zone);
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+/* ----------- VRMC_node_constraint ----------- */
+
+static
+cgltf_int cgltf_vrm_node_extension_index(cgltf_node* node, char const* extension)
+{
+  if (node == NULL || extension == NULL)
+  {
+    return -1;
+  }
+
+  for (cgltf_size i = 0; i < node->extensions_count; ++i)
+  {
+    if (strcmp(node->extensions[i].name, extension) == 0)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static
+cgltf_extension* cgltf_vrm_get_node_extension(cgltf_node* node, char const* extension)
+{
+  cgltf_int index = cgltf_vrm_node_extension_index(node, extension);
+  return (index >= 0) ? &node->extensions[index] : NULL;
+}
+
+static
+int cgltf_vrm_parse_json_node_constraint(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_node_constraint* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  memset(out, 0, sizeof(cgltf_vrm_node_constraint));
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "specVersion") == 0)
+    {
+      ++i;
+      out->spec_version = cgltf_vrm_string_to_spec_version(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->spec_version, cgltf_vrm_spec_version_max_enum, "VRMC_node_constraint.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "constraint") == 0)
+    {
+      ++i;
+      CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+      ++i;
+      CGLTF_CHECK_KEY(tokens[i]);
+      out->type = cgltf_vrm_string_to_node_constraint_type(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->type, cgltf_vrm_node_constraint_type_max_enum, "VRMC_node_constraint.constraint.")
+      ++i;
+      CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+      cgltf_size nElems = tokens[i].size;
+      ++i;
+
+      for (cgltf_size k = 0; k < nElems; ++k)
+      {
+        CGLTF_CHECK_KEY(tokens[i]);
+
+        if (cgltf_json_strcmp(tokens + i, json_chunk, "source") == 0)
+        {
+          ++i;
+          out->source = CGLTF_PTRINDEX(cgltf_node, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(nodes_count), "VRMC_node_constraint.constraint."));
+          ++i;
+        }
+        else if (cgltf_json_strcmp(tokens + i, json_chunk, "weight") == 0)
+        {
+          ++i;
+          out->weight = cgltf_json_to_float(tokens + i, json_chunk);
+          ++i;
+        }
+        else if (cgltf_json_strcmp(tokens + i, json_chunk, "aimAxis") == 0)
+        {
+          ++i;
+          out->axis.aim = cgltf_vrm_string_to_node_constraint_aim_axis(tokens + i, json_chunk);
+          CGLTF_VRM_CHECK_ENUM(out->axis.aim, cgltf_vrm_node_constraint_aim_axis_max_enum, "VRMC_node_constraint.constraint.")
+          ++i;
+        }
+        else if (cgltf_json_strcmp(tokens + i, json_chunk, "rollAxis") == 0)
+        {
+          ++i;
+          out->axis.roll = cgltf_vrm_string_to_node_constraint_roll_axis(tokens + i, json_chunk);
+          CGLTF_VRM_CHECK_ENUM(out->axis.roll, cgltf_vrm_node_constraint_roll_axis_max_enum, "VRMC_node_constraint.constraint.")
+          ++i;
+        }
+        else
+        {
+          CGLTF_VRM_LOG_SKIPPED("VRMC_node_constraint.constraint.")
+        }
+
+        if (i < 0)
+        {
+          return i;
+        }
+      }
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_node_constraint.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+/* ----------- VRMC_materials_mtoon ----------- */
+
+static
+cgltf_int cgltf_vrm_material_extension_index(cgltf_material* material, char const* extension)
+{
+  if (material == NULL || extension == NULL)
+  {
+    return -1;
+  }
+
+  for (cgltf_size i = 0; i < material->extensions_count; ++i)
+  {
+    if (strcmp(material->extensions[i].name, extension) == 0)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static
+cgltf_extension* cgltf_vrm_get_material_extension(cgltf_material* material, char const* extension)
+{
+  cgltf_int index = cgltf_vrm_material_extension_index(material, extension);
+  return (index >= 0) ? &material->extensions[index] : NULL;
+}
+
+static
+int cgltf_vrm_parse_json_mtoon_texture_info(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_mtoon_texture_info* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  memset(out, 0, sizeof(cgltf_vrm_mtoon_texture_info));
+
+  cgltf_size size = tokens[i].size;
+  ++i;
+
+  for (cgltf_size j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "index") == 0)
+    {
+      ++i;
+      out->index = cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(textures_count), "VRMC_materials_mtoon.textureInfo.");
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "texCoord") == 0)
+    {
+      ++i;
+      out->tex_coord = cgltf_json_to_int(tokens + i, json_chunk);
+      ++i;
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_materials_mtoon.textureInfo.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_mtoon_shading_shift_texture_info(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_mtoon_shading_shift_texture_info* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  memset(out, 0, sizeof(cgltf_vrm_mtoon_shading_shift_texture_info));
+  out->scale = 1.0f;
+
+  cgltf_size size = tokens[i].size;
+  ++i;
+
+  for (cgltf_size j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "index") == 0)
+    {
+      ++i;
+      out->index = cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(textures_count), "VRMC_materials_mtoon.shadingShiftTextureInfo.");
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "texCoord") == 0)
+    {
+      ++i;
+      out->tex_coord = cgltf_json_to_int(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "scale") == 0)
+    {
+      ++i;
+      out->scale = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_materials_mtoon.shadingShiftTextureInfo.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_material_mtoon(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_mtoon* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  memset(out, 0, sizeof(cgltf_vrm_mtoon));
+  out->shade_multiply_texture.index = -1;
+  out->shading_shift_texture.index = -1;
+  out->shading_shift_texture.scale = 1.0f;
+  out->shading_toony_factor = 0.9f;
+  out->gi_equalization_factor = 0.9f;
+  out->matcap_factor[0] = out->matcap_factor[1] = out->matcap_factor[2] = 1.0f;
+  out->matcap_texture.index = -1;
+  out->parametric_rim_fresnel_power_factor = 5.0f;
+  out->rim_multiply_texture.index = -1;
+  out->rim_lighting_mix_factor = 1.0f;
+  out->outline_width_multiply_texture.index = -1;
+  out->outline_lighting_mix_factor = 1.0f;
+  out->uv_animation_mask_texture.index = -1;
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "specVersion") == 0)
+    {
+      ++i;
+      out->spec_version = cgltf_vrm_string_to_spec_version(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->spec_version, cgltf_vrm_spec_version_max_enum, "VRMC_materials_mtoon.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "transparentWithZWrite") == 0)
+    {
+      ++i;
+      out->transparent_with_z_write = cgltf_json_to_bool(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "renderQueueOffsetNumber") == 0)
+    {
+      ++i;
+      out->render_queue_offset_number = cgltf_json_to_int(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shadeColorFactor") == 0)
+    {
+      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->shade_color_factor, 3);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shadingShiftFactor") == 0)
+    {
+      ++i;
+      out->shading_shift_factor = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shadingToonyFactor") == 0)
+    {
+      ++i;
+      out->shading_toony_factor = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shadeMultiplyTexture") == 0)
+    {
+      i = cgltf_vrm_parse_json_mtoon_texture_info(ctx, tokens, i + 1, json_chunk, &out->shade_multiply_texture);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shadingShiftTexture") == 0)
+    {
+      i = cgltf_vrm_parse_json_mtoon_shading_shift_texture_info(ctx, tokens, i + 1, json_chunk, &out->shading_shift_texture);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "giEqualizationFactor") == 0)
+    {
+      ++i;
+      out->gi_equalization_factor = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "matcapFactor") == 0)
+    {
+      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->matcap_factor, 3);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "matcapTexture") == 0)
+    {
+      i = cgltf_vrm_parse_json_mtoon_texture_info(ctx, tokens, i + 1, json_chunk, &out->matcap_texture);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "parametricRimColorFactor") == 0)
+    {
+      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->parametric_rim_color_factor, 3);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "parametricRimFresnelPowerFactor") == 0)
+    {
+      ++i;
+      out->parametric_rim_fresnel_power_factor = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "parametricRimLiftFactor") == 0)
+    {
+      ++i;
+      out->parametric_rim_lift_factor = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rimMultiplyTexture") == 0)
+    {
+      i = cgltf_vrm_parse_json_mtoon_texture_info(ctx, tokens, i + 1, json_chunk, &out->rim_multiply_texture);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rimLightingMixFactor") == 0)
+    {
+      ++i;
+      out->rim_lighting_mix_factor = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outlineWidthMode") == 0)
+    {
+      ++i;
+      out->outline_width_mode = cgltf_vrm_string_to_mtoon_outline_width_mode(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->outline_width_mode, cgltf_vrm_mtoon_outline_width_mode_max_enum, "VRMC_materials_mtoon.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outlineWidthFactor") == 0)
+    {
+      ++i;
+      out->outline_width_factor = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outlineWidthMultiplyTexture") == 0)
+    {
+      i = cgltf_vrm_parse_json_mtoon_texture_info(ctx, tokens, i + 1, json_chunk, &out->outline_width_multiply_texture);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outlineColorFactor") == 0)
+    {
+      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->outline_color_factor, 3);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outlineLightingMixFactor") == 0)
+    {
+      ++i;
+      out->outline_lighting_mix_factor = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "uvAnimationMaskTexture") == 0)
+    {
+      i = cgltf_vrm_parse_json_mtoon_texture_info(ctx, tokens, i + 1, json_chunk, &out->uv_animation_mask_texture);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "uvAnimationScrollXSpeedFactor") == 0)
+    {
+      ++i;
+      out->uv_animation_scroll_x_speed_factor = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "uvAnimationScrollYSpeedFactor") == 0)
+    {
+      ++i;
+      out->uv_animation_scroll_y_speed_factor = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "uvAnimationRotationSpeedFactor") == 0)
+    {
+      ++i;
+      out->uv_animation_rotation_speed_factor = cgltf_json_to_float(tokens + i, json_chunk);
+      ++i;
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_materials_mtoon.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+/* ----------- VRMC_vrm_animation ----------- */
+
+static
+int cgltf_vrm_parse_json_animation_expressions_dict(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_animation_expression** out, cgltf_size* out_count)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  ctx->expressions_count += tokens[i].size;
+  if (cgltf_vrm_over_budget(ctx->vrm_options->budget.max_expressions, ctx->expressions_count))
+  {
+    return CGLTF_VRM_ERROR_BUDGET;
+  }
+
+  *out = (cgltf_vrm_animation_expression*)cgltf_calloc(ctx->options, sizeof(cgltf_vrm_animation_expression), tokens[i].size);
+  if (!*out)
+  {
+    return CGLTF_ERROR_NOMEM;
+  }
+  *out_count = tokens[i].size;
+  ++i;
+
+  for (cgltf_size j = 0; j < *out_count; ++j)
+  {
+    cgltf_vrm_animation_expression* expression = &(*out)[j];
+
+    CGLTF_CHECK_KEY(tokens[i]);
+    i = cgltf_vrm_parse_json_name(ctx, tokens, i, json_chunk, &expression->name);
+    if (i < 0)
+    {
+      return i;
+    }
+
+    CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+    int size = tokens[i].size;
+    ++i;
+
+    for (int k = 0; k < size; ++k)
+    {
+      CGLTF_CHECK_KEY(tokens[i]);
+
+      if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0)
+      {
+        ++i;
+        expression->node = CGLTF_PTRINDEX(cgltf_node, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(nodes_count), "VRMC_vrm_animation.expressions."));
+        ++i;
+      }
+      else
+      {
+        CGLTF_VRM_LOG_SKIPPED("VRMC_vrm_animation.expressions.")
+      }
+
+      if (i < 0)
+      {
+        return i;
+      }
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_animation_expressions(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_animation* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "preset") == 0)
+    {
+      i = cgltf_vrm_parse_json_animation_expressions_dict(ctx, tokens, i + 1, json_chunk, &out->preset_expressions, &out->preset_expressions_count);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "custom") == 0)
+    {
+      i = cgltf_vrm_parse_json_animation_expressions_dict(ctx, tokens, i + 1, json_chunk, &out->custom_expressions, &out->custom_expressions_count);
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm_animation.expressions.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_animation_look_at(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_animation* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0)
+    {
+      ++i;
+      out->look_at_node = CGLTF_PTRINDEX(cgltf_node, cgltf_vrm_parse_json_index(ctx, tokens, i, json_chunk, CGLTF_VRM_GLTF_COUNT(nodes_count), "VRMC_vrm_animation.lookAt."));
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "offsetFromHeadBone") == 0)
+    {
+      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->look_at_offset_from_head_bone, 3);
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm_animation.lookAt.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_parse_json_animation(cgltf_vrm_parse_context* ctx, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_animation* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "specVersion") == 0)
+    {
+      ++i;
+      out->spec_version = cgltf_vrm_string_to_spec_version(tokens + i, json_chunk);
+      CGLTF_VRM_CHECK_ENUM(out->spec_version, cgltf_vrm_spec_version_max_enum, "VRMC_vrm_animation.")
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "humanoid") == 0)
+    {
+      CGLTF_VRM_PROFILE_BEGIN(ctx->vrm_options->profiler, zone, "VRMC_vrm_animation.humanoid");
+      i = cgltf_vrm_parse_json_humanoid(ctx, tokens, i + 1, json_chunk, &out->humanoid);
+      CGLTF_VRM_PROFILE_END(ctx->vrm_options->profiler, zone);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "expressions") == 0)
+    {
+      CGLTF_VRM_PROFILE_BEGIN(ctx->vrm_options->profiler, zone, "VRMC_vrm_animation.expressions");
+      i = cgltf_vrm_parse_json_animation_expressions(ctx, tokens, i + 1, json_chunk, out);
+      CGLTF_VRM_PROFILE_END(ctx->vrm_options->profiler, zone);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "lookAt") == 0)
+    {
+      i = cgltf_vrm_parse_json_animation_look_at(ctx, tokens, i + 1, json_chunk, out);
+      out->has_look_at = 1;
+    }
+    else
+    {
+      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm_animation.")
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static
+int cgltf_vrm_fixup_pointers(cgltf_data const* gltf, cgltf_vrm_data* vrm)
+{
+  cgltf_vrm_core *vrmc = &vrm->core;
+
+  /* VRMC_vrm.humanoid */
+  for (cgltf_size i = 0; i < vrmc->humanoid.human_bones_count; ++i)
+  {
+    CGLTF_PTRFIXUP(vrmc->humanoid.human_bones[i].node, gltf->nodes, gltf->nodes_count);
+  }
+
+  /* VRMC_vrm.meta */
+  if (vrmc->meta.has_thumbnail_image)
+  {
+    CGLTF_PTRFIXUP(vrmc->meta.thumbnail_image, gltf->images, gltf->images_count);
+  }
+
+  /* VRMC_vrm.firstPerson */
+  for (cgltf_size i = 0; i < vrmc->first_person.mesh_annotations_count; ++i)
+  {
+    cgltf_vrm_first_person_mesh_annotation *mesh_annotation = &vrmc->first_person.mesh_annotations[i];
+    CGLTF_PTRFIXUP(mesh_annotation->node, gltf->nodes, gltf->nodes_count);
+  }
+
+  /* VRMC_vrm.expressions */
+  for (cgltf_size i = 0; i < vrmc->expressions.preset_count + vrmc->expressions.custom_count; ++i)
+  {
+    cgltf_vrm_expression *expression = (i < vrmc->expressions.preset_count)
+      ? &vrmc->expressions.preset[i] : &vrmc->expressions.custom[i - vrmc->expressions.preset_count];
+
+    for (cgltf_size j = 0; j < expression->morph_target_binds_count; ++j)
+    {
+      CGLTF_PTRFIXUP(expression->morph_target_binds[j].node, gltf->nodes, gltf->nodes_count);
+    }
+    for (cgltf_size j = 0; j < expression->material_color_binds_count; ++j)
+    {
+      CGLTF_PTRFIXUP(expression->material_color_binds[j].material, gltf->materials, gltf->materials_count);
+    }
+    for (cgltf_size j = 0; j < expression->texture_transform_binds_count; ++j)
+    {
+      CGLTF_PTRFIXUP(expression->texture_transform_binds[j].material, gltf->materials, gltf->materials_count);
+    }
+  }
+
+  if (vrm->has_spring_bone)
+  {
+    cgltf_vrm_spring_bone *sb = &vrm->spring_bone;
+
+    /* VRMC_springBone.colliders */
+    for (cgltf_size i = 0; i < sb->colliders_count; ++i)
+    {
+      CGLTF_PTRFIXUP(sb->colliders[i].node, gltf->nodes, gltf->nodes_count);
+    }
+
+    /* VRMC_springBone.springs */
+    for (cgltf_size i = 0; i < sb->springs_count; ++i)
+    {
+      CGLTF_PTRFIXUP(sb->springs[i].center, gltf->nodes, gltf->nodes_count);
+
+      for (cgltf_size j = 0; j < sb->springs[i].joints_count; ++j)
+      {
+        CGLTF_PTRFIXUP(sb->springs[i].joints[j].node, gltf->nodes, gltf->nodes_count);
+      }
+    }
+  }
+
+  /* VRMC_node_constraint */
+  for (cgltf_size i = 0; i < vrm->extended_nodes_count; ++i)
+  {
+    cgltf_vrm_extended_node* node = &vrm->extended_nodes[i];
+
+    if (node->has_node_constraint)
+    {
+      CGLTF_PTRFIXUP(node->node_constraint.source, gltf->nodes, gltf->nodes_count);
+    }
+  }
+
+  /* VRMC_vrm_animation */
+  if (vrm->has_animation)
+  {
+    cgltf_vrm_animation *animation = &vrm->animation;
+
+    for (cgltf_size i = 0; i < animation->humanoid.human_bones_count; ++i)
+    {
+      CGLTF_PTRFIXUP(animation->humanoid.human_bones[i].node, gltf->nodes, gltf->nodes_count);
+    }
+    for (cgltf_size i = 0; i < animation->preset_expressions_count; ++i)
+    {
+      CGLTF_PTRFIXUP(animation->preset_expressions[i].node, gltf->nodes, gltf->nodes_count);
+    }
+    for (cgltf_size i = 0; i < animation->custom_expressions_count; ++i)
+    {
+      CGLTF_PTRFIXUP(animation->custom_expressions[i].node, gltf->nodes, gltf->nodes_count);
+    }
+    CGLTF_PTRFIXUP(animation->look_at_node, gltf->nodes, gltf->nodes_count);
+  }
+
+  return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+#define CGLTF_VRM_FREE(vrm, data) if (data) (vrm)->memory.free_func((vrm)->memory.user_data, data)
+
+/* Names are owned by the string pool when there is one. */
+#define CGLTF_VRM_FREE_NAME(vrm, name) if ((vrm)->string_pool == NULL) { CGLTF_VRM_FREE(vrm, name); }
+
+static
+void cgltf_vrm_free_meta(cgltf_memory_options const* memory, cgltf_vrm_meta *meta)
+{
+  void* strings[5] = { meta->name, meta->version, meta->license_url, meta->copyright_information, meta->contact_information };
+
+  for (cgltf_size i = 0; i < 5; ++i)
+  {
+    if (strings[i]) memory->free_func(memory->user_data, strings[i]);
+  }
+  for (cgltf_size i = 0; i < meta->authors_count; ++i)
+  {
+    if (meta->authors[i]) memory->free_func(memory->user_data, meta->authors[i]);
+  }
+  if (meta->authors) memory->free_func(memory->user_data, meta->authors);
+}
+
+static
+void cgltf_vrm_free_expressions(cgltf_vrm_data *vrm, cgltf_vrm_expression *expressions, cgltf_size count)
+{
+  for (cgltf_size i = 0; i < count; ++i)
+  {
+    cgltf_vrm_expression *expression = &expressions[i];
+    CGLTF_VRM_FREE_NAME(vrm, expression->name);
+    CGLTF_VRM_FREE(vrm, expression->morph_target_binds);
+    CGLTF_VRM_FREE(vrm, expression->material_color_binds);
+    CGLTF_VRM_FREE(vrm, expression->texture_transform_binds);
+  }
+  CGLTF_VRM_FREE(vrm, expressions);
+}
+
+void cgltf_vrm_free(cgltf_vrm_data *vrm)
+{
+  if (!vrm)
+  {
+    return;
+  }
+
+  cgltf_vrm_core *vrmc = &vrm->core;
+
+  for (cgltf_size i = 0; i < vrmc->humanoid.human_bones_count; ++i)
+  {
+    CGLTF_VRM_FREE_NAME(vrm, vrmc->humanoid.human_bones[i].name);
+  }
+  CGLTF_VRM_FREE(vrm, vrmc->humanoid.human_bones);
+
+  cgltf_vrm_free_meta(&vrm->memory, &vrmc->meta);
+
+  CGLTF_VRM_FREE(vrm, vrmc->first_person.mesh_annotations);
+
+  cgltf_vrm_free_expressions(vrm, vrmc->expressions.preset, vrmc->expressions.preset_count);
+  cgltf_vrm_free_expressions(vrm, vrmc->expressions.custom, vrmc->expressions.custom_count);
+
+  if (vrm->has_spring_bone)
+  {
+    cgltf_vrm_spring_bone *sb = &vrm->spring_bone;
+
+    CGLTF_VRM_FREE(vrm, sb->colliders);
+
+    for (cgltf_size i = 0; i < sb->collider_groups_count; ++i)
+    {
+      CGLTF_VRM_FREE_NAME(vrm, sb->collider_groups[i].name);
+      CGLTF_VRM_FREE(vrm, sb->collider_groups[i].colliders);
+    }
+    CGLTF_VRM_FREE(vrm, sb->collider_groups);
+
+    for (cgltf_size i = 0; i < sb->springs_count; ++i)
+    {
+      CGLTF_VRM_FREE_NAME(vrm, sb->springs[i].name);
+      CGLTF_VRM_FREE(vrm, sb->springs[i].joints);
+      CGLTF_VRM_FREE(vrm, sb->springs[i].collider_groups);
+    }
+    CGLTF_VRM_FREE(vrm, sb->springs);
+  }
+
+  CGLTF_VRM_FREE(vrm, vrm->extended_nodes);
+  CGLTF_VRM_FREE(vrm, vrm->extended_materials);
+
+  if (vrm->has_animation)
+  {
+    cgltf_vrm_animation *animation = &vrm->animation;
+
+    for (cgltf_size i = 0; i < animation->humanoid.human_bones_count; ++i)
+    {
+      CGLTF_VRM_FREE_NAME(vrm, animation->humanoid.human_bones[i].name);
+    }
+    CGLTF_VRM_FREE(vrm, animation->humanoid.human_bones);
+
+    for (cgltf_size i = 0; i < animation->preset_expressions_count; ++i)
+    {
+      CGLTF_VRM_FREE_NAME(vrm, animation->preset_expressions[i].name);
+    }
+    CGLTF_VRM_FREE(vrm, animation->preset_expressions);
+
+    for (cgltf_size i = 0; i < animation->custom_expressions_count; ++i)
+    {
+      CGLTF_VRM_FREE_NAME(vrm, animation->custom_expressions[i].name);
+    }
+    CGLTF_VRM_FREE(vrm, animation->custom_expressions);
+  }
+}
+
+#undef CGLTF_VRM_FREE_NAME
+#undef CGLTF_VRM_FREE
+
+/* ----------- Memory accounting ----------- */
+
+static
+void cgltf_vrm_memory_add(cgltf_vrm_memory_usage* usage, void const* block, cgltf_size bytes)
+{
+  if (block != NULL)
+  {
+    usage->bytes += bytes;
+    usage->allocations += 1;
+  }
+}
+
+static
+void cgltf_vrm_memory_add_string(cgltf_vrm_memory_usage* usage, char const* str)
+{
+  if (str != NULL)
+  {
+    cgltf_vrm_memory_add(usage, str, strlen(str) + 1);
+  }
+}
+
+static
+void cgltf_vrm_memory_add_name(cgltf_vrm_data const* vrm, cgltf_vrm_memory_usage* usage, char const* name)
+{
+  if (vrm->string_pool == NULL)
+  {
+    cgltf_vrm_memory_add_string(usage, name);
+  }
+}
+
+static
+void cgltf_vrm_memory_add_expressions(cgltf_vrm_data const* vrm, cgltf_vrm_memory_usage* usage, cgltf_vrm_expression const* expressions, cgltf_size count)
+{
+  for (cgltf_size i = 0; i < count; ++i)
+  {
+    cgltf_vrm_expression const* expression = &expressions[i];
+    cgltf_vrm_memory_add_name(vrm, usage, expression->name);
+    cgltf_vrm_memory_add(usage, expression->morph_target_binds, sizeof(cgltf_vrm_expression_morph_target_bind) * expression->morph_target_binds_count);
+    cgltf_vrm_memory_add(usage, expression->material_color_binds, sizeof(cgltf_vrm_expression_material_color_bind) * expression->material_color_binds_count);
+    cgltf_vrm_memory_add(usage, expression->texture_transform_binds, sizeof(cgltf_vrm_expression_texture_transform_bind) * expression->texture_transform_binds_count);
+  }
+  cgltf_vrm_memory_add(usage, expressions, sizeof(cgltf_vrm_expression) * count);
+}
+
+void cgltf_vrm_memory_stats(cgltf_vrm_data const* vrm, cgltf_vrm_memory_report* out)
+{
+  memset(out, 0, sizeof(cgltf_vrm_memory_report));
+
+  if (!vrm)
+  {
+    return;
+  }
+
+  cgltf_vrm_core const* vrmc = &vrm->core;
+
+  for (cgltf_size i = 0; i < vrmc->humanoid.human_bones_count; ++i)
+  {
+    cgltf_vrm_memory_add_name(vrm, &out->humanoid, vrmc->humanoid.human_bones[i].name);
+  }
+  cgltf_vrm_memory_add(&out->humanoid, vrmc->humanoid.human_bones, sizeof(cgltf_vrm_humanoid_bone) * vrmc->humanoid.human_bones_count);
+
+  cgltf_vrm_memory_add_string(&out->meta, vrmc->meta.name);
+  cgltf_vrm_memory_add_string(&out->meta, vrmc->meta.version);
+  cgltf_vrm_memory_add_string(&out->meta, vrmc->meta.license_url);
+  cgltf_vrm_memory_add_string(&out->meta, vrmc->meta.copyright_information);
+  cgltf_vrm_memory_add_string(&out->meta, vrmc->meta.contact_information);
+  for (cgltf_size i = 0; i < vrmc->meta.authors_count; ++i)
+  {
+    cgltf_vrm_memory_add_string(&out->meta, vrmc->meta.authors[i]);
+  }
+  cgltf_vrm_memory_add(&out->meta, vrmc->meta.authors, sizeof(char*) * vrmc->meta.authors_count);
+
+  cgltf_vrm_memory_add(&out->first_person, vrmc->first_person.mesh_annotations, sizeof(cgltf_vrm_first_person_mesh_annotation) * vrmc->first_person.mesh_annotations_count);
+
+  cgltf_vrm_memory_add_expressions(vrm, &out->expressions, vrmc->expressions.preset, vrmc->expressions.preset_count);
+  cgltf_vrm_memory_add_expressions(vrm, &out->expressions, vrmc->expressions.custom, vrmc->expressions.custom_count);
+
+  if (vrm->has_spring_bone)
+  {
+    cgltf_vrm_spring_bone const* sb = &vrm->spring_bone;
+
+    cgltf_vrm_memory_add(&out->spring_bone, sb->colliders, sizeof(cgltf_vrm_spring_bone_collider) * sb->colliders_count);
+
+    for (cgltf_size i = 0; i < sb->collider_groups_count; ++i)
+    {
+      cgltf_vrm_memory_add_name(vrm, &out->spring_bone, sb->collider_groups[i].name);
+      cgltf_vrm_memory_add(&out->spring_bone, sb->collider_groups[i].colliders, sizeof(cgltf_int) * sb->collider_groups[i].colliders_count);
+    }
+    cgltf_vrm_memory_add(&out->spring_bone, sb->collider_groups, sizeof(cgltf_vrm_spring_bone_collider_group) * sb->collider_groups_count);
+
+    for (cgltf_size i = 0; i < sb->springs_count; ++i)
+    {
+      cgltf_vrm_memory_add_name(vrm, &out->spring_bone, sb->springs[i].name);
+      cgltf_vrm_memory_add(&out->spring_bone, sb->springs[i].joints, sizeof(cgltf_vrm_spring_bone_spring_joint) * sb->springs[i].joints_count);
+      cgltf_vrm_memory_add(&out->spring_bone, sb->springs[i].collider_groups, sizeof(cgltf_int) * sb->springs[i].collider_groups_count);
+    }
+    cgltf_vrm_memory_add(&out->spring_bone, sb->springs, sizeof(cgltf_vrm_spring_bone_spring) * sb->springs_count);
+  }
+
+  cgltf_vrm_memory_add(&out->extended_nodes, vrm->extended_nodes, sizeof(cgltf_vrm_extended_node) * vrm->extended_nodes_count);
+  cgltf_vrm_memory_add(&out->extended_materials, vrm->extended_materials, sizeof(cgltf_vrm_extended_material) * vrm->extended_materials_count);
+
+  if (vrm->has_animation)
+  {
+    cgltf_vrm_animation const* animation = &vrm->animation;
+
+    for (cgltf_size i = 0; i < animation->humanoid.human_bones_count; ++i)
+    {
+      cgltf_vrm_memory_add_name(vrm, &out->animation, animation->humanoid.human_bones[i].name);
+    }
+    cgltf_vrm_memory_add(&out->animation, animation->humanoid.human_bones, sizeof(cgltf_vrm_humanoid_bone) * animation->humanoid.human_bones_count);
+
+    for (cgltf_size i = 0; i < animation->preset_expressions_count; ++i)
+    {
+      cgltf_vrm_memory_add_name(vrm, &out->animation, animation->preset_expressions[i].name);
+    }
+    cgltf_vrm_memory_add(&out->animation, animation->preset_expressions, sizeof(cgltf_vrm_animation_expression) * animation->preset_expressions_count);
+
+    for (cgltf_size i = 0; i < animation->custom_expressions_count; ++i)
+    {
+      cgltf_vrm_memory_add_name(vrm, &out->animation, animation->custom_expressions[i].name);
+    }
+    cgltf_vrm_memory_add(&out->animation, animation->custom_expressions, sizeof(cgltf_vrm_animation_expression) * animation->custom_expressions_count);
+  }
+
+  cgltf_vrm_memory_usage const* subsystems[8] = {
+    &out->humanoid, &out->meta, &out->first_person, &out->expressions,
+    &out->spring_bone, &out->extended_nodes, &out->extended_materials, &out->animation
+  };
+  for (cgltf_size i = 0; i < 8; ++i)
+  {
+    out->total.bytes += subsystems[i]->bytes;
+    out->total.allocations += subsystems[i]->allocations;
+  }
+
+  out->parse_tokens.bytes = vrm->parse_token_peak_bytes;
+  out->parse_tokens.allocations = vrm->parse_token_allocations;
+}
+
+cgltf_result cgltf_vrm_parse_init(cgltf_options *options, char* json_chunk, jsmntok_t** tokens)
+{
+  const size_t size = strlen(json_chunk);
+
+  jsmn_parser parser = { 0, 0, 0 };
+
+  if (options->json_token_count == 0)
+  {
+    int token_count = jsmn_parse(&parser, (const char*)json_chunk, size, NULL, 0);
+    if (token_count <= 0)
+    {
+      return cgltf_result_invalid_json;
+    }
+
+    options->json_token_count = token_count;
+  }
+
+  *tokens = (jsmntok_t*)options->memory.alloc_func(options->memory.user_data, sizeof(jsmntok_t) * (options->json_token_count + 1));
+  if (!*tokens)
+  {
+    return cgltf_result_out_of_memory;
+  }
+
+  jsmn_init(&parser);
+
+  int token_count = jsmn_parse(&parser, (const char*)json_chunk, size, *tokens, options->json_token_count);
+  if (token_count <= 0)
+  {
+    options->memory.free_func(options->memory.user_data, *tokens);
+    *tokens = NULL;
+    return cgltf_result_invalid_json;
+  }
+  (*tokens)[token_count].type = JSMN_UNDEFINED;
+
+  return cgltf_result_success;
+}
+
+/* ----------- Staged loading ----------- */
+
+static
+cgltf_bool cgltf_vrm_is_root_extension(char const* name)
+{
+  return (strcmp(name, "VRMC_vrm") == 0) || (strcmp(name, "VRM") == 0)
+      || (strcmp(name, "VRMC_springBone") == 0) || (strcmp(name, "springBone") == 0)
+      || (strcmp(name, "VRMC_vrm_animation") == 0);
+}
+
+static
+cgltf_result cgltf_vrm_result_from_error(int error)
+{
+  if (error == CGLTF_VRM_ERROR_BUDGET)
+  {
+    return cgltf_vrm_result_budget_exceeded;
+  }
+  return (error == CGLTF_ERROR_NOMEM) ? cgltf_result_out_of_memory : cgltf_result_invalid_json;
+}
+
+static
+cgltf_bool cgltf_vrm_loader_cancelled(cgltf_vrm_loader const* loader)
+{
+  return (loader->vrm_options.cancel != NULL) && (*loader->vrm_options.cancel != 0);
+}
+
+static
+cgltf_result cgltf_vrm_loader_tokenize(cgltf_vrm_loader* loader, char* json_chunk, jsmntok_t** tokens, cgltf_size* bytes)
+{
+  /* cgltf_vrm_parse_init caches the token count in the options, keep it local to this chunk. */
+  cgltf_options chunk_options = loader->options;
+
+  if (loader->vrm_options.budget.max_tokens > 0)
+  {
+    if (chunk_options.json_token_count == 0)
+    {
+      jsmn_parser parser = { 0, 0, 0 };
+      int token_count = jsmn_parse(&parser, json_chunk, strlen(json_chunk), NULL, 0);
+      if (token_count <= 0)
+      {
+        return cgltf_result_invalid_json;
+      }
+      chunk_options.json_token_count = token_count;
+    }
+    if (chunk_options.json_token_count > loader->vrm_options.budget.max_tokens)
+    {
+      return cgltf_vrm_result_budget_exceeded;
+    }
+  }
+
+  CGLTF_VRM_PROFILE_BEGIN(loader->vrm_options.profiler, zone, "cgltf_vrm_parse_init");
+  cgltf_result result = cgltf_vrm_parse_init(&chunk_options, json_chunk, tokens);
+  CGLTF_VRM_PROFILE_END(loader->vrm_options.profiler, zone);
+
+  if (result == cgltf_result_success)
+  {
+    *bytes = sizeof(jsmntok_t) * (chunk_options.json_token_count + 1);
+    loader->token_bytes += *bytes;
+    loader->vrm->parse_token_allocations += 1;
+    if (loader->token_bytes > loader->vrm->parse_token_peak_bytes)
+    {
+      loader->vrm->parse_token_peak_bytes = loader->token_bytes;
+    }
+  }
+  return result;
+}
+
+static
+void cgltf_vrm_loader_free_tokens(cgltf_vrm_loader* loader, jsmntok_t* tokens, cgltf_size bytes)
+{
+  loader->options.memory.free_func(loader->options.memory.user_data, tokens);
+  loader->token_bytes -= bytes;
+}
+
+static
+cgltf_size cgltf_vrm_budget_slot(void const* ptr, cgltf_size capacity)
+{
+  cgltf_size hash = (cgltf_size)(uintptr_t)ptr;
+  hash = (hash ^ (hash >> 16)) * 0x45d9f3bu;
+  hash ^= hash >> 16;
+  return hash & (capacity - 1);
+}
+
+static
+void cgltf_vrm_budget_insert(cgltf_vrm_loader* loader, void* ptr, cgltf_size size)
+{
+  cgltf_size mask = loader->budget_blocks_capacity - 1;
+  cgltf_size slot = cgltf_vrm_budget_slot(ptr, loader->budget_blocks_capacity);
+
+  while (loader->budget_blocks[slot] != NULL && loader->budget_blocks[slot] != ptr)
+  {
+    slot = (slot + 1) & mask;
+  }
+  if (loader->budget_blocks[slot] == NULL)
+  {
+    loader->budget_blocks_count += 1;
+  }
+  loader->budget_blocks[slot] = ptr;
+  loader->budget_block_sizes[slot] = size;
+}
+
+static
+cgltf_bool cgltf_vrm_budget_reserve(cgltf_vrm_loader* loader)
+{
+  if ((loader->budget_blocks_count + 1) * 4 <= loader->budget_blocks_capacity * 3)
+  {
+    return true;
+  }
+
+  cgltf_size capacity = (loader->budget_blocks_capacity > 0) ? loader->budget_blocks_capacity * 2 : 64;
+  void** blocks = (void**)loader->memory.alloc_func(loader->memory.user_data, sizeof(void*) * capacity);
+  cgltf_size* sizes = (cgltf_size*)loader->memory.alloc_func(loader->memory.user_data, sizeof(cgltf_size) * capacity);
+  if (!blocks || !sizes)
+  {
+    if (blocks)
+    {
+      loader->memory.free_func(loader->memory.user_data, blocks);
+    }
+    if (sizes)
+    {
+      loader->memory.free_func(loader->memory.user_data, sizes);
+    }
+    return false;
+  }
+  memset(blocks, 0, sizeof(void*) * capacity);
+
+  void** old_blocks = loader->budget_blocks;
+  cgltf_size* old_sizes = loader->budget_block_sizes;
+  cgltf_size old_capacity = loader->budget_blocks_capacity;
+
+  loader->budget_blocks = blocks;
+  loader->budget_block_sizes = sizes;
+  loader->budget_blocks_capacity = capacity;
+  loader->budget_blocks_count = 0;
+
+  for (cgltf_size i = 0; i < old_capacity; ++i)
+  {
+    if (old_blocks[i] != NULL)
+    {
+      cgltf_vrm_budget_insert(loader, old_blocks[i], old_sizes[i]);
+    }
+  }
+
+  if (old_blocks)
+  {
+    loader->memory.free_func(loader->memory.user_data, old_blocks);
+    loader->memory.free_func(loader->memory.user_data, old_sizes);
+  }
+  return true;
+}
+
+/* Forgets `ptr` and returns its size, 0 for a block the table does not know. */
+static
+cgltf_size cgltf_vrm_budget_remove(cgltf_vrm_loader* loader, void const* ptr)
+{
+  if (ptr == NULL || loader->budget_blocks_capacity == 0)
+  {
+    return 0;
+  }
+
+  cgltf_size mask = loader->budget_blocks_capacity - 1;
+  cgltf_size slot = cgltf_vrm_budget_slot(ptr, loader->budget_blocks_capacity);
+
+  while (loader->budget_blocks[slot] != ptr)
+  {
+    if (loader->budget_blocks[slot] == NULL)
+    {
+      return 0;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  cgltf_size size = loader->budget_block_sizes[slot];
+  loader->budget_blocks_count -= 1;
+
+  /* Backward shift deletion, moves up the entries whose probe went through the freed slot. */
+  cgltf_size hole = slot;
+  for (cgltf_size next = (hole + 1) & mask; loader->budget_blocks[next] != NULL; next = (next + 1) & mask)
+  {
+    cgltf_size home = cgltf_vrm_budget_slot(loader->budget_blocks[next], loader->budget_blocks_capacity);
+    if (((next - home) & mask) >= ((next - hole) & mask))
+    {
+      loader->budget_blocks[hole] = loader->budget_blocks[next];
+      loader->budget_block_sizes[hole] = loader->budget_block_sizes[next];
+      hole = next;
+    }
+  }
+  loader->budget_blocks[hole] = NULL;
+
+  return size;
+}
+
+/* Allocator of a load with a byte budget, every block gives its bytes back when released. */
+static
+void* cgltf_vrm_budget_alloc(void* user, cgltf_size size)
+{
+  cgltf_vrm_loader* loader = (cgltf_vrm_loader*)user;
+
+  if (cgltf_vrm_over_budget(loader->vrm_options.budget.max_bytes, loader->budget_bytes + size))
+  {
+    loader->budget_exceeded = true;
+    return NULL;
+  }
+
+  if (!cgltf_vrm_budget_reserve(loader))
+  {
+    return NULL;
+  }
+
+  void* ptr = loader->memory.alloc_func(loader->memory.user_data, size);
+  if (ptr != NULL)
+  {
+    cgltf_vrm_budget_insert(loader, ptr, size);
+    loader->budget_bytes += size;
+  }
+  return ptr;
+}
+
+static
+void cgltf_vrm_budget_free(void* user, void* ptr)
+{
+  cgltf_vrm_loader* loader = (cgltf_vrm_loader*)user;
+  loader->budget_bytes -= cgltf_vrm_budget_remove(loader, ptr);
+  loader->memory.free_func(loader->memory.user_data, ptr);
+}
+
+static
+void cgltf_vrm_loader_release_tokens(cgltf_vrm_loader* loader)
+{
+  if (loader->root_tokens == NULL)
+  {
+    return;
+  }
+
+  for (cgltf_size i = 0; i < loader->gltf->data_extensions_count; ++i)
+  {
+    if (loader->root_tokens[i] != NULL)
+    {
+      cgltf_vrm_loader_free_tokens(loader, (jsmntok_t*)loader->root_tokens[i], loader->root_token_bytes[i]);
+      loader->root_tokens[i] = NULL;
+    }
+  }
+}
+
+static
+cgltf_vrm_load_status cgltf_vrm_loader_abort(cgltf_vrm_loader* loader, cgltf_vrm_load_status status, cgltf_result result)
+{
+  cgltf_memory_options memory = loader->vrm->memory;
+  cgltf_vrm_string_pool* string_pool = loader->vrm->string_pool;
+
+  cgltf_vrm_loader_release_tokens(loader);
+
+  /* Give the partial results back through the budget so it keeps track of the blocks still alive. */
+  loader->vrm->memory = loader->options.memory;
+  cgltf_vrm_free(loader->vrm);
+
+  memset(loader->vrm, 0, sizeof(cgltf_vrm_data));
+  loader->vrm->memory = memory;
+  loader->vrm->string_pool = string_pool;
+
+  loader->status = status;
+  loader->result = result;
+  return status;
+}
+
+static
+cgltf_result cgltf_vrm_loader_step_tokenize(cgltf_vrm_loader* loader, cgltf_size budget)
+{
+  cgltf_data const* gltf = loader->gltf;
+
+  for (; (budget > 0) && (loader->cursor < gltf->data_extensions_count); --budget, ++loader->cursor)
+  {
+    cgltf_extension* ext = &gltf->data_extensions[loader->cursor];
+
+    if (cgltf_vrm_is_root_extension(ext->name))
+    {
+      cgltf_result result = cgltf_vrm_loader_tokenize(loader, ext->data, (jsmntok_t**)&loader->root_tokens[loader->cursor], &loader->root_token_bytes[loader->cursor]);
+      if (result != cgltf_result_success)
+      {
+        return result;
+      }
+    }
+  }
+
+  return cgltf_result_success;
+}
+
+static
+cgltf_result cgltf_vrm_loader_step_root_extensions(cgltf_vrm_loader* loader, cgltf_size budget)
+{
+  cgltf_data const* gltf = loader->gltf;
+  cgltf_vrm_data* vrm = loader->vrm;
+
+  for (; (budget > 0) && (loader->cursor < gltf->data_extensions_count); --budget, ++loader->cursor)
+  {
+    cgltf_extension* ext = &gltf->data_extensions[loader->cursor];
+    jsmntok_t* tokens = (jsmntok_t*)loader->root_tokens[loader->cursor];
+    uint8_t const* json_chunk = (uint8_t const*)ext->data;
+    cgltf_vrm_parse_context ctx = { &loader->options, vrm->string_pool, &loader->vrm_options, gltf, loader->diagnostics_count, -1, 0 };
+    int i = 0;
+
+    if (tokens == NULL)
+    {
+      continue;
+    }
+
+    if ((strcmp(ext->name, "VRMC_vrm") == 0) || (strcmp(ext->name, "VRM") == 0))
+    {
+      CGLTF_VRM_PROFILE_BEGIN(ctx.vrm_options->profiler, zone, "VRMC_vrm");
+      i = cgltf_vrm_parse_json_vrm(&ctx, tokens, 0, json_chunk, &vrm->core);
+      CGLTF_VRM_PROFILE_END(ctx.vrm_options->profiler, zone);
+    }
+    else if ((strcmp(ext->name, "VRMC_springBone") == 0) || (strcmp(ext->name, "springBone") == 0))
+    {
+      CGLTF_VRM_PROFILE_BEGIN(ctx.vrm_options->profiler, zone, "VRMC_springBone");
+      i = cgltf_vrm_parse_json_spring_bone(&ctx, tokens, 0, json_chunk, &vrm->spring_bone);
+      CGLTF_VRM_PROFILE_END(ctx.vrm_options->profiler, zone);
+      vrm->has_spring_bone = true;
+    }
+    else if (strcmp(ext->name, "VRMC_vrm_animation") == 0)
+    {
+      CGLTF_VRM_PROFILE_BEGIN(ctx.vrm_options->profiler, zone, "VRMC_vrm_animation");
+      i = cgltf_vrm_parse_json_animation(&ctx, tokens, 0, json_chunk, &vrm->animation);
+      CGLTF_VRM_PROFILE_END(ctx.vrm_options->profiler, zone);
+      vrm->has_animation = true;
+    }
+
+    cgltf_vrm_loader_free_tokens(loader, tokens, loader->root_token_bytes[loader->cursor]);
+    loader->root_tokens[loader->cursor] = NULL;
+
+    if (i < 0)
+    {
+      return cgltf_vrm_result_from_error(i);
+    }
+  }
+
+  return cgltf_result_success;
+}
+
+static
+cgltf_result cgltf_vrm_loader_step_node_constraints(cgltf_vrm_loader* loader, cgltf_size budget)
+{
+  cgltf_data const* gltf = loader->gltf;
+  cgltf_vrm_data* vrm = loader->vrm;
+
+  if ((vrm->extended_nodes == NULL) && (gltf->nodes_count > 0))
+  {
+    vrm->extended_nodes = (cgltf_vrm_extended_node*)cgltf_calloc(&loader->options, sizeof(cgltf_vrm_extended_node), gltf->nodes_count);
+    if (!vrm->extended_nodes)
+    {
+      return cgltf_result_out_of_memory;
+    }
+    vrm->extended_nodes_count = gltf->nodes_count;
+  }
+
+  for (; (budget > 0) && (loader->cursor < gltf->nodes_count); --budget, ++loader->cursor)
+  {
+    if (cgltf_vrm_loader_cancelled(loader))
+    {
+      break;
+    }
+
+    cgltf_extension *ext = cgltf_vrm_get_node_extension(&gltf->nodes[loader->cursor], "VRMC_node_constraint");
+    if (ext == NULL)
+    {
+      ext = cgltf_vrm_get_node_extension(&gltf->nodes[loader->cursor], "node_constraint");
+    }
+
+    if (ext != NULL)
+    {
+      cgltf_vrm_extended_node *node = &vrm->extended_nodes[loader->cursor];
+      jsmntok_t* tokens = NULL;
+      cgltf_size token_bytes = 0;
+
+      cgltf_result result = cgltf_vrm_loader_tokenize(loader, ext->data, &tokens, &token_bytes);
+      if (result != cgltf_result_success)
+      {
+        return result;
+      }
+
+      cgltf_vrm_parse_context ctx = { &loader->options, vrm->string_pool, &loader->vrm_options, gltf, loader->diagnostics_count, (cgltf_int)loader->cursor, 0 };
+      int i = cgltf_vrm_parse_json_node_constraint(&ctx, tokens, 0, (uint8_t const*)ext->data, &node->node_constraint);
+      node->has_node_constraint = true;
+
+      cgltf_vrm_loader_free_tokens(loader, tokens, token_bytes);
+
+      if (i < 0)
+      {
+        return cgltf_vrm_result_from_error(i);
+      }
+    }
+  }
+
+  return cgltf_result_success;
+}
+
+static
+cgltf_result cgltf_vrm_loader_step_materials_mtoon(cgltf_vrm_loader* loader, cgltf_size budget)
+{
+  cgltf_data const* gltf = loader->gltf;
+  cgltf_vrm_data* vrm = loader->vrm;
+
+  if ((vrm->extended_materials == NULL) && (gltf->materials_count > 0))
+  {
+    vrm->extended_materials = (cgltf_vrm_extended_material*)cgltf_calloc(&loader->options, sizeof(cgltf_vrm_extended_material), gltf->materials_count);
+    if (!vrm->extended_materials)
+    {
+      return cgltf_result_out_of_memory;
+    }
+    vrm->extended_materials_count = gltf->materials_count;
+  }
+
+  for (; (budget > 0) && (loader->cursor < gltf->materials_count); --budget, ++loader->cursor)
+  {
+    if (cgltf_vrm_loader_cancelled(loader))
+    {
+      break;
+    }
+
+    cgltf_extension *ext = cgltf_vrm_get_material_extension(&gltf->materials[loader->cursor], "VRMC_materials_mtoon");
+    if (ext == NULL)
+    {
+      ext = cgltf_vrm_get_material_extension(&gltf->materials[loader->cursor], "materials_mtoon");
+    }
+
+    if (ext != NULL)
+    {
+      cgltf_vrm_extended_material *mat = &vrm->extended_materials[loader->cursor];
+
+      if (cgltf_vrm_over_budget(loader->vrm_options.budget.max_mtoon_materials, ++loader->mtoon_materials_count))
+      {
+        return cgltf_vrm_result_budget_exceeded;
+      }
+      jsmntok_t* tokens = NULL;
+      cgltf_size token_bytes = 0;
+
+      cgltf_result result = cgltf_vrm_loader_tokenize(loader, ext->data, &tokens, &token_bytes);
+      if (result != cgltf_result_success)
+      {
+        return result;
+      }
+
+      cgltf_vrm_parse_context ctx = { &loader->options, vrm->string_pool, &loader->vrm_options, gltf, loader->diagnostics_count, (cgltf_int)loader->cursor, 0 };
+      int i = cgltf_vrm_parse_json_material_mtoon(&ctx, tokens, 0, (uint8_t const*)ext->data, &mat->mtoon);
+      mat->has_mtoon = true;
+
+      cgltf_vrm_loader_free_tokens(loader, tokens, token_bytes);
+
+      if (i < 0)
+      {
+        return cgltf_vrm_result_from_error(i);
+      }
+    }
+  }
+
+  return cgltf_result_success;
+}
+
+cgltf_result cgltf_vrm_loader_init(cgltf_vrm_loader* loader, cgltf_options const* options, cgltf_vrm_options const* vrm_options, cgltf_data const* gltf, cgltf_vrm_data* vrm)
+{
+  if (loader == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  /* zeroed first so that cgltf_vrm_loader_free is safe whatever the result */
+  memset(loader, 0, sizeof(cgltf_vrm_loader));
+
+  if ((options == NULL) || (gltf == NULL) || (vrm == NULL))
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  loader->options = *options;
+  cgltf_vrm_fix_memory_options(&loader->options);
+
+  if (vrm_options != NULL)
+  {
+    loader->vrm_options = *vrm_options;
+  }
+
+  loader->gltf = gltf;
+  loader->vrm = vrm;
+  loader->stage = cgltf_vrm_load_stage_tokenize;
+  loader->status = cgltf_vrm_load_status_in_progress;
+  loader->result = cgltf_result_success;
+
+  memset(vrm, 0, sizeof(cgltf_vrm_data));
+  vrm->memory = loader->options.memory; /**/
+  vrm->string_pool = loader->vrm_options.string_pool;
+
+  loader->memory = loader->options.memory;
+  if (loader->vrm_options.budget.max_bytes > 0)
+  {
+    loader->options.memory.alloc_func = &cgltf_vrm_budget_alloc;
+    loader->options.memory.free_func = &cgltf_vrm_budget_free;
+    loader->options.memory.user_data = loader;
+  }
+
+  if (gltf->data_extensions_count > 0)
+  {
+    loader->root_tokens = (void**)cgltf_calloc(&loader->options, sizeof(void*), gltf->data_extensions_count);
+    loader->root_token_bytes = (cgltf_size*)cgltf_calloc(&loader->options, sizeof(cgltf_size), gltf->data_extensions_count);
+    if (!loader->root_tokens || !loader->root_token_bytes)
+    {
+      return cgltf_result_out_of_memory;
+    }
+  }
+
+  return cgltf_result_success;
+}
+
+cgltf_vrm_load_status cgltf_vrm_loader_step(cgltf_vrm_loader* loader)
+{
+  cgltf_data const* gltf = loader->gltf;
+  cgltf_result result = cgltf_result_success;
+  cgltf_size budget = (loader->vrm_options.step_budget > 0) ? loader->vrm_options.step_budget : (cgltf_size)-1;
+  cgltf_size total = 1;
+
+  if (loader->status != cgltf_vrm_load_status_in_progress)
+  {
+    return loader->status;
+  }
+
+  if (cgltf_vrm_loader_cancelled(loader))
+  {
+    return cgltf_vrm_loader_abort(loader, cgltf_vrm_load_status_cancelled, cgltf_result_success);
+  }
+
+  switch (loader->stage)
+  {
+    case cgltf_vrm_load_stage_tokenize:
+      total = gltf->data_extensions_count;
+      result = cgltf_vrm_loader_step_tokenize(loader, budget);
+    break;
+
+    case cgltf_vrm_load_stage_root_extensions:
+      total = gltf->data_extensions_count;
+      result = cgltf_vrm_loader_step_root_extensions(loader, budget);
+    break;
+
+    case cgltf_vrm_load_stage_node_constraints:
+    {
+      CGLTF_VRM_PROFILE_BEGIN(loader->vrm_options.profiler, zone, "VRMC_node_constraint");
+      total = gltf->nodes_count;
+      result = cgltf_vrm_loader_step_node_constraints(loader, budget);
+      CGLTF_VRM_PROFILE_END(loader->vrm_options.profiler, zone);
+    }
+    break;
+
+    case cgltf_vrm_load_stage_materials_mtoon:
+    {
+      CGLTF_VRM_PROFILE_BEGIN(loader->vrm_options.profiler, zone, "VRMC_materials_mtoon");
+      total = gltf->materials_count;
+      result = cgltf_vrm_loader_step_materials_mtoon(loader, budget);
+      CGLTF_VRM_PROFILE_END(loader->vrm_options.profiler, zone);
+    }
+    break;
+
+    case cgltf_vrm_load_stage_fixup_pointers:
+    {
+      CGLTF_VRM_PROFILE_BEGIN(loader->vrm_options.profiler, zone, "cgltf_vrm_fixup_pointers");
+      if (cgltf_vrm_fixup_pointers(gltf, loader->vrm) < 0)
+      {
+        result = cgltf_result_invalid_gltf;
+      }
+      loader->cursor = total;
+      CGLTF_VRM_PROFILE_END(loader->vrm_options.profiler, zone);
+    }
+    break;
+
+    default:
+    break;
+  }
+
+  if (result != cgltf_result_success)
+  {
+    /* Refused by the byte budget rather than by the allocator. */
+    if (loader->budget_exceeded)
+    {
+      result = cgltf_vrm_result_budget_exceeded;
+    }
+    return cgltf_vrm_loader_abort(loader, cgltf_vrm_load_status_failed, result);
+  }
+
+  if (cgltf_vrm_loader_cancelled(loader))
+  {
+    return cgltf_vrm_loader_abort(loader, cgltf_vrm_load_status_cancelled, cgltf_result_success);
+  }
+
+  if (loader->vrm_options.progress_func != NULL)
+  {
+    cgltf_float progress = (loader->cursor < total) ? (cgltf_float)loader->cursor / (cgltf_float)total : 1.0f;
+    loader->vrm_options.progress_func(loader->vrm_options.progress_user_data, loader->stage, progress);
+  }
+
+  if (loader->cursor >= total)
+  {
+    loader->stage = (cgltf_vrm_load_stage)(loader->stage + 1);
+    loader->cursor = 0;
+  }
+
+  if (loader->stage == cgltf_vrm_load_stage_done)
+  {
+    loader->status = cgltf_vrm_load_status_done;
+  }
+
+  return loader->status;
+}
+
+void cgltf_vrm_loader_free(cgltf_vrm_loader* loader)
+{
+  if (!loader)
+  {
+    return;
+  }
+
+  cgltf_vrm_loader_release_tokens(loader);
+
+  if (loader->root_tokens != NULL)
+  {
+    loader->options.memory.free_func(loader->options.memory.user_data, loader->root_tokens);
+    loader->root_tokens = NULL;
+  }
+
+  if (loader->root_token_bytes != NULL)
+  {
+    loader->options.memory.free_func(loader->options.memory.user_data, loader->root_token_bytes);
+    loader->root_token_bytes = NULL;
+  }
+
+  if (loader->budget_blocks != NULL)
+  {
+    loader->memory.free_func(loader->memory.user_data, loader->budget_blocks);
+    loader->memory.free_func(loader->memory.user_data, loader->budget_block_sizes);
+    loader->budget_blocks = NULL;
+    loader->budget_block_sizes = NULL;
+  }
+}
+
+cgltf_result cgltf_vrm_parse_cgltf_data(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data* vrm)
+{
+  cgltf_vrm_loader loader;
+
+  cgltf_result result = cgltf_vrm_loader_init(&loader, options, NULL, gltf, vrm);
+  if (result != cgltf_result_success)
+  {
+    cgltf_vrm_loader_free(&loader);
+    return result;
+  }
+
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_parse_cgltf_data");
+  while (cgltf_vrm_loader_step(&loader) == cgltf_vrm_load_status_in_progress)
+  {
+  }
+  CGLTF_VRM_PROFILE_END(NULL, zone);
+
+  result = loader.result;
+  cgltf_vrm_loader_free(&loader);
+
+  return result;
+}
+
+/* ----------- Metadata scan ----------- */
+
+static
+int cgltf_vrm_scan_json_vrm(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_meta_summary* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "specVersion") == 0)
+    {
+      ++i;
+      out->spec_version = cgltf_vrm_string_to_spec_version(tokens + i, json_chunk);
+      ++i;
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "meta") == 0)
+    {
+      /* Scans report no diagnostics, the meta parser only needs the allocator. */
+      cgltf_vrm_options vrm_options;
+      cgltf_size diagnostics_count[cgltf_vrm_diagnostic_kind_max_enum];
+      memset(&vrm_options, 0, sizeof(cgltf_vrm_options));
+      cgltf_vrm_parse_context ctx = { options, NULL, &vrm_options, NULL, diagnostics_count, -1, 0 };
+
+      i = cgltf_vrm_parse_json_meta(&ctx, tokens, i + 1, json_chunk, &out->meta);
+      if (out->meta.has_thumbnail_image)
+      {
+        out->thumbnail_image_index = (cgltf_int)((cgltf_size)out->meta.thumbnail_image - 1);
+        out->meta.thumbnail_image = NULL;
+      }
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "humanoid") == 0)
+    {
+      ++i;
+      CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+      int nElems = tokens[i].size;
+      ++i;
+
+      for (int k = 0; k < nElems && i >= 0; ++k)
+      {
+        if (cgltf_json_strcmp(tokens + i, json_chunk, "humanBones") == 0)
+        {
+          out->human_bones_count = tokens[i + 1].size;
+        }
+        i = cgltf_skip_json(tokens, i + 1);
+      }
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "expressions") == 0)
+    {
+      ++i;
+      CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+      int nElems = tokens[i].size;
+      ++i;
+
+      for (int k = 0; k < nElems && i >= 0; ++k)
+      {
+        if ((cgltf_json_strcmp(tokens + i, json_chunk, "preset") == 0) || (cgltf_json_strcmp(tokens + i, json_chunk, "custom") == 0))
+        {
+          out->expressions_count += tokens[i + 1].size;
+        }
+        i = cgltf_skip_json(tokens, i + 1);
+      }
+    }
+    else
+    {
+      i = cgltf_skip_json(tokens, i + 1);
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_scan_json_spring_bone(jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_meta_summary* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if (cgltf_json_strcmp(tokens + i, json_chunk, "colliders") == 0)
+    {
+      out->colliders_count = tokens[i + 1].size;
+      i = cgltf_skip_json(tokens, i + 1);
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "springs") == 0)
+    {
+      ++i;
+      CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_ARRAY);
+      out->springs_count = tokens[i].size;
+      ++i;
+
+      for (cgltf_size k = 0; k < out->springs_count && i >= 0; ++k)
+      {
+        CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+        int nElems = tokens[i].size;
+        ++i;
+
+        for (int l = 0; l < nElems && i >= 0; ++l)
+        {
+          if (cgltf_json_strcmp(tokens + i, json_chunk, "joints") == 0)
+          {
+            out->spring_joints_count += tokens[i + 1].size;
+          }
+          i = cgltf_skip_json(tokens, i + 1);
+        }
+      }
+    }
+    else
+    {
+      i = cgltf_skip_json(tokens, i + 1);
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_scan_json_materials(jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_meta_summary* out)
+{
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_ARRAY);
+
+  out->materials_count = tokens[i].size;
+  ++i;
+
+  for (cgltf_size j = 0; j < out->materials_count; ++j)
+  {
+    CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+    int nElems = tokens[i].size;
+    ++i;
+
+    for (int k = 0; k < nElems && i >= 0; ++k)
+    {
+      if ((cgltf_json_strcmp(tokens + i, json_chunk, "extensions") == 0) && (tokens[i + 1].type == JSMN_OBJECT))
+      {
+        int nExtensions = tokens[i + 1].size;
+        i += 2;
+
+        for (int l = 0; l < nExtensions && i >= 0; ++l)
+        {
+          if (cgltf_json_strcmp(tokens + i, json_chunk, "VRMC_materials_mtoon") == 0)
+          {
+            ++out->mtoon_materials_count;
+          }
+          i = cgltf_skip_json(tokens, i + 1);
+        }
+      }
+      else
+      {
+        i = cgltf_skip_json(tokens, i + 1);
+      }
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+static
+int cgltf_vrm_scan_json_root(cgltf_options* options, jsmntok_t const* tokens, uint8_t const* json_chunk, cgltf_vrm_meta_summary* out)
+{
+  int i = 0;
+
+  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+  int size = tokens[i].size;
+  ++i;
+
+  for (int j = 0; j < size; ++j)
+  {
+    CGLTF_CHECK_KEY(tokens[i]);
+
+    if ((cgltf_json_strcmp(tokens + i, json_chunk, "extensions") == 0) && (tokens[i + 1].type == JSMN_OBJECT))
+    {
+      int nExtensions = tokens[i + 1].size;
+      i += 2;
+
+      for (int k = 0; k < nExtensions && i >= 0; ++k)
+      {
+        if (cgltf_json_strcmp(tokens + i, json_chunk, "VRMC_vrm") == 0)
+        {
+          out->is_vrm = 1;
+          i = cgltf_vrm_scan_json_vrm(options, tokens, i + 1, json_chunk, out);
+        }
+        else if (cgltf_json_strcmp(tokens + i, json_chunk, "VRMC_springBone") == 0)
+        {
+          i = cgltf_vrm_scan_json_spring_bone(tokens, i + 1, json_chunk, out);
+        }
+        else
+        {
+          i = cgltf_skip_json(tokens, i + 1);
+        }
+      }
+    }
+    else if (cgltf_json_strcmp(tokens + i, json_chunk, "materials") == 0)
+    {
+      i = cgltf_vrm_scan_json_materials(tokens, i + 1, json_chunk, out);
+    }
+    else
+    {
+      i = cgltf_skip_json(tokens, i + 1);
+    }
+
+    if (i < 0)
+    {
+      return i;
+    }
+  }
+
+  return i;
+}
+
+/* Locate the JSON text of a GLB, or take the whole buffer when it is not one. */
+static
+cgltf_result cgltf_vrm_glb_json_chunk(void const* data, cgltf_size size, char const** json, cgltf_size* json_size)
+{
+  uint8_t const* bytes = (uint8_t const*)data;
+  uint32_t tmp;
+
+  if (size < GlbHeaderSize)
+  {
+    return cgltf_result_data_too_short;
+  }
+
+  memcpy(&tmp, bytes, 4);
+  if (tmp != GlbMagic)
+  {
+    *json = (char const*)data;
+    *json_size = size;
+    return cgltf_result_success;
+  }
+
+  memcpy(&tmp, bytes + 4, 4);
+  if (tmp != GlbVersion)
+  {
+    return tmp < GlbVersion ? cgltf_result_legacy_gltf : cgltf_result_unknown_format;
+  }
+
+  if (size < GlbHeaderSize + GlbChunkHeaderSize)
+  {
+    return cgltf_result_data_too_short;
+  }
+
+  uint32_t json_length;
+  memcpy(&json_length, bytes + GlbHeaderSize, 4);
+  memcpy(&tmp, bytes + GlbHeaderSize + 4, 4);
+  if (tmp != GlbMagicJsonChunk)
+  {
+    return cgltf_result_unknown_format;
+  }
+  if (json_length > size - GlbHeaderSize - GlbChunkHeaderSize)
+  {
+    return cgltf_result_data_too_short;
+  }
+
+  *json = (char const*)bytes + GlbHeaderSize + GlbChunkHeaderSize;
+  *json_size = json_length;
+
+  return cgltf_result_success;
+}
+
+static
+cgltf_result cgltf_vrm_scan_json(cgltf_options const* options, char const* json, cgltf_size json_size, cgltf_vrm_meta_summary* out)
+{
+  cgltf_options fixed_options;
+  jsmn_parser parser = { 0, 0, 0 };
+
+  if (options == NULL || out == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
+
+  memset(out, 0, sizeof(cgltf_vrm_meta_summary));
+  out->thumbnail_image_index = -1;
+  out->spec_version = cgltf_vrm_spec_version_max_enum;
+  out->memory = fixed_options.memory;
+
+  int token_count = (int)fixed_options.json_token_count;
+  if (token_count == 0)
+  {
+    token_count = jsmn_parse(&parser, json, json_size, NULL, 0);
+    if (token_count <= 0)
+    {
+      return cgltf_result_invalid_json;
+    }
+  }
+
+  jsmntok_t* tokens = (jsmntok_t*)fixed_options.memory.alloc_func(fixed_options.memory.user_data, sizeof(jsmntok_t) * (token_count + 1));
+  if (!tokens)
+  {
+    return cgltf_result_out_of_memory;
+  }
+
+  jsmn_init(&parser);
+  token_count = jsmn_parse(&parser, json, json_size, tokens, token_count);
+  if (token_count <= 0)
+  {
+    fixed_options.memory.free_func(fixed_options.memory.user_data, tokens);
+    return cgltf_result_invalid_json;
+  }
+  tokens[token_count].type = JSMN_UNDEFINED;
+
+  int i = cgltf_vrm_scan_json_root(&fixed_options, tokens, (uint8_t const*)json, out);
+  fixed_options.memory.free_func(fixed_options.memory.user_data, tokens);
+
+  if (i < 0)
+  {
+    cgltf_vrm_meta_summary_free(out);
+    return cgltf_vrm_result_from_error(i);
+  }
+
+  return cgltf_result_success;
+}
+
+cgltf_result cgltf_vrm_parse_meta(cgltf_options const* options, void const* data, cgltf_size size, cgltf_vrm_meta_summary* out)
+{
+  char const* json = NULL;
+  cgltf_size json_size = 0;
+
+  if (data == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  cgltf_result result = cgltf_vrm_glb_json_chunk(data, size, &json, &json_size);
+  if (result != cgltf_result_success)
+  {
+    return result;
+  }
+
+  return cgltf_vrm_scan_json(options, json, json_size, out);
+}
+
+cgltf_result cgltf_vrm_parse_meta_file(cgltf_options const* options, char const* path, cgltf_vrm_meta_summary* out)
+{
+  uint8_t header[GlbHeaderSize + GlbChunkHeaderSize];
+  cgltf_size header_size;
+  cgltf_size json_size;
+  char* json;
+  uint32_t tmp;
+
+  if (options == NULL || path == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  void* (*alloc_func)(void*, cgltf_size) = options->memory.alloc_func ? options->memory.alloc_func : &cgltf_default_alloc;
+  void (*free_func)(void*, void*) = options->memory.free_func ? options->memory.free_func : &cgltf_default_free;
+
+  FILE* file = fopen(path, "rb");
+  if (!file)
+  {
+    return cgltf_result_file_not_found;
+  }
+
+  header_size = fread(header, 1, sizeof(header), file);
+  memcpy(&tmp, header, 4);
+
+  if ((header_size >= 4) && (tmp == GlbMagic))
+  {
+    /* Binary glTF, only the JSON chunk is needed. */
+    cgltf_result result = cgltf_vrm_glb_json_chunk(header, header_size, (char const**)&json, &json_size);
+    if (result != cgltf_result_data_too_short)
+    {
+      fclose(file);
+      return (result == cgltf_result_success) ? cgltf_result_invalid_gltf : result;
+    }
+
+    uint32_t json_length;
+    memcpy(&json_length, header + GlbHeaderSize, 4);
+    memcpy(&tmp, header + GlbHeaderSize + 4, 4);
+    if ((header_size < sizeof(header)) || (tmp != GlbMagicJsonChunk))
+    {
+      fclose(file);
+      return (header_size < sizeof(header)) ? cgltf_result_data_too_short : cgltf_result_unknown_format;
+    }
+
+    /* The declared length is untrusted, bound it by the GLB length and the file size before allocating. */
+    uint32_t glb_length;
+    memcpy(&glb_length, header + 8, 4);
+    if ((glb_length < sizeof(header)) || (json_length > glb_length - sizeof(header)))
+    {
+      fclose(file);
+      return cgltf_result_invalid_gltf;
+    }
+    long file_length = (fseek(file, 0, SEEK_END) == 0) ? ftell(file) : -1;
+    if ((file_length < 0) || (fseek(file, (long)sizeof(header), SEEK_SET) != 0))
+    {
+      fclose(file);
+      return cgltf_result_io_error;
+    }
+    if ((cgltf_size)file_length < sizeof(header) || json_length > (cgltf_size)file_length - sizeof(header))
+    {
+      fclose(file);
+      return cgltf_result_data_too_short;
+    }
+
+    json_size = json_length;
+    json = (char*)alloc_func(options->memory.user_data, json_size);
+    if (!json)
+    {
+      fclose(file);
+      return cgltf_result_out_of_memory;
+    }
+    if (fread(json, 1, json_size, file) != json_size)
+    {
+      free_func(options->memory.user_data, json);
+      fclose(file);
+      return cgltf_result_io_error;
+    }
+  }
+  else
+  {
+    /* Plain JSON, read it whole. */
+    if (fseek(file, 0, SEEK_END) != 0)
+    {
+      fclose(file);
+      return cgltf_result_io_error;
+    }
+    long length = ftell(file);
+    if (length <= 0 || fseek(file, 0, SEEK_SET) != 0)
+    {
+      fclose(file);
+      return (length == 0) ? cgltf_result_data_too_short : cgltf_result_io_error;
+    }
+
+    json_size = (cgltf_size)length;
+    json = (char*)alloc_func(options->memory.user_data, json_size);
+    if (!json)
+    {
+      fclose(file);
+      return cgltf_result_out_of_memory;
+    }
+    if (fread(json, 1, json_size, file) != json_size)
+    {
+      free_func(options->memory.user_data, json);
+      fclose(file);
+      return cgltf_result_io_error;
+    }
+  }
+
+  fclose(file);
+
+  cgltf_result result = cgltf_vrm_scan_json(options, json, json_size, out);
+  free_func(options->memory.user_data, json);
+
+  return result;
+}
+
+void cgltf_vrm_meta_summary_free(cgltf_vrm_meta_summary* summary)
+{
+  if (!summary)
+  {
+    return;
+  }
+
+  if (summary->memory.free_func != NULL)
+  {
+    cgltf_vrm_free_meta(&summary->memory, &summary->meta);
+  }
+  memset(&summary->meta, 0, sizeof(cgltf_vrm_meta));
+}
+
+/* ----------- Content hash ----------- */
+
+/* Two 64-bit lanes fed with 64-bit words, murmur3 style mixing and finalization. */
+typedef struct cgltf_vrm_hash_state
+{
+  uint64_t a;
+  uint64_t b;
+  uint64_t length;
+} cgltf_vrm_hash_state;
+
+static
+uint64_t cgltf_vrm_hash_rotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static
+uint64_t cgltf_vrm_hash_fmix(uint64_t x)
+{
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+static
+void cgltf_vrm_hash_begin(cgltf_vrm_hash_state* state, uint64_t seed)
+{
+  state->a = seed ^ 0x9e3779b97f4a7c15ULL;
+  state->b = seed ^ 0x6a09e667f3bcc909ULL;
+  state->length = 0;
+}
+
+static
+void cgltf_vrm_hash_u64(cgltf_vrm_hash_state* state, uint64_t v)
+{
+  state->a ^= cgltf_vrm_hash_rotl(v * 0x87c37b91114253d5ULL, 31) * 0x4cf5ad432745937fULL;
+  state->a = cgltf_vrm_hash_rotl(state->a, 27) + state->b;
+  state->a = state->a * 5 + 0x52dce729;
+
+  state->b ^= cgltf_vrm_hash_rotl(v * 0x4cf5ad432745937fULL, 33) * 0x87c37b91114253d5ULL;
+  state->b = cgltf_vrm_hash_rotl(state->b, 31) + state->a;
+  state->b = state->b * 5 + 0x38495ab5;
+
+  state->length += 1;
+}
+
+static
+cgltf_vrm_hash128 cgltf_vrm_hash_end(cgltf_vrm_hash_state const* state)
+{
+  cgltf_vrm_hash128 hash;
+  uint64_t a = state->a ^ state->length;
+  uint64_t b = state->b ^ state->length;
+
+  a += b;
+  b += a;
+  a = cgltf_vrm_hash_fmix(a);
+  b = cgltf_vrm_hash_fmix(b);
+  a += b;
+  b += a;
+
+  hash.low = a;
+  hash.high = b;
+  return hash;
+}
+
+static
+void cgltf_vrm_hash_int(cgltf_vrm_hash_state* state, cgltf_int v)
+{
+  cgltf_vrm_hash_u64(state, (uint64_t)(int64_t)v);
+}
+
+static
+void cgltf_vrm_hash_float(cgltf_vrm_hash_state* state, cgltf_float v)
+{
+  uint32_t bits;
+
+  if (v != v)
+  {
+    bits = 0x7fc00000u;
+  }
+  else
+  {
+    v = (v == 0.0f) ? 0.0f : v; /* -0 */
+    memcpy(&bits, &v, sizeof(bits));
+  }
+  cgltf_vrm_hash_u64(state, bits);
+}
+
+static
+void cgltf_vrm_hash_floats(cgltf_vrm_hash_state* state, cgltf_float const* v, cgltf_size count)
+{
+  for (cgltf_size i = 0; i < count; ++i)
+  {
+    cgltf_vrm_hash_float(state, v[i]);
+  }
+}
+
+/* Bytes are packed explicitly so the result does not depend on endianness. */
+static
+void cgltf_vrm_hash_str(cgltf_vrm_hash_state* state, char const* str)
+{
+  cgltf_size length = str ? strlen(str) : 0;
+  uint64_t word = 0;
+
+  cgltf_vrm_hash_u64(state, (uint64_t)length + (str != NULL));
+  for (cgltf_size i = 0; i < length; ++i)
+  {
+    word |= (uint64_t)(unsigned char)str[i] << (8 * (i & 7));
+    if ((i & 7) == 7)
+    {
+      cgltf_vrm_hash_u64(state, word);
+      word = 0;
+    }
+  }
+  if (length & 7)
+  {
+    cgltf_vrm_hash_u64(state, word);
+  }
+}
+
+static
+void cgltf_vrm_hash_node(cgltf_vrm_hash_state* state, cgltf_data const* gltf, cgltf_node const* node)
+{
+  cgltf_vrm_hash_int(state, node ? (cgltf_int)(node - gltf->nodes) : -1);
+}
+
+static
+void cgltf_vrm_hash_material(cgltf_vrm_hash_state* state, cgltf_data const* gltf, cgltf_material const* material)
+{
+  cgltf_vrm_hash_int(state, material ? (cgltf_int)(material - gltf->materials) : -1);
+}
+
+/* Order independent accumulation, for entries coming from JSON dictionaries. */
+static
+void cgltf_vrm_hash_accumulate(cgltf_vrm_hash128* sum, cgltf_vrm_hash_state const* entry)
+{
+  cgltf_vrm_hash128 hash = cgltf_vrm_hash_end(entry);
+  sum->low += hash.low;
+  sum->high += hash.high;
+}
+
+static
+void cgltf_vrm_hash_hash128(cgltf_vrm_hash_state* state, cgltf_vrm_hash128 hash)
+{
+  cgltf_vrm_hash_u64(state, hash.low);
+  cgltf_vrm_hash_u64(state, hash.high);
+}
+
+static
+cgltf_vrm_hash128 cgltf_vrm_hash_humanoid(cgltf_data const* gltf, cgltf_vrm_humanoid const* humanoid)
+{
+  cgltf_vrm_hash_state state;
+  cgltf_vrm_hash128 sum = { 0, 0 };
+
+  for (cgltf_size i = 0; i < humanoid->human_bones_count; ++i)
+  {
+    cgltf_vrm_hash_state entry;
+    cgltf_vrm_hash_begin(&entry, 0);
+    cgltf_vrm_hash_str(&entry, humanoid->human_bones[i].name);
+    cgltf_vrm_hash_node(&entry, gltf, humanoid->human_bones[i].node);
+    cgltf_vrm_hash_accumulate(&sum, &entry);
+  }
+
+  cgltf_vrm_hash_begin(&state, 1);
+  cgltf_vrm_hash_u64(&state, humanoid->human_bones_count);
+  cgltf_vrm_hash_hash128(&state, sum);
+  return cgltf_vrm_hash_end(&state);
+}
+
+static
+void cgltf_vrm_hash_expression(cgltf_vrm_hash_state* state, cgltf_data const* gltf, cgltf_vrm_expression const* expression)
+{
+  cgltf_vrm_hash_str(state, expression->name);
+  cgltf_vrm_hash_int(state, expression->is_binary);
+  cgltf_vrm_hash_int(state, expression->override_blink);
+  cgltf_vrm_hash_int(state, expression->override_look_at);
+  cgltf_vrm_hash_int(state, expression->override_mouth);
+
+  cgltf_vrm_hash_u64(state, expression->morph_target_binds_count);
+  for (cgltf_size i = 0; i < expression->morph_target_binds_count; ++i)
+  {
+    cgltf_vrm_expression_morph_target_bind const* bind = &expression->morph_target_binds[i];
+    cgltf_vrm_hash_node(state, gltf, bind->node);
+    cgltf_vrm_hash_int(state, bind->index);
+    cgltf_vrm_hash_float(state, bind->weight);
+  }
+
+  cgltf_vrm_hash_u64(state, expression->material_color_binds_count);
+  for (cgltf_size i = 0; i < expression->material_color_binds_count; ++i)
+  {
+    cgltf_vrm_expression_material_color_bind const* bind = &expression->material_color_binds[i];
+    cgltf_vrm_hash_material(state, gltf, bind->material);
+    cgltf_vrm_hash_int(state, bind->type);
+    cgltf_vrm_hash_floats(state, bind->target_value, 4);
+  }
+
+  cgltf_vrm_hash_u64(state, expression->texture_transform_binds_count);
+  for (cgltf_size i = 0; i < expression->texture_transform_binds_count; ++i)
+  {
+    cgltf_vrm_expression_texture_transform_bind const* bind = &expression->texture_transform_binds[i];
+    cgltf_vrm_hash_material(state, gltf, bind->material);
+    cgltf_vrm_hash_floats(state, bind->scale, 2);
+    cgltf_vrm_hash_floats(state, bind->offset, 2);
+  }
+}
+
+static
+cgltf_vrm_hash128 cgltf_vrm_hash_expressions(cgltf_data const* gltf, cgltf_vrm_core const* core)
+{
+  cgltf_vrm_hash_state state;
+  cgltf_vrm_hash128 preset = { 0, 0 };
+  cgltf_vrm_hash128 custom = { 0, 0 };
+
+  for (cgltf_size i = 0; i < core->expressions.preset_count; ++i)
+  {
+    cgltf_vrm_hash_state entry;
+    cgltf_vrm_hash_begin(&entry, 0);
+    cgltf_vrm_hash_expression(&entry, gltf, &core->expressions.preset[i]);
+    cgltf_vrm_hash_accumulate(&preset, &entry);
+  }
+  for (cgltf_size i = 0; i < core->expressions.custom_count; ++i)
+  {
+    cgltf_vrm_hash_state entry;
+    cgltf_vrm_hash_begin(&entry, 0);
+    cgltf_vrm_hash_expression(&entry, gltf, &core->expressions.custom[i]);
+    cgltf_vrm_hash_accumulate(&custom, &entry);
+  }
+
+  cgltf_vrm_hash_begin(&state, 2);
+  cgltf_vrm_hash_int(&state, core->has_expressions);
+  cgltf_vrm_hash_u64(&state, core->expressions.preset_count);
+  cgltf_vrm_hash_hash128(&state, preset);
+  cgltf_vrm_hash_u64(&state, core->expressions.custom_count);
+  cgltf_vrm_hash_hash128(&state, custom);
+  return cgltf_vrm_hash_end(&state);
+}
+
+static
+cgltf_vrm_hash128 cgltf_vrm_hash_look_at(cgltf_vrm_core const* core)
+{
+  cgltf_vrm_hash_state state;
+  cgltf_vrm_look_at const* look_at = &core->look_at;
+  cgltf_vrm_look_at_range_map const* maps[4] = {
+    &look_at->range_map_horizontal_inner, &look_at->range_map_horizontal_outer,
+    &look_at->range_map_vertical_down, &look_at->range_map_vertical_up
+  };
+
+  cgltf_vrm_hash_begin(&state, 3);
+  cgltf_vrm_hash_int(&state, core->has_look_at);
+  cgltf_vrm_hash_int(&state, look_at->type);
+  cgltf_vrm_hash_floats(&state, look_at->offset_from_head_bone, 3);
+  for (int i = 0; i < 4; ++i)
+  {
+    cgltf_vrm_hash_float(&state, maps[i]->input_max_value);
+    cgltf_vrm_hash_float(&state, maps[i]->output_scale);
+  }
+  return cgltf_vrm_hash_end(&state);
+}
+
+static
+cgltf_vrm_hash128 cgltf_vrm_hash_first_person(cgltf_data const* gltf, cgltf_vrm_core const* core)
+{
+  cgltf_vrm_hash_state state;
+  cgltf_vrm_first_person const* first_person = &core->first_person;
+
+  cgltf_vrm_hash_begin(&state, 4);
+  cgltf_vrm_hash_int(&state, core->has_first_person);
+  cgltf_vrm_hash_u64(&state, first_person->mesh_annotations_count);
+  for (cgltf_size i = 0; i < first_person->mesh_annotations_count; ++i)
+  {
+    cgltf_vrm_hash_node(&state, gltf, first_person->mesh_annotations[i].node);
+    cgltf_vrm_hash_int(&state, first_person->mesh_annotations[i].type);
+  }
+  return cgltf_vrm_hash_end(&state);
+}
+
+/* Collider group and spring names are left out : they do not change the simulation. */
+static
+cgltf_vrm_hash128 cgltf_vrm_hash_spring_bone(cgltf_data const* gltf, cgltf_vrm_data const* vrm)
+{
+  cgltf_vrm_hash_state state;
+  cgltf_vrm_spring_bone const* spring_bone = &vrm->spring_bone;
+
+  cgltf_vrm_hash_begin(&state, 5);
+  cgltf_vrm_hash_int(&state, vrm->has_spring_bone);
+
+  cgltf_vrm_hash_u64(&state, spring_bone->colliders_count);
+  for (cgltf_size i = 0; i < spring_bone->colliders_count; ++i)
+  {
+    cgltf_vrm_spring_bone_collider const* collider = &spring_bone->colliders[i];
+    cgltf_vrm_hash_node(&state, gltf, collider->node);
+    cgltf_vrm_hash_int(&state, collider->shape);
+    cgltf_vrm_hash_floats(&state, collider->offset, 3);
+    cgltf_vrm_hash_float(&state, collider->radius);
+    cgltf_vrm_hash_int(&state, collider->inside);
+    if (collider->shape == cgltf_vrm_spring_bone_collider_shape_capsule)
+    {
+      cgltf_vrm_hash_floats(&state, collider->tail, 3);
+    }
+    else if (collider->shape == cgltf_vrm_spring_bone_collider_shape_plane)
+    {
+      cgltf_vrm_hash_floats(&state, collider->normal, 3);
+    }
+  }
+
+  cgltf_vrm_hash_u64(&state, spring_bone->collider_groups_count);
+  for (cgltf_size i = 0; i < spring_bone->collider_groups_count; ++i)
+  {
+    cgltf_vrm_spring_bone_collider_group const* group = &spring_bone->collider_groups[i];
+    cgltf_vrm_hash_u64(&state, group->colliders_count);
+    for (cgltf_size j = 0; j < group->colliders_count; ++j)
+    {
+      cgltf_vrm_hash_int(&state, group->colliders[j]);
+    }
+  }
+
+  cgltf_vrm_hash_u64(&state, spring_bone->springs_count);
+  for (cgltf_size i = 0; i < spring_bone->springs_count; ++i)
+  {
+    cgltf_vrm_spring_bone_spring const* spring = &spring_bone->springs[i];
+
+    cgltf_vrm_hash_node(&state, gltf, spring->center);
+    cgltf_vrm_hash_u64(&state, spring->collider_groups_count);
+    for (cgltf_size j = 0; j < spring->collider_groups_count; ++j)
+    {
+      cgltf_vrm_hash_int(&state, spring->collider_groups[j]);
+    }
+
+    cgltf_vrm_hash_u64(&state, spring->joints_count);
+    for (cgltf_size j = 0; j < spring->joints_count; ++j)
+    {
+      cgltf_vrm_spring_bone_spring_joint const* joint = &spring->joints[j];
+      cgltf_vrm_hash_node(&state, gltf, joint->node);
+      cgltf_vrm_hash_float(&state, joint->hit_radius);
+      cgltf_vrm_hash_float(&state, joint->stiffness);
+      cgltf_vrm_hash_float(&state, joint->gravity_power);
+      cgltf_vrm_hash_floats(&state, joint->gravity_dir, 3);
+      cgltf_vrm_hash_float(&state, joint->drag_force);
+    }
+  }
+  return cgltf_vrm_hash_end(&state);
+}
+
+static
+cgltf_vrm_hash128 cgltf_vrm_hash_node_constraints(cgltf_data const* gltf, cgltf_vrm_data const* vrm)
+{
+  cgltf_vrm_hash_state state;
+
+  cgltf_vrm_hash_begin(&state, 6);
+  for (cgltf_size i = 0; i < vrm->extended_nodes_count; ++i)
+  {
+    cgltf_vrm_node_constraint const* constraint = &vrm->extended_nodes[i].node_constraint;
+
+    if (!vrm->extended_nodes[i].has_node_constraint)
+    {
+      continue;
+    }
+    cgltf_vrm_hash_u64(&state, i);
+    cgltf_vrm_hash_int(&state, constraint->type);
+    cgltf_vrm_hash_node(&state, gltf, constraint->source);
+    cgltf_vrm_hash_float(&state, constraint->weight);
+    cgltf_vrm_hash_int(&state, (constraint->type == cgltf_vrm_node_constraint_type_aim) ? (cgltf_int)constraint->axis.aim : (cgltf_int)constraint->axis.roll);
+  }
+  return cgltf_vrm_hash_end(&state);
+}
+
+static
+void cgltf_vrm_hash_mtoon_texture(cgltf_vrm_hash_state* state, cgltf_vrm_mtoon_texture_info const* info)
+{
+  cgltf_vrm_hash_int(state, info->index);
+  cgltf_vrm_hash_int(state, info->tex_coord);
+}
+
+static
+cgltf_vrm_hash128 cgltf_vrm_hash_materials_mtoon(cgltf_vrm_data const* vrm)
+{
+  cgltf_vrm_hash_state state;
+
+  cgltf_vrm_hash_begin(&state, 7);
+  for (cgltf_size i = 0; i < vrm->extended_materials_count; ++i)
+  {
+    cgltf_vrm_mtoon const* mtoon = &vrm->extended_materials[i].mtoon;
+
+    if (!vrm->extended_materials[i].has_mtoon)
+    {
+      continue;
+    }
+    cgltf_vrm_hash_u64(&state, i);
+    cgltf_vrm_hash_int(&state, mtoon->transparent_with_z_write);
+    cgltf_vrm_hash_int(&state, mtoon->render_queue_offset_number);
+    cgltf_vrm_hash_floats(&state, mtoon->shade_color_factor, 3);
+    cgltf_vrm_hash_mtoon_texture(&state, &mtoon->shade_multiply_texture);
+    cgltf_vrm_hash_float(&state, mtoon->shading_shift_factor);
+    cgltf_vrm_hash_int(&state, mtoon->shading_shift_texture.index);
+    cgltf_vrm_hash_int(&state, mtoon->shading_shift_texture.tex_coord);
+    cgltf_vrm_hash_float(&state, mtoon->shading_shift_texture.scale);
+    cgltf_vrm_hash_float(&state, mtoon->shading_toony_factor);
+    cgltf_vrm_hash_float(&state, mtoon->gi_equalization_factor);
+    cgltf_vrm_hash_floats(&state, mtoon->matcap_factor, 3);
+    cgltf_vrm_hash_mtoon_texture(&state, &mtoon->matcap_texture);
+    cgltf_vrm_hash_floats(&state, mtoon->parametric_rim_color_factor, 3);
+    cgltf_vrm_hash_float(&state, mtoon->parametric_rim_fresnel_power_factor);
+    cgltf_vrm_hash_float(&state, mtoon->parametric_rim_lift_factor);
+    cgltf_vrm_hash_mtoon_texture(&state, &mtoon->rim_multiply_texture);
+    cgltf_vrm_hash_float(&state, mtoon->rim_lighting_mix_factor);
+    cgltf_vrm_hash_int(&state, mtoon->outline_width_mode);
+    cgltf_vrm_hash_float(&state, mtoon->outline_width_factor);
+    cgltf_vrm_hash_mtoon_texture(&state, &mtoon->outline_width_multiply_texture);
+    cgltf_vrm_hash_floats(&state, mtoon->outline_color_factor, 3);
+    cgltf_vrm_hash_float(&state, mtoon->outline_lighting_mix_factor);
+    cgltf_vrm_hash_mtoon_texture(&state, &mtoon->uv_animation_mask_texture);
+    cgltf_vrm_hash_float(&state, mtoon->uv_animation_scroll_x_speed_factor);
+    cgltf_vrm_hash_float(&state, mtoon->uv_animation_scroll_y_speed_factor);
+    cgltf_vrm_hash_float(&state, mtoon->uv_animation_rotation_speed_factor);
+  }
+  return cgltf_vrm_hash_end(&state);
+}
+
+void cgltf_vrm_hash(cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_content_hash* out)
+{
+  cgltf_vrm_hash_state state;
+
+  out->humanoid = cgltf_vrm_hash_humanoid(gltf, &vrm->core.humanoid);
+  out->expressions = cgltf_vrm_hash_expressions(gltf, &vrm->core);
+  out->look_at = cgltf_vrm_hash_look_at(&vrm->core);
+  out->first_person = cgltf_vrm_hash_first_person(gltf, &vrm->core);
+  out->spring_bone = cgltf_vrm_hash_spring_bone(gltf, vrm);
+  out->node_constraints = cgltf_vrm_hash_node_constraints(gltf, vrm);
+  out->materials_mtoon = cgltf_vrm_hash_materials_mtoon(vrm);
+
+  cgltf_vrm_hash_begin(&state, 8);
+  cgltf_vrm_hash_int(&state, vrm->core.spec_version);
+  cgltf_vrm_hash_hash128(&state, out->humanoid);
+  cgltf_vrm_hash_hash128(&state, out->expressions);
+  cgltf_vrm_hash_hash128(&state, out->look_at);
+  cgltf_vrm_hash_hash128(&state, out->first_person);
+  cgltf_vrm_hash_hash128(&state, out->spring_bone);
+  cgltf_vrm_hash_hash128(&state, out->node_constraints);
+  cgltf_vrm_hash_hash128(&state, out->materials_mtoon);
+  out->all = cgltf_vrm_hash_end(&state);
+}
+
+/* ----------- Animation sampling ----------- */
+
+typedef struct cgltf_vrm_animation_binding
+{
+  cgltf_vrm_animation_track_target target; /* max_enum when the node is not bound */
+  cgltf_int index;
+} cgltf_vrm_animation_binding;
+
+/* Returns the target a channel drives, max_enum when it is ignored. */
+static
+cgltf_vrm_animation_track_target cgltf_vrm_animation_channel_target(cgltf_data const* gltf, cgltf_vrm_animation_binding const* bindings, cgltf_animation_channel const* channel, cgltf_int* index)
+{
+  if (channel->target_node == NULL || channel->sampler == NULL || channel->sampler->input == NULL || channel->sampler->output == NULL)
+  {
+    return cgltf_vrm_animation_track_target_max_enum;
+  }
+
+  cgltf_vrm_animation_binding const* binding = &bindings[channel->target_node - gltf->nodes];
+  *index = binding->index;
+
+  switch (binding->target)
+  {
+    case cgltf_vrm_animation_track_target_bone_rotation:
+      if (channel->target_path == cgltf_animation_path_type_rotation)
+      {
+        return cgltf_vrm_animation_track_target_bone_rotation;
+      }
+      if (channel->target_path == cgltf_animation_path_type_translation && binding->index == cgltf_vrm_humanoid_bone_type_hips)
+      {
+        return cgltf_vrm_animation_track_target_hips_translation;
+      }
+      break;
+
+    case cgltf_vrm_animation_track_target_look_at_rotation:
+      if (channel->target_path == cgltf_animation_path_type_rotation)
+      {
+        return cgltf_vrm_animation_track_target_look_at_rotation;
+      }
+      break;
+
+    case cgltf_vrm_animation_track_target_expression:
+      if (channel->target_path == cgltf_animation_path_type_translation)
+      {
+        return cgltf_vrm_animation_track_target_expression;
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  return cgltf_vrm_animation_track_target_max_enum;
+}
+
+static
+cgltf_size cgltf_vrm_animation_target_components(cgltf_vrm_animation_track_target target)
+{
+  switch (target)
+  {
+    case cgltf_vrm_animation_track_target_bone_rotation:
+    case cgltf_vrm_animation_track_target_look_at_rotation:
+      return 4;
+    case cgltf_vrm_animation_track_target_hips_translation:
+      return 3;
+    default:
+      return 1;
+  }
+}
+
+static
+cgltf_size cgltf_vrm_animation_channel_keys(cgltf_animation_channel const* channel, cgltf_size components)
+{
+  cgltf_size keys = channel->sampler->input->count;
+  cgltf_size blocks = (channel->sampler->interpolation == cgltf_interpolation_type_cubic_spline) ? 3 : 1;
+  return keys + keys * components * blocks;
+}
+
+/* Output accessor type glTF requires for the target path. Expressions are animated through the node
+ * translation (x holds the weight), so they read a VEC3 too. */
+static
+cgltf_type cgltf_vrm_animation_path_type(cgltf_animation_path_type path)
+{
+  switch (path)
+  {
+    case cgltf_animation_path_type_rotation:
+      return cgltf_type_vec4;
+    case cgltf_animation_path_type_translation:
+    case cgltf_animation_path_type_scale:
+      return cgltf_type_vec3;
+    case cgltf_animation_path_type_weights:
+      return cgltf_type_scalar;
+    default:
+      return cgltf_type_invalid;
+  }
+}
+
+/* Copies the channel keyframes into `keys`, transposed to one array per component. */
+static
+cgltf_result cgltf_vrm_animation_read_track(cgltf_animation_channel const* channel, cgltf_vrm_animation_track* track, cgltf_float* keys)
+{
+  cgltf_accessor const* input = channel->sampler->input;
+  cgltf_accessor const* output = channel->sampler->output;
+  cgltf_size blocks = (track->interpolation == cgltf_interpolation_type_cubic_spline) ? 3 : 1;
+  cgltf_size count = input->count;
+  cgltf_float element[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+  if (count == 0 || output->count < count * blocks || input->type != cgltf_type_scalar
+    || output->type != cgltf_vrm_animation_path_type(channel->target_path))
+  {
+    return cgltf_result_invalid_gltf;
+  }
+
+  track->keys_count = count;
+  track->times = keys;
+  track->values = keys + count;
+
+  for (cgltf_size k = 0; k < count; ++k)
+  {
+    if (!cgltf_accessor_read_float(input, k, &track->times[k], 1))
+    {
+      return cgltf_result_invalid_gltf;
+    }
+
+    for (cgltf_size b = 0; b < blocks; ++b)
+    {
+      if (!cgltf_accessor_read_float(output, k * blocks + b, element, 4))
+      {
+        return cgltf_result_invalid_gltf;
+      }
+      for (cgltf_size c = 0; c < track->components; ++c)
+      {
+        track->values[(b * track->components + c) * count + k] = element[c];
+      }
+    }
+  }
+
+  return cgltf_result_success;
+}
+
+cgltf_result cgltf_vrm_animation_clip_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_animation const* animation, cgltf_vrm_animation_clip* clip)
+{
+  cgltf_options fixed_options;
+  cgltf_vrm_animation_binding* bindings;
+  cgltf_vrm_humanoid const* humanoid;
+  cgltf_vrm_animation const* vrma = vrm ? &vrm->animation : NULL;
+  cgltf_size keys_count = 0;
+  cgltf_result result = cgltf_result_success;
+
+  if (options == NULL || gltf == NULL || vrm == NULL || animation == NULL || clip == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
+
+  memset(clip, 0, sizeof(cgltf_vrm_animation_clip));
+  clip->memory = fixed_options.memory;
+  clip->hips_translation_track = -1;
+  clip->look_at_track = -1;
+  for (int b = 0; b < cgltf_vrm_humanoid_bone_type_max_enum; ++b)
+  {
+    clip->bone_tracks[b] = -1;
+  }
+
+  if (gltf->nodes_count == 0)
+  {
+    return cgltf_result_success;
+  }
+
+  /* Node to target lookup. */
+  bindings = (cgltf_vrm_animation_binding*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_animation_binding), gltf->nodes_count);
+  if (!bindings)
+  {
+    return cgltf_result_out_of_memory;
+  }
+  for (cgltf_size i = 0; i < gltf->nodes_count; ++i)
+  {
+    bindings[i].target = cgltf_vrm_animation_track_target_max_enum;
+  }
+
+  humanoid = vrm->has_animation ? &vrma->humanoid : &vrm->core.humanoid;
+  for (cgltf_size i = 0; i < humanoid->human_bones_count; ++i)
+  {
+    cgltf_vrm_humanoid_bone const* bone = &humanoid->human_bones[i];
+    if (bone->node != NULL && bone->type != cgltf_vrm_humanoid_bone_type_max_enum)
+    {
+      bindings[bone->node - gltf->nodes].target = cgltf_vrm_animation_track_target_bone_rotation;
+      bindings[bone->node - gltf->nodes].index = bone->type;
+    }
+  }
+
+  if (vrm->has_animation)
+  {
+    clip->expressions_count = vrma->preset_expressions_count + vrma->custom_expressions_count;
+
+    for (cgltf_size i = 0; i < clip->expressions_count; ++i)
+    {
+      cgltf_vrm_animation_expression const* expression = (i < vrma->preset_expressions_count)
+        ? &vrma->preset_expressions[i] : &vrma->custom_expressions[i - vrma->preset_expressions_count];
+      if (expression->node != NULL)
+      {
+        bindings[expression->node - gltf->nodes].target = cgltf_vrm_animation_track_target_expression;
+        bindings[expression->node - gltf->nodes].index = (cgltf_int)i;
+      }
+    }
+
+    if (vrma->has_look_at && vrma->look_at_node != NULL)
+    {
+      bindings[vrma->look_at_node - gltf->nodes].target = cgltf_vrm_animation_track_target_look_at_rotation;
+      bindings[vrma->look_at_node - gltf->nodes].index = 0;
+    }
+  }
+
+  /* Count tracks and keyframe storage. */
+  for (cgltf_size i = 0; i < animation->channels_count; ++i)
+  {
+    cgltf_int index = 0;
+    cgltf_vrm_animation_track_target target = cgltf_vrm_animation_channel_target(gltf, bindings, &animation->channels[i], &index);
+
+    if (target != cgltf_vrm_animation_track_target_max_enum)
+    {
+      clip->tracks_count += 1;
+      keys_count += cgltf_vrm_animation_channel_keys(&animation->channels[i], cgltf_vrm_animation_target_components(target));
+    }
+  }
+
+  if (clip->expressions_count > 0)
+  {
+    clip->expression_names = (char const**)cgltf_calloc(&fixed_options, sizeof(char const*), clip->expressions_count);
+    clip->expression_tracks = (cgltf_int*)cgltf_calloc(&fixed_options, sizeof(cgltf_int), clip->expressions_count);
+    if (!clip->expression_names || !clip->expression_tracks)
+    {
+      result = cgltf_result_out_of_memory;
+      goto cleanup;
+    }
+
+    for (cgltf_size i = 0; i < clip->expressions_count; ++i)
+    {
+      clip->expression_names[i] = (i < vrma->preset_expressions_count)
+        ? vrma->preset_expressions[i].name : vrma->custom_expressions[i - vrma->preset_expressions_count].name;
+      clip->expression_tracks[i] = -1;
+    }
+  }
+
+  if (clip->tracks_count > 0)
+  {
+    clip->tracks = (cgltf_vrm_animation_track*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_animation_track), clip->tracks_count);
+    clip->keys = (cgltf_float*)cgltf_calloc(&fixed_options, sizeof(cgltf_float), keys_count);
+    if (!clip->tracks || !clip->keys)
+    {
+      result = cgltf_result_out_of_memory;
+      goto cleanup;
+    }
+  }
+
+  /* Rotation tracks first so they can be interpolated as one batch. */
+  {
+    cgltf_size track_index = 0;
+    cgltf_float* keys = clip->keys;
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+      for (cgltf_size i = 0; i < animation->channels_count; ++i)
+      {
+        cgltf_animation_channel const* channel = &animation->channels[i];
+        cgltf_int index = 0;
+        cgltf_vrm_animation_track_target target = cgltf_vrm_animation_channel_target(gltf, bindings, channel, &index);
+        cgltf_size components = cgltf_vrm_animation_target_components(target);
+
+        if (target == cgltf_vrm_animation_track_target_max_enum || ((components == 4) != (pass == 0)))
+        {
+          continue;
+        }
+
+        cgltf_vrm_animation_track* track = &clip->tracks[track_index];
+        track->target = target;
+        track->index = index;
+        track->interpolation = channel->sampler->interpolation;
+        track->components = components;
+
+        result = cgltf_vrm_animation_read_track(channel, track, keys);
+        if (result != cgltf_result_success)
+        {
+          goto cleanup;
+        }
+        keys += cgltf_vrm_animation_channel_keys(channel, components);
+
+        if (track->keys_count > 0 && track->times[track->keys_count - 1] > clip->duration)
+        {
+          clip->duration = track->times[track->keys_count - 1];
+        }
+
+        switch (target)
+        {
+          case cgltf_vrm_animation_track_target_bone_rotation: clip->bone_tracks[index] = (cgltf_int)track_index; break;
+          case cgltf_vrm_animation_track_target_look_at_rotation: clip->look_at_track = (cgltf_int)track_index; break;
+          case cgltf_vrm_animation_track_target_hips_translation: clip->hips_translation_track = (cgltf_int)track_index; break;
+          case cgltf_vrm_animation_track_target_expression: clip->expression_tracks[index] = (cgltf_int)track_index; break;
+          default: break;
+        }
+
+        track_index += 1;
+      }
+
+      if (pass == 0)
+      {
+        clip->rotation_tracks_count = track_index;
+      }
+    }
+  }
+
+cleanup:
+  fixed_options.memory.free_func(fixed_options.memory.user_data, bindings);
+  if (result != cgltf_result_success)
+  {
+    cgltf_vrm_animation_clip_free(clip);
+  }
+  return result;
+}
+
+void cgltf_vrm_animation_clip_free(cgltf_vrm_animation_clip* clip)
+{
+  if (!clip || !clip->memory.free_func)
+  {
+    return;
+  }
+
+  clip->memory.free_func(clip->memory.user_data, clip->tracks);
+  clip->memory.free_func(clip->memory.user_data, clip->keys);
+  clip->memory.free_func(clip->memory.user_data, (void*)clip->expression_names);
+  clip->memory.free_func(clip->memory.user_data, clip->expression_tracks);
+
+  clip->tracks = NULL;
+  clip->keys = NULL;
+  clip->expression_names = NULL;
+  clip->expression_tracks = NULL;
+  clip->tracks_count = 0;
+  clip->rotation_tracks_count = 0;
+  clip->expressions_count = 0;
+}
+
+cgltf_result cgltf_vrm_animation_sampler_init(cgltf_vrm_animation_sampler* sampler, cgltf_vrm_animation_clip const* clip)
+{
+  cgltf_options options;
+
+  if (sampler == NULL || clip == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  memset(sampler, 0, sizeof(cgltf_vrm_animation_sampler));
+  memset(&options, 0, sizeof(options));
+  options.memory = clip->memory;
+  cgltf_vrm_fix_memory_options(&options);
+
+  sampler->clip = clip;
+  sampler->memory = options.memory;
+
+  for (int b = 0; b < cgltf_vrm_humanoid_bone_type_max_enum; ++b)
+  {
+    sampler->bone_rotations[b][3] = 1.0f;
+  }
+  sampler->look_at_rotation[3] = 1.0f;
+
+  if (clip->tracks_count > 0)
+  {
+    /* u, then the 4 components of both keys per track */
+    sampler->cursors = (cgltf_size*)cgltf_calloc(&options, sizeof(cgltf_size), clip->tracks_count);
+    sampler->scratch = (cgltf_float*)cgltf_calloc(&options, sizeof(cgltf_float), clip->tracks_count * 9);
+  }
+  if (clip->expressions_count > 0)
+  {
+    sampler->expression_weights = (cgltf_float*)cgltf_calloc(&options, sizeof(cgltf_float), clip->expressions_count);
+  }
+
+  if ((clip->tracks_count > 0 && (!sampler->cursors || !sampler->scratch)) || (clip->expressions_count > 0 && !sampler->expression_weights))
+  {
+    cgltf_vrm_animation_sampler_free(sampler);
+    return cgltf_result_out_of_memory;
+  }
+
+  return cgltf_result_success;
+}
+
+void cgltf_vrm_animation_sampler_free(cgltf_vrm_animation_sampler* sampler)
+{
+  if (!sampler || !sampler->memory.free_func)
+  {
+    return;
+  }
+
+  sampler->memory.free_func(sampler->memory.user_data, sampler->cursors);
+  sampler->memory.free_func(sampler->memory.user_data, sampler->scratch);
+  sampler->memory.free_func(sampler->memory.user_data, sampler->expression_weights);
+
+  sampler->cursors = NULL;
+  sampler->scratch = NULL;
+  sampler->expression_weights = NULL;
+}
+
+/* Largest key in [lo, hi] whose time is <= `time`, times[lo] <= time is assumed. */
+static
+cgltf_size cgltf_vrm_animation_search_key(cgltf_float const* times, cgltf_size lo, cgltf_size hi, cgltf_float time)
+{
+  while (lo < hi)
+  {
+    cgltf_size mid = lo + (hi - lo + 1) / 2;
+    if (times[mid] <= time)
+    {
+      lo = mid;
+    }
+    else
+    {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
+
+#define CGLTF_VRM_ANIMATION_CURSOR_STEPS 4
+
+/* Finds the keys around `time` starting from the cached cursor, returns the interpolation factor. */
+static
+cgltf_float cgltf_vrm_animation_find_keys(cgltf_vrm_animation_track const* track, cgltf_float time, cgltf_size* cursor, cgltf_size* k0, cgltf_size* k1)
+{
+  cgltf_float const* times = track->times;
+  cgltf_size last = track->keys_count - 1;
+  cgltf_size k = *cursor;
+
+  if (track->keys_count < 2 || time <= times[0])
+  {
+    *k0 = *k1 = 0;
+    *cursor = 0;
+    return 0.0f;
+  }
+  if (time >= times[last])
+  {
+    *k0 = *k1 = last;
+    *cursor = last - 1;
+    return 0.0f;
+  }
+
+  if (k >= last)
+  {
+    k = last - 1;
+  }
+
+  if (times[k] <= time)
+  {
+    int steps = 0;
+    while (times[k + 1] <= time && steps < CGLTF_VRM_ANIMATION_CURSOR_STEPS)
+    {
+      ++k;
+      ++steps;
+    }
+    if (times[k + 1] <= time)
+    {
+      k = cgltf_vrm_animation_search_key(times, k + 1, last - 1, time);
+    }
+  }
+  else
+  {
+    k = cgltf_vrm_animation_search_key(times, 0, k - 1, time);
+  }
+
+  *cursor = k;
+  *k0 = k;
+  *k1 = k + 1;
+
+  cgltf_float span = times[k + 1] - times[k];
+  return (span > 0.0f) ? (time - times[k]) / span : 0.0f;
+}
+
+#undef CGLTF_VRM_ANIMATION_CURSOR_STEPS
+
+/* Shortest path slerp of `count` quaternion pairs stored as separate component arrays, result in a.
+ * Branch free so that compilers can vectorize the loop. */
+static
+void cgltf_vrm_quat_slerp_batch(cgltf_size count, cgltf_float const* u, cgltf_float** a, cgltf_float* const* b)
+{
+  cgltf_float* ax = a[0]; cgltf_float* ay = a[1]; cgltf_float* az = a[2]; cgltf_float* aw = a[3];
+  cgltf_float const* bx = b[0]; cgltf_float const* by = b[1]; cgltf_float const* bz = b[2]; cgltf_float const* bw = b[3];
+
+  for (cgltf_size i = 0; i < count; ++i)
+  {
+    cgltf_float d = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i] + aw[i] * bw[i];
+    cgltf_float sign = (d < 0.0f) ? -1.0f : 1.0f;
+    d = fminf(d * sign, 1.0f);
+
+    cgltf_float near_equal = (d > 0.9995f) ? 1.0f : 0.0f;
+    cgltf_float theta = acosf(d);
+    cgltf_float inv_sin = 1.0f / ((near_equal > 0.0f) ? 1.0f : sinf(theta));
+    cgltf_float w0 = near_equal * (1.0f - u[i]) + (1.0f - near_equal) * sinf((1.0f - u[i]) * theta) * inv_sin;
+    cgltf_float w1 = (near_equal * u[i] + (1.0f - near_equal) * sinf(u[i] * theta) * inv_sin) * sign;
+
+    cgltf_float x = w0 * ax[i] + w1 * bx[i];
+    cgltf_float y = w0 * ay[i] + w1 * by[i];
+    cgltf_float z = w0 * az[i] + w1 * bz[i];
+    cgltf_float w = w0 * aw[i] + w1 * bw[i];
+    cgltf_float length = sqrtf(x * x + y * y + z * z + w * w);
+    cgltf_float inv_length = (length > 0.0f) ? 1.0f / length : 0.0f;
+
+    ax[i] = x * inv_length;
+    ay[i] = y * inv_length;
+    az[i] = z * inv_length;
+    aw[i] = w * inv_length + ((length > 0.0f) ? 0.0f : 1.0f);
+  }
+}
+
+static
+void cgltf_vrm_lerp_batch(cgltf_size count, cgltf_float const* u, cgltf_float* a, cgltf_float const* b)
+{
+  for (cgltf_size i = 0; i < count; ++i)
+  {
+    a[i] += (b[i] - a[i]) * u[i];
+  }
+}
+
+void cgltf_vrm_animation_sampler_sample(cgltf_vrm_animation_sampler* sampler, cgltf_float time)
+{
+  cgltf_vrm_animation_clip const* clip = sampler->clip;
+  cgltf_size n = clip->tracks_count;
+  cgltf_size r = clip->rotation_tracks_count;
+  cgltf_float* u = sampler->scratch;
+  cgltf_float* a[4];
+  cgltf_float* b[4];
+
+  if (n == 0)
+  {
+    return;
+  }
+
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_animation_sampler_sample");
+  for (int c = 0; c < 4; ++c)
+  {
+    a[c] = sampler->scratch + n * (1 + c);
+    b[c] = sampler->scratch + n * (5 + c);
+  }
+
+  /* Key search and gather, cubic splines are evaluated here with u = 0 for the batch. */
+  for (cgltf_size t = 0; t < n; ++t)
+  {
+    cgltf_vrm_animation_track const* track = &clip->tracks[t];
+    cgltf_size keys = track->keys_count;
+    cgltf_size k0, k1;
+    cgltf_float f = cgltf_vrm_animation_find_keys(track, time, &sampler->cursors[t], &k0, &k1);
+
+    for (cgltf_size c = 0; c < 4; ++c)
+    {
+      a[c][t] = b[c][t] = 0.0f;
+    }
+
+    if (track->interpolation == cgltf_interpolation_type_cubic_spline)
+    {
+      cgltf_size comps = track->components;
+      cgltf_float dt = track->times[k1] - track->times[k0];
+      cgltf_float f2 = f * f;
+      cgltf_float f3 = f2 * f;
+      cgltf_float h00 = 2.0f * f3 - 3.0f * f2 + 1.0f;
+      cgltf_float h10 = (f3 - 2.0f * f2 + f) * dt;
+      cgltf_float h01 = -2.0f * f3 + 3.0f * f2;
+      cgltf_float h11 = (f3 - f2) * dt;
+
+      for (cgltf_size c = 0; c < comps; ++c)
+      {
+        cgltf_float const* in_tangents = track->values + c * keys;
+        cgltf_float const* values = track->values + (comps + c) * keys;
+        cgltf_float const* out_tangents = track->values + (2 * comps + c) * keys;
+        a[c][t] = b[c][t] = h00 * values[k0] + h10 * out_tangents[k0] + h01 * values[k1] + h11 * in_tangents[k1];
+      }
+      u[t] = 0.0f;
+    }
+    else
+    {
+      cgltf_size kb = (track->interpolation == cgltf_interpolation_type_step) ? k0 : k1;
+      for (cgltf_size c = 0; c < track->components; ++c)
+      {
+        a[c][t] = track->values[c * keys + k0];
+        b[c][t] = track->values[c * keys + kb];
+      }
+      u[t] = (track->interpolation == cgltf_interpolation_type_step) ? 0.0f : f;
+    }
+  }
+
+  /* Batched interpolation : slerp for the rotations, lerp for everything else. */
+  cgltf_vrm_quat_slerp_batch(r, u, a, b);
+  for (int c = 0; c < 3; ++c)
+  {
+    cgltf_vrm_lerp_batch(n - r, u + r, a[c] + r, b[c] + r);
+  }
+
+  /* Scatter */
+  for (cgltf_size t = 0; t < n; ++t)
+  {
+    cgltf_vrm_animation_track const* track = &clip->tracks[t];
+
+    switch (track->target)
+    {
+      case cgltf_vrm_animation_track_target_bone_rotation:
+        for (int c = 0; c < 4; ++c)
+        {
+          sampler->bone_rotations[track->index][c] = a[c][t];
+        }
+        break;
+
+      case cgltf_vrm_animation_track_target_look_at_rotation:
+        for (int c = 0; c < 4; ++c)
+        {
+          sampler->look_at_rotation[c] = a[c][t];
+        }
+        break;
+
+      case cgltf_vrm_animation_track_target_hips_translation:
+        for (int c = 0; c < 3; ++c)
+        {
+          sampler->hips_translation[c] = a[c][t];
+        }
+        break;
+
+      case cgltf_vrm_animation_track_target_expression:
+        sampler->expression_weights[track->index] = a[0][t];
+        break;
+
+      default:
+        break;
+    }
+  }
+  CGLTF_VRM_PROFILE_END(NULL, zone);
+}
+
+/* ----------- Spring bone collision ----------- */
+
+cgltf_result cgltf_vrm_spring_bone_collider_set_init(cgltf_options const* options, cgltf_vrm_spring_bone const* spring_bone, cgltf_vrm_spring_bone_collider_set* set)
+{
+  cgltf_options fixed_options;
+
+  if (options == NULL || spring_bone == NULL || set == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
+
+  memset(set, 0, sizeof(cgltf_vrm_spring_bone_collider_set));
+  set->memory = fixed_options.memory;
+  set->colliders_count = spring_bone->colliders_count;
+
+  if (set->colliders_count == 0)
+  {
+    return cgltf_result_success;
+  }
+
+  set->storage = (cgltf_float*)cgltf_calloc(&fixed_options, sizeof(cgltf_float), set->colliders_count * 9);
+  if (!set->storage)
+  {
+    return cgltf_result_out_of_memory;
+  }
+
+  for (int c = 0; c < 3; ++c)
+  {
+    set->head[c] = set->storage + set->colliders_count * c;
+    set->tail[c] = set->storage + set->colliders_count * (3 + c);
+  }
+  set->radius = set->storage + set->colliders_count * 6;
+  set->sign = set->storage + set->colliders_count * 7;
+  set->plane = set->storage + set->colliders_count * 8;
+
+  for (cgltf_size i = 0; i < set->colliders_count; ++i)
+  {
+    cgltf_vrm_spring_bone_collider const* collider = &spring_bone->colliders[i];
+    cgltf_bool is_plane = (collider->shape == cgltf_vrm_spring_bone_collider_shape_plane);
+
+    set->sign[i] = (collider->inside && !is_plane) ? -1.0f : 1.0f;
+    set->plane[i] = is_plane ? 1.0f : 0.0f;
+    set->radius[i] = is_plane ? 0.0f : collider->radius;
+  }
+
+  return cgltf_result_success;
+}
+
+static
+void cgltf_vrm_transform_point(cgltf_float const* m, cgltf_float const* p, cgltf_float* out)
+{
+  for (int r = 0; r < 3; ++r)
+  {
+    out[r] = m[r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+  }
+}
+
+void cgltf_vrm_spring_bone_collider_set_update(cgltf_vrm_spring_bone_collider_set* set, cgltf_data const* gltf, cgltf_vrm_spring_bone const* spring_bone, cgltf_float const* world_matrices)
+{
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_spring_bone_collider_set_update");
+  for (cgltf_size i = 0; i < set->colliders_count; ++i)
+  {
+    cgltf_vrm_spring_bone_collider const* collider = &spring_bone->colliders[i];
+    cgltf_float local[16];
+    cgltf_float const* m = local;
+    cgltf_float head[3];
+    cgltf_float tail[3];
+
+    if (collider->node == NULL)
+    {
+      memset(local, 0, sizeof(local));
+      local[0] = local[5] = local[10] = local[15] = 1.0f;
+    }
+    else if (world_matrices != NULL)
+    {
+      m = world_matrices + 16 * (collider->node - gltf->nodes);
+    }
+    else
+    {
+      cgltf_node_transform_world(collider->node, local);
+    }
+
+    cgltf_vrm_transform_point(m, collider->offset, head);
+
+    if (collider->shape == cgltf_vrm_spring_bone_collider_shape_plane)
+    {
+      for (int r = 0; r < 3; ++r)
+      {
+        tail[r] = m[r] * collider->normal[0] + m[4 + r] * collider->normal[1] + m[8 + r] * collider->normal[2];
       }
-      for (cgltf_size k = 0; k < out->authors_count; ++k)
+      cgltf_float length = sqrtf(tail[0] * tail[0] + tail[1] * tail[1] + tail[2] * tail[2]);
+      for (int r = 0; r < 3; ++r)
+      {
+        tail[r] = (length > 0.0f) ? tail[r] / length : 0.0f;
+      }
+    }
+    else if (collider->shape == cgltf_vrm_spring_bone_collider_shape_capsule)
+    {
+      cgltf_vrm_transform_point(m, collider->tail, tail);
+    }
+    else
+    {
+      memcpy(tail, head, sizeof(tail));
+    }
+
+    /* Radii follow the largest axis scale. */
+    cgltf_float scale = 0.0f;
+    for (int c = 0; c < 3; ++c)
+    {
+      cgltf_float axis = sqrtf(m[4 * c] * m[4 * c] + m[4 * c + 1] * m[4 * c + 1] + m[4 * c + 2] * m[4 * c + 2]);
+      scale = (axis > scale) ? axis : scale;
+    }
+
+    for (int c = 0; c < 3; ++c)
+    {
+      set->head[c][i] = head[c];
+      set->tail[c][i] = tail[c];
+    }
+    set->radius[i] = (collider->shape == cgltf_vrm_spring_bone_collider_shape_plane) ? 0.0f : collider->radius * scale;
+  }
+  CGLTF_VRM_PROFILE_END(NULL, zone);
+}
+
+/* Colliders are applied one after the other, the inner loop over joints is branch free so that
+ * compilers can vectorize it. Every shape goes through the same code :
+ *   capsules project on their segment (of length 0 for spheres), the penetration is
+ *   sign * (radius - distance) + joint radius along sign * direction,
+ *   planes use joint radius - signed distance along their normal. */
+cgltf_size cgltf_vrm_spring_bone_collide(cgltf_vrm_spring_bone_collider_set const* set, cgltf_int const* colliders, cgltf_size colliders_count, cgltf_size count, cgltf_float* x, cgltf_float* y, cgltf_float* z, cgltf_float const* radius)
+{
+  cgltf_size contacts = 0;
+
+  for (cgltf_size k = 0; k < colliders_count; ++k)
+  {
+    cgltf_size c = (cgltf_size)colliders[k];
+
+    if (colliders[k] < 0 || c >= set->colliders_count)
+    {
+      continue;
+    }
+
+    cgltf_float hx = set->head[0][c], hy = set->head[1][c], hz = set->head[2][c];
+    cgltf_float tx = set->tail[0][c], ty = set->tail[1][c], tz = set->tail[2][c];
+    cgltf_float plane = set->plane[c];
+    cgltf_float segment = 1.0f - plane;
+    cgltf_float sign = set->sign[c];
+    cgltf_float collider_radius = set->radius[c];
+
+    cgltf_float ax = (tx - hx) * segment, ay = (ty - hy) * segment, az = (tz - hz) * segment;
+    cgltf_float length2 = ax * ax + ay * ay + az * az;
+    cgltf_float inv_length2 = (length2 > 0.0f) ? 1.0f / length2 : 0.0f;
+
+    for (cgltf_size i = 0; i < count; ++i)
+    {
+      cgltf_float px = x[i] - hx, py = y[i] - hy, pz = z[i] - hz;
+
+      /* sphere / capsule */
+      cgltf_float t = fminf(fmaxf((px * ax + py * ay + pz * az) * inv_length2, 0.0f), 1.0f);
+      cgltf_float dx = px - ax * t, dy = py - ay * t, dz = pz - az * t;
+      cgltf_float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+      cgltf_float inv_distance = (distance > 0.0f) ? 1.0f / distance : 0.0f;
+
+      /* plane, the normal is in tail */
+      cgltf_float plane_distance = px * tx + py * ty + pz * tz;
+
+      cgltf_float depth = plane * (radius[i] - plane_distance) + segment * (sign * (collider_radius - distance) + radius[i]);
+      cgltf_float nx = plane * tx + segment * sign * dx * inv_distance;
+      cgltf_float ny = plane * ty + segment * sign * dy * inv_distance;
+      cgltf_float nz = plane * tz + segment * sign * dz * inv_distance;
+      cgltf_float push = (depth > 0.0f) ? depth : 0.0f;
+
+      x[i] += nx * push;
+      y[i] += ny * push;
+      z[i] += nz * push;
+      contacts += (depth > 0.0f);
+    }
+  }
+
+  return contacts;
+}
+
+void cgltf_vrm_spring_bone_collider_set_free(cgltf_vrm_spring_bone_collider_set* set)
+{
+  if (!set || !set->memory.free_func)
+  {
+    return;
+  }
+
+  set->memory.free_func(set->memory.user_data, set->storage);
+  memset(set, 0, sizeof(cgltf_vrm_spring_bone_collider_set));
+}
+
+/* ----------- Expression table ----------- */
+
+static
+cgltf_vrm_expression_group cgltf_vrm_expression_preset_group(char const* name)
+{
+  static char const* const blink[] = { "blink", "blinkLeft", "blinkRight" };
+  static char const* const look_at[] = { "lookUp", "lookDown", "lookLeft", "lookRight" };
+  static char const* const mouth[] = { "aa", "ih", "ou", "ee", "oh" };
+
+  for (int i = 0; name && i < 3; ++i)
+  {
+    if (strcmp(name, blink[i]) == 0) return cgltf_vrm_expression_group_blink;
+  }
+  for (int i = 0; name && i < 4; ++i)
+  {
+    if (strcmp(name, look_at[i]) == 0) return cgltf_vrm_expression_group_look_at;
+  }
+  for (int i = 0; name && i < 5; ++i)
+  {
+    if (strcmp(name, mouth[i]) == 0) return cgltf_vrm_expression_group_mouth;
+  }
+  return cgltf_vrm_expression_group_none;
+}
+
+static
+int cgltf_vrm_compare_morph_targets(void const* a, void const* b)
+{
+  cgltf_vrm_expression_morph_target const* ta = (cgltf_vrm_expression_morph_target const*)a;
+  cgltf_vrm_expression_morph_target const* tb = (cgltf_vrm_expression_morph_target const*)b;
+
+  if (ta->node != tb->node)
+  {
+    return (ta->node < tb->node) ? -1 : 1;
+  }
+  return (ta->index < tb->index) ? -1 : (ta->index > tb->index);
+}
+
+static
+cgltf_uint cgltf_vrm_expression_table_find_target(cgltf_vrm_expression_table const* table, cgltf_vrm_expression_morph_target const* key)
+{
+  cgltf_size lo = 0;
+  cgltf_size hi = table->morph_targets_count;
+
+  while (lo < hi)
+  {
+    cgltf_size mid = (lo + hi) / 2;
+    if (cgltf_vrm_compare_morph_targets(&table->morph_targets[mid], key) < 0)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return (cgltf_uint)lo;
+}
+
+static
+int cgltf_vrm_compare_uints(void const* a, void const* b)
+{
+  cgltf_uint ua = *(cgltf_uint const*)a;
+  cgltf_uint ub = *(cgltf_uint const*)b;
+  return (ua < ub) ? -1 : (ua > ub);
+}
+
+static
+cgltf_uint cgltf_vrm_expression_table_find_material(cgltf_vrm_expression_table const* table, cgltf_uint material)
+{
+  cgltf_size lo = 0;
+  cgltf_size hi = table->materials_count;
+
+  while (lo < hi)
+  {
+    cgltf_size mid = (lo + hi) / 2;
+    if (table->materials[mid] < material)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return (cgltf_uint)lo;
+}
+
+/* Current value of the material parameter a color bind targets, 0 when the material has none. */
+static
+void cgltf_vrm_material_color_value(cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_size material, cgltf_vrm_expression_material_color_bind_type type, cgltf_float* out)
+{
+  cgltf_material const* base = &gltf->materials[material];
+  cgltf_vrm_mtoon const* mtoon = NULL;
+  cgltf_float const* rgb = NULL;
+
+  memset(out, 0, sizeof(cgltf_float) * 4);
+
+  if (material < vrm->extended_materials_count && vrm->extended_materials[material].has_mtoon)
+  {
+    mtoon = &vrm->extended_materials[material].mtoon;
+  }
+
+  switch (type)
+  {
+    case cgltf_vrm_expression_material_color_bind_type_color:
+      memcpy(out, base->pbr_metallic_roughness.base_color_factor, sizeof(cgltf_float) * 4);
+      return;
+    case cgltf_vrm_expression_material_color_bind_type_emission_color:
+      rgb = base->emissive_factor;
+      break;
+    case cgltf_vrm_expression_material_color_bind_type_shade_color:
+      rgb = mtoon ? mtoon->shade_color_factor : NULL;
+      break;
+    case cgltf_vrm_expression_material_color_bind_type_matcap_color:
+      rgb = mtoon ? mtoon->matcap_factor : NULL;
+      break;
+    case cgltf_vrm_expression_material_color_bind_type_rim_color:
+      rgb = mtoon ? mtoon->parametric_rim_color_factor : NULL;
+      break;
+    case cgltf_vrm_expression_material_color_bind_type_outline_color:
+      rgb = mtoon ? mtoon->outline_color_factor : NULL;
+      break;
+    default:
+      break;
+  }
+
+  if (rgb)
+  {
+    memcpy(out, rgb, sizeof(cgltf_float) * 3);
+  }
+}
+
+static
+cgltf_vrm_expression const* cgltf_vrm_expression_table_source(cgltf_vrm_data const* vrm, cgltf_size i)
+{
+  cgltf_vrm_expressions const* expressions = &vrm->core.expressions;
+  return (i < expressions->preset_count) ? &expressions->preset[i] : &expressions->custom[i - expressions->preset_count];
+}
+
+cgltf_result cgltf_vrm_expression_table_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_expression_table* table)
+{
+  cgltf_options fixed_options;
+  cgltf_vrm_expressions const* expressions;
+  cgltf_size morph_count = 0;
+  cgltf_size color_count = 0;
+  cgltf_size texture_count = 0;
+
+  if (options == NULL || gltf == NULL || vrm == NULL || table == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
+
+  memset(table, 0, sizeof(cgltf_vrm_expression_table));
+  table->memory = fixed_options.memory;
+
+  expressions = &vrm->core.expressions;
+  table->entries_count = expressions->preset_count + expressions->custom_count;
+  if (table->entries_count == 0)
+  {
+    return cgltf_result_success;
+  }
+
+  for (cgltf_size i = 0; i < table->entries_count; ++i)
+  {
+    cgltf_vrm_expression const* expression = cgltf_vrm_expression_table_source(vrm, i);
+    for (cgltf_size j = 0; j < expression->morph_target_binds_count; ++j)
+    {
+      morph_count += (expression->morph_target_binds[j].node != NULL);
+    }
+    for (cgltf_size j = 0; j < expression->material_color_binds_count; ++j)
+    {
+      color_count += (expression->material_color_binds[j].material != NULL)
+        && (expression->material_color_binds[j].type != cgltf_vrm_expression_material_color_bind_type_max_enum);
+    }
+    for (cgltf_size j = 0; j < expression->texture_transform_binds_count; ++j)
+    {
+      texture_count += (expression->texture_transform_binds[j].material != NULL);
+    }
+  }
+
+  table->entries = (cgltf_vrm_expression_table_entry*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_expression_table_entry), table->entries_count);
+  table->names = (char const**)cgltf_calloc(&fixed_options, sizeof(char const*), table->entries_count);
+  table->morph_targets = (cgltf_vrm_expression_morph_target*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_expression_morph_target), morph_count + 1);
+  table->morph_binds = (cgltf_vrm_expression_table_morph_bind*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_expression_table_morph_bind), morph_count + 1);
+  table->material_color_binds = (cgltf_vrm_expression_table_material_color_bind*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_expression_table_material_color_bind), color_count + 1);
+  table->texture_transform_binds = (cgltf_vrm_expression_table_texture_transform_bind*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_expression_table_texture_transform_bind), texture_count + 1);
+  table->materials = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), color_count + texture_count + 1);
+
+  if (!table->entries || !table->names || !table->morph_targets || !table->morph_binds || !table->material_color_binds || !table->texture_transform_binds || !table->materials)
+  {
+    cgltf_vrm_expression_table_free(table);
+    return cgltf_result_out_of_memory;
+  }
+
+  /* Unique morph targets, sorted. */
+  for (cgltf_size i = 0; i < table->entries_count; ++i)
+  {
+    cgltf_vrm_expression const* expression = cgltf_vrm_expression_table_source(vrm, i);
+    for (cgltf_size j = 0; j < expression->morph_target_binds_count; ++j)
+    {
+      if (expression->morph_target_binds[j].node != NULL)
+      {
+        table->morph_targets[table->morph_targets_count].node = expression->morph_target_binds[j].node;
+        table->morph_targets[table->morph_targets_count].index = expression->morph_target_binds[j].index;
+        table->morph_targets_count += 1;
+      }
+    }
+  }
+  qsort(table->morph_targets, table->morph_targets_count, sizeof(cgltf_vrm_expression_morph_target), cgltf_vrm_compare_morph_targets);
+  {
+    cgltf_size unique = 0;
+    for (cgltf_size i = 0; i < table->morph_targets_count; ++i)
+    {
+      if (unique == 0 || cgltf_vrm_compare_morph_targets(&table->morph_targets[unique - 1], &table->morph_targets[i]) != 0)
+      {
+        table->morph_targets[unique++] = table->morph_targets[i];
+      }
+    }
+    table->morph_targets_count = unique;
+  }
+
+  /* Unique bound materials, sorted. */
+  for (cgltf_size i = 0; i < table->entries_count; ++i)
+  {
+    cgltf_vrm_expression const* expression = cgltf_vrm_expression_table_source(vrm, i);
+    for (cgltf_size j = 0; j < expression->material_color_binds_count; ++j)
+    {
+      cgltf_vrm_expression_material_color_bind const* bind = &expression->material_color_binds[j];
+      if (bind->material != NULL && bind->type != cgltf_vrm_expression_material_color_bind_type_max_enum)
+      {
+        table->materials[table->materials_count++] = (cgltf_uint)(bind->material - gltf->materials);
+      }
+    }
+    for (cgltf_size j = 0; j < expression->texture_transform_binds_count; ++j)
+    {
+      if (expression->texture_transform_binds[j].material != NULL)
+      {
+        table->materials[table->materials_count++] = (cgltf_uint)(expression->texture_transform_binds[j].material - gltf->materials);
+      }
+    }
+  }
+  qsort(table->materials, table->materials_count, sizeof(cgltf_uint), cgltf_vrm_compare_uints);
+  {
+    cgltf_size unique = 0;
+    for (cgltf_size i = 0; i < table->materials_count; ++i)
+    {
+      if (unique == 0 || table->materials[unique - 1] != table->materials[i])
+      {
+        table->materials[unique++] = table->materials[i];
+      }
+    }
+    table->materials_count = unique;
+  }
+
+  for (cgltf_size i = 0; i < table->entries_count; ++i)
+  {
+    cgltf_vrm_expression const* expression = cgltf_vrm_expression_table_source(vrm, i);
+    cgltf_vrm_expression_table_entry* entry = &table->entries[i];
+
+    table->names[i] = expression->name;
+    entry->is_binary = (uint8_t)(expression->is_binary != 0);
+    entry->group = (uint8_t)((i < expressions->preset_count) ? cgltf_vrm_expression_preset_group(expression->name) : cgltf_vrm_expression_group_none);
+    entry->override_blink = (uint8_t)expression->override_blink;
+    entry->override_look_at = (uint8_t)expression->override_look_at;
+    entry->override_mouth = (uint8_t)expression->override_mouth;
+
+    /* Morph binds, insertion sorted by target as ranges are short. */
+    entry->morph_binds_offset = (cgltf_uint)table->morph_binds_count;
+    for (cgltf_size j = 0; j < expression->morph_target_binds_count; ++j)
+    {
+      cgltf_vrm_expression_morph_target_bind const* source = &expression->morph_target_binds[j];
+      cgltf_vrm_expression_morph_target key;
+      cgltf_vrm_expression_table_morph_bind bind;
+
+      if (source->node == NULL)
+      {
+        continue;
+      }
+
+      key.node = source->node;
+      key.index = source->index;
+      bind.target = cgltf_vrm_expression_table_find_target(table, &key);
+      bind.weight = source->weight;
+
+      cgltf_size k = table->morph_binds_count;
+      while (k > entry->morph_binds_offset && table->morph_binds[k - 1].target > bind.target)
+      {
+        table->morph_binds[k] = table->morph_binds[k - 1];
+        --k;
+      }
+      table->morph_binds[k] = bind;
+      table->morph_binds_count += 1;
+    }
+    entry->morph_binds_count = (cgltf_uint)table->morph_binds_count - entry->morph_binds_offset;
+
+    entry->material_color_binds_offset = (cgltf_uint)table->material_color_binds_count;
+    for (cgltf_size j = 0; j < expression->material_color_binds_count; ++j)
+    {
+      cgltf_vrm_expression_material_color_bind const* source = &expression->material_color_binds[j];
+      cgltf_vrm_expression_table_material_color_bind* bind = &table->material_color_binds[table->material_color_binds_count];
+
+      if (source->material == NULL || source->type == cgltf_vrm_expression_material_color_bind_type_max_enum)
+      {
+        continue;
+      }
+
+      cgltf_size material = (cgltf_size)(source->material - gltf->materials);
+      cgltf_float value[4];
+      cgltf_vrm_material_color_value(gltf, vrm, material, source->type, value);
+
+      bind->material = cgltf_vrm_expression_table_find_material(table, (cgltf_uint)material);
+      bind->type = source->type;
+      memcpy(bind->target_value, source->target_value, sizeof(bind->target_value));
+      for (int c = 0; c < 4; ++c)
+      {
+        bind->delta[c] = bind->target_value[c] - value[c];
+      }
+      if (source->type != cgltf_vrm_expression_material_color_bind_type_color)
+      {
+        bind->delta[3] = 0.0f; /* rgb only */
+      }
+      table->material_color_binds_count += 1;
+    }
+    entry->material_color_binds_count = (cgltf_uint)table->material_color_binds_count - entry->material_color_binds_offset;
+
+    entry->texture_transform_binds_offset = (cgltf_uint)table->texture_transform_binds_count;
+    for (cgltf_size j = 0; j < expression->texture_transform_binds_count; ++j)
+    {
+      cgltf_vrm_expression_texture_transform_bind const* source = &expression->texture_transform_binds[j];
+      cgltf_vrm_expression_table_texture_transform_bind* bind = &table->texture_transform_binds[table->texture_transform_binds_count];
+
+      if (source->material == NULL)
+      {
+        continue;
+      }
+
+      bind->material = cgltf_vrm_expression_table_find_material(table, (cgltf_uint)(source->material - gltf->materials));
+      memcpy(bind->scale, source->scale, sizeof(bind->scale));
+      memcpy(bind->offset, source->offset, sizeof(bind->offset));
+      table->texture_transform_binds_count += 1;
+    }
+    entry->texture_transform_binds_count = (cgltf_uint)table->texture_transform_binds_count - entry->texture_transform_binds_offset;
+  }
+
+  return cgltf_result_success;
+}
+
+void cgltf_vrm_expression_table_resolve_weights(cgltf_vrm_expression_table const* table, cgltf_float const* weights, cgltf_float* out_weights)
+{
+  /* Multipliers of the procedural groups, indexed by cgltf_vrm_expression_group. */
+  cgltf_float multipliers[cgltf_vrm_expression_group_max_enum] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_expression_table_resolve_weights");
+  for (cgltf_size i = 0; i < table->entries_count; ++i)
+  {
+    cgltf_vrm_expression_table_entry const* entry = &table->entries[i];
+    cgltf_float w = weights[i];
+
+    w = (w < 0.0f) ? 0.0f : ((w > 1.0f) ? 1.0f : w);
+    if (entry->is_binary)
+    {
+      w = (w > 0.5f) ? 1.0f : 0.0f;
+    }
+    out_weights[i] = w;
+
+    uint8_t const overrides[3] = { entry->override_blink, entry->override_look_at, entry->override_mouth };
+    for (int g = 0; g < 3; ++g)
+    {
+      cgltf_float m = 1.0f;
+      if (overrides[g] == cgltf_vrm_expression_override_type_block)
+      {
+        m = (w > 0.0f) ? 0.0f : 1.0f;
+      }
+      else if (overrides[g] == cgltf_vrm_expression_override_type_blend)
       {
-        i = cgltf_parse_json_string(options, tokens, i, json_chunk, &out->authors[k]);
-        if (i < 0)
-        {
-          return i;
-        }
+        m = 1.0f - w;
       }
+      multipliers[g + 1] = (m < multipliers[g + 1]) ? m : multipliers[g + 1];
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "thumbnailImage") == 0)
+  }
+
+  for (cgltf_size i = 0; i < table->entries_count; ++i)
+  {
+    out_weights[i] *= multipliers[table->entries[i].group];
+  }
+  CGLTF_VRM_PROFILE_END(NULL, zone);
+}
+
+void cgltf_vrm_expression_table_evaluate_morphs(cgltf_vrm_expression_table const* table, cgltf_float const* weights, cgltf_float* out_morph_weights)
+{
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_expression_table_evaluate_morphs");
+  memset(out_morph_weights, 0, sizeof(cgltf_float) * table->morph_targets_count);
+
+  for (cgltf_size i = 0; i < table->entries_count; ++i)
+  {
+    cgltf_vrm_expression_table_entry const* entry = &table->entries[i];
+    cgltf_vrm_expression_table_morph_bind const* binds = table->morph_binds + entry->morph_binds_offset;
+    cgltf_float w = weights[i];
+
+    if (w == 0.0f)
     {
-      out->has_thumbnail_image = 1;
-      ++i;
-      out->thumbnail_image = CGLTF_PTRINDEX(cgltf_image, cgltf_json_to_int(tokens + i, json_chunk));
-      ++i;
+      continue;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "version") == 0)
+
+    for (cgltf_uint j = 0; j < entry->morph_binds_count; ++j)
     {
-      i = cgltf_parse_json_string(options, tokens, i + 1, json_chunk, &out->version);
+      out_morph_weights[binds[j].target] += binds[j].weight * w;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "copyrightInformation") == 0)
+  }
+  CGLTF_VRM_PROFILE_END(NULL, zone);
+}
+
+void cgltf_vrm_expression_table_free(cgltf_vrm_expression_table* table)
+{
+  if (!table || !table->memory.free_func)
+  {
+    return;
+  }
+
+  table->memory.free_func(table->memory.user_data, table->entries);
+  table->memory.free_func(table->memory.user_data, (void*)table->names);
+  table->memory.free_func(table->memory.user_data, table->morph_targets);
+  table->memory.free_func(table->memory.user_data, table->morph_binds);
+  table->memory.free_func(table->memory.user_data, table->material_color_binds);
+  table->memory.free_func(table->memory.user_data, table->texture_transform_binds);
+  table->memory.free_func(table->memory.user_data, table->materials);
+
+  memset(table, 0, sizeof(cgltf_vrm_expression_table));
+}
+
+cgltf_result cgltf_vrm_material_delta_buffer_init(cgltf_vrm_material_delta_buffer* buffer, cgltf_vrm_expression_table const* table)
+{
+  cgltf_options options;
+
+  if (buffer == NULL || table == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  memset(buffer, 0, sizeof(cgltf_vrm_material_delta_buffer));
+  memset(&options, 0, sizeof(options));
+  options.memory = table->memory;
+  cgltf_vrm_fix_memory_options(&options);
+  buffer->memory = options.memory;
+
+  if (table->materials_count == 0)
+  {
+    return cgltf_result_success;
+  }
+
+  buffer->deltas = (cgltf_vrm_material_delta*)cgltf_calloc(&options, sizeof(cgltf_vrm_material_delta), table->materials_count);
+  buffer->slots = (cgltf_int*)cgltf_calloc(&options, sizeof(cgltf_int), table->materials_count);
+  if (!buffer->deltas || !buffer->slots)
+  {
+    cgltf_vrm_material_delta_buffer_free(buffer);
+    return cgltf_result_out_of_memory;
+  }
+
+  buffer->slots_count = table->materials_count;
+  for (cgltf_size i = 0; i < buffer->slots_count; ++i)
+  {
+    buffer->slots[i] = -1;
+  }
+
+  return cgltf_result_success;
+}
+
+static
+cgltf_vrm_material_delta* cgltf_vrm_material_delta_buffer_get(cgltf_vrm_material_delta_buffer* buffer, cgltf_vrm_expression_table const* table, cgltf_uint slot)
+{
+  if (buffer->slots[slot] < 0)
+  {
+    cgltf_vrm_material_delta* delta = &buffer->deltas[buffer->deltas_count];
+    memset(delta, 0, sizeof(cgltf_vrm_material_delta));
+    delta->material = table->materials[slot];
+    buffer->slots[slot] = (cgltf_int)buffer->deltas_count++;
+  }
+  return &buffer->deltas[buffer->slots[slot]];
+}
+
+void cgltf_vrm_expression_table_evaluate_materials(cgltf_vrm_expression_table const* table, cgltf_float const* weights, cgltf_vrm_material_delta_buffer* buffer)
+{
+  /* Only reset what the previous evaluation wrote. */
+  for (cgltf_size i = 0; i < buffer->deltas_count; ++i)
+  {
+    buffer->slots[cgltf_vrm_expression_table_find_material(table, buffer->deltas[i].material)] = -1;
+  }
+  buffer->deltas_count = 0;
+
+  if (buffer->slots_count < table->materials_count)
+  {
+    return;
+  }
+
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_expression_table_evaluate_materials");
+  for (cgltf_size i = 0; i < table->entries_count; ++i)
+  {
+    cgltf_vrm_expression_table_entry const* entry = &table->entries[i];
+    cgltf_float w = weights[i];
+
+    if (w == 0.0f)
     {
-      i = cgltf_parse_json_string(options, tokens, i + 1, json_chunk, &out->copyright_information);
+      continue;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "contactInformation") == 0)
+
+    for (cgltf_uint j = 0; j < entry->material_color_binds_count; ++j)
     {
-      i = cgltf_parse_json_string(options, tokens, i + 1, json_chunk, &out->contact_information);
+      cgltf_vrm_expression_table_material_color_bind const* bind = &table->material_color_binds[entry->material_color_binds_offset + j];
+      cgltf_vrm_material_delta* delta = cgltf_vrm_material_delta_buffer_get(buffer, table, bind->material);
+
+      delta->color_mask |= 1u << bind->type;
+      for (int c = 0; c < 4; ++c)
+      {
+        delta->colors[bind->type][c] += bind->delta[c] * w;
+      }
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "allowAntisocialOrHateUsage") == 0)
+
+    for (cgltf_uint j = 0; j < entry->texture_transform_binds_count; ++j)
     {
-      ++i;
-      out->allow_antisocial_or_hate_usage = cgltf_json_to_bool(tokens + i, json_chunk);
-      ++i;
+      cgltf_vrm_expression_table_texture_transform_bind const* bind = &table->texture_transform_binds[entry->texture_transform_binds_offset + j];
+      cgltf_vrm_material_delta* delta = cgltf_vrm_material_delta_buffer_get(buffer, table, bind->material);
+
+      delta->has_texture_transform = 1;
+      for (int c = 0; c < 2; ++c)
+      {
+        delta->uv_scale[c] += (bind->scale[c] - 1.0f) * w;
+        delta->uv_offset[c] += bind->offset[c] * w;
+      }
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "allowExcessivelySexualUsage") == 0)
+  }
+  CGLTF_VRM_PROFILE_END(NULL, zone);
+}
+
+void cgltf_vrm_material_delta_buffer_free(cgltf_vrm_material_delta_buffer* buffer)
+{
+  if (!buffer || !buffer->memory.free_func)
+  {
+    return;
+  }
+
+  buffer->memory.free_func(buffer->memory.user_data, buffer->deltas);
+  buffer->memory.free_func(buffer->memory.user_data, buffer->slots);
+  memset(buffer, 0, sizeof(cgltf_vrm_material_delta_buffer));
+}
+
+/* ----------- MToon parameter blocks ----------- */
+
+/* std140 alignment of the block array relies on a size multiple of 16 bytes. */
+typedef char cgltf_vrm_mtoon_block_size_check[(sizeof(cgltf_vrm_mtoon_block) % 16 == 0) ? 1 : -1];
+
+static
+cgltf_vrm_mtoon_texture_binding cgltf_vrm_mtoon_bind_texture(cgltf_data const* gltf, cgltf_int texture, cgltf_int tex_coord, cgltf_uint slot, cgltf_uint* mask)
+{
+  cgltf_vrm_mtoon_texture_binding binding;
+
+  binding.texture = -1;
+  binding.tex_coord = 0;
+  if (texture >= 0 && (cgltf_size)texture < gltf->textures_count)
+  {
+    binding.texture = texture;
+    binding.tex_coord = tex_coord;
+    *mask |= 1u << slot;
+  }
+  return binding;
+}
+
+static
+cgltf_int cgltf_vrm_texture_view_index(cgltf_data const* gltf, cgltf_texture_view const* view)
+{
+  return view->texture ? (cgltf_int)(view->texture - gltf->textures) : -1;
+}
+
+static
+void cgltf_vrm_mtoon_pack_block(cgltf_data const* gltf, cgltf_material const* material, cgltf_vrm_mtoon const* mtoon, cgltf_vrm_mtoon_block* block, cgltf_vrm_mtoon_texture_binding* textures)
+{
+  cgltf_float emissive_strength = material->has_emissive_strength ? material->emissive_strength.emissive_strength : 1.0f;
+  cgltf_vrm_mtoon_texture_binding bindings[cgltf_vrm_mtoon_texture_slot_max_enum];
+  cgltf_uint mask = 0;
+
+  memcpy(block->base_color_factor, material->pbr_metallic_roughness.base_color_factor, sizeof(block->base_color_factor));
+  memcpy(block->shade_color_factor, mtoon->shade_color_factor, sizeof(block->shade_color_factor));
+  block->shading_shift_factor = mtoon->shading_shift_factor;
+  for (int c = 0; c < 3; ++c)
+  {
+    block->emissive_factor[c] = material->emissive_factor[c] * emissive_strength;
+  }
+  block->shading_toony_factor = mtoon->shading_toony_factor;
+  memcpy(block->matcap_factor, mtoon->matcap_factor, sizeof(block->matcap_factor));
+  block->gi_equalization_factor = mtoon->gi_equalization_factor;
+  memcpy(block->parametric_rim_color_factor, mtoon->parametric_rim_color_factor, sizeof(block->parametric_rim_color_factor));
+  block->parametric_rim_fresnel_power_factor = mtoon->parametric_rim_fresnel_power_factor;
+  memcpy(block->outline_color_factor, mtoon->outline_color_factor, sizeof(block->outline_color_factor));
+  block->outline_width_factor = mtoon->outline_width_factor;
+
+  block->parametric_rim_lift_factor = mtoon->parametric_rim_lift_factor;
+  block->rim_lighting_mix_factor = mtoon->rim_lighting_mix_factor;
+  block->outline_lighting_mix_factor = mtoon->outline_lighting_mix_factor;
+  block->shading_shift_texture_scale = mtoon->shading_shift_texture.scale;
+
+  block->uv_animation_scroll_x_speed_factor = mtoon->uv_animation_scroll_x_speed_factor;
+  block->uv_animation_scroll_y_speed_factor = mtoon->uv_animation_scroll_y_speed_factor;
+  block->uv_animation_rotation_speed_factor = mtoon->uv_animation_rotation_speed_factor;
+  block->alpha_cutoff = material->alpha_cutoff;
+
+  block->outline_width_mode = (cgltf_uint)mtoon->outline_width_mode;
+  block->alpha_mode = (cgltf_uint)material->alpha_mode;
+  block->flags = (material->double_sided ? cgltf_vrm_mtoon_block_flag_double_sided : 0)
+    | (mtoon->transparent_with_z_write ? cgltf_vrm_mtoon_block_flag_transparent_with_z_write : 0)
+    | (material->unlit ? cgltf_vrm_mtoon_block_flag_unlit : 0);
+
+  bindings[cgltf_vrm_mtoon_texture_slot_base_color] = cgltf_vrm_mtoon_bind_texture(gltf, cgltf_vrm_texture_view_index(gltf, &material->pbr_metallic_roughness.base_color_texture),
+    material->pbr_metallic_roughness.base_color_texture.texcoord, cgltf_vrm_mtoon_texture_slot_base_color, &mask);
+  bindings[cgltf_vrm_mtoon_texture_slot_shade_multiply] = cgltf_vrm_mtoon_bind_texture(gltf, mtoon->shade_multiply_texture.index,
+    mtoon->shade_multiply_texture.tex_coord, cgltf_vrm_mtoon_texture_slot_shade_multiply, &mask);
+  bindings[cgltf_vrm_mtoon_texture_slot_shading_shift] = cgltf_vrm_mtoon_bind_texture(gltf, mtoon->shading_shift_texture.index,
+    mtoon->shading_shift_texture.tex_coord, cgltf_vrm_mtoon_texture_slot_shading_shift, &mask);
+  bindings[cgltf_vrm_mtoon_texture_slot_normal] = cgltf_vrm_mtoon_bind_texture(gltf, cgltf_vrm_texture_view_index(gltf, &material->normal_texture),
+    material->normal_texture.texcoord, cgltf_vrm_mtoon_texture_slot_normal, &mask);
+  bindings[cgltf_vrm_mtoon_texture_slot_emissive] = cgltf_vrm_mtoon_bind_texture(gltf, cgltf_vrm_texture_view_index(gltf, &material->emissive_texture),
+    material->emissive_texture.texcoord, cgltf_vrm_mtoon_texture_slot_emissive, &mask);
+  bindings[cgltf_vrm_mtoon_texture_slot_matcap] = cgltf_vrm_mtoon_bind_texture(gltf, mtoon->matcap_texture.index,
+    mtoon->matcap_texture.tex_coord, cgltf_vrm_mtoon_texture_slot_matcap, &mask);
+  bindings[cgltf_vrm_mtoon_texture_slot_rim_multiply] = cgltf_vrm_mtoon_bind_texture(gltf, mtoon->rim_multiply_texture.index,
+    mtoon->rim_multiply_texture.tex_coord, cgltf_vrm_mtoon_texture_slot_rim_multiply, &mask);
+  bindings[cgltf_vrm_mtoon_texture_slot_outline_width_multiply] = cgltf_vrm_mtoon_bind_texture(gltf, mtoon->outline_width_multiply_texture.index,
+    mtoon->outline_width_multiply_texture.tex_coord, cgltf_vrm_mtoon_texture_slot_outline_width_multiply, &mask);
+  bindings[cgltf_vrm_mtoon_texture_slot_uv_animation_mask] = cgltf_vrm_mtoon_bind_texture(gltf, mtoon->uv_animation_mask_texture.index,
+    mtoon->uv_animation_mask_texture.tex_coord, cgltf_vrm_mtoon_texture_slot_uv_animation_mask, &mask);
+
+  block->texture_mask = mask;
+  if (textures != NULL)
+  {
+    memcpy(textures, bindings, sizeof(bindings));
+  }
+}
+
+cgltf_size cgltf_vrm_mtoon_pack(cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_mtoon_block* out_blocks, cgltf_size blocks_count, cgltf_vrm_mtoon_texture_binding* out_textures, cgltf_uint* out_materials)
+{
+  cgltf_size count = 0;
+
+  for (cgltf_size i = 0; i < vrm->extended_materials_count && i < gltf->materials_count; ++i)
+  {
+    if (!vrm->extended_materials[i].has_mtoon)
     {
-      ++i;
-      out->allow_excessively_sexual_usage = cgltf_json_to_bool(tokens + i, json_chunk);
-      ++i;
+      continue;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "allowExcessivelyViolentUsage") == 0)
+
+    if (out_blocks != NULL)
     {
-      ++i;
-      out->allow_excessively_violent_usage = cgltf_json_to_bool(tokens + i, json_chunk);
-      ++i;
+      if (count >= blocks_count)
+      {
+        break;
+      }
+
+      cgltf_vrm_mtoon_pack_block(gltf, &gltf->materials[i], &vrm->extended_materials[i].mtoon, &out_blocks[count],
+        out_textures ? &out_textures[count * cgltf_vrm_mtoon_texture_slot_max_enum] : NULL);
+      if (out_materials != NULL)
+      {
+        out_materials[count] = (cgltf_uint)i;
+      }
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "allowPoliticalOrReligiousUsage") == 0)
+    ++count;
+  }
+
+  return count;
+}
+
+cgltf_uint cgltf_vrm_mtoon_feature_key(cgltf_data const* gltf, cgltf_material const* material, cgltf_vrm_mtoon const* mtoon)
+{
+  cgltf_vrm_mtoon_block block;
+  cgltf_uint key;
+
+  cgltf_vrm_mtoon_pack_block(gltf, material, mtoon, &block, NULL);
+
+  key = block.texture_mask;
+  if (block.outline_width_factor > 0.0f)
+  {
+    key |= (block.outline_width_mode == cgltf_vrm_mtoon_outline_width_mode_world_coordinates) ? cgltf_vrm_mtoon_feature_outline_world : 0;
+    key |= (block.outline_width_mode == cgltf_vrm_mtoon_outline_width_mode_screen_coordinates) ? cgltf_vrm_mtoon_feature_outline_screen : 0;
+  }
+  if (block.flags & cgltf_vrm_mtoon_block_flag_transparent_with_z_write)
+  {
+    key |= cgltf_vrm_mtoon_feature_transparent_with_z_write;
+  }
+  if ((block.parametric_rim_color_factor[0] != 0.0f) || (block.parametric_rim_color_factor[1] != 0.0f) || (block.parametric_rim_color_factor[2] != 0.0f))
+  {
+    key |= cgltf_vrm_mtoon_feature_rim;
+  }
+  if ((block.texture_mask & (1u << cgltf_vrm_mtoon_texture_slot_matcap))
+    && ((block.matcap_factor[0] != 0.0f) || (block.matcap_factor[1] != 0.0f) || (block.matcap_factor[2] != 0.0f)))
+  {
+    key |= cgltf_vrm_mtoon_feature_matcap;
+  }
+  if ((block.uv_animation_scroll_x_speed_factor != 0.0f) || (block.uv_animation_scroll_y_speed_factor != 0.0f) || (block.uv_animation_rotation_speed_factor != 0.0f))
+  {
+    key |= cgltf_vrm_mtoon_feature_uv_animation;
+  }
+  key |= (block.alpha_mode == cgltf_alpha_mode_mask) ? cgltf_vrm_mtoon_feature_alpha_mask : 0;
+  key |= (block.alpha_mode == cgltf_alpha_mode_blend) ? cgltf_vrm_mtoon_feature_alpha_blend : 0;
+  key |= (block.flags & cgltf_vrm_mtoon_block_flag_double_sided) ? cgltf_vrm_mtoon_feature_double_sided : 0;
+
+  return key;
+}
+
+static
+cgltf_uint cgltf_vrm_mtoon_cache_hash(cgltf_vrm_mtoon_block const* block, cgltf_vrm_mtoon_texture_binding const* textures)
+{
+  cgltf_uint hash = cgltf_vrm_hash_string((char const*)block, sizeof(cgltf_vrm_mtoon_block));
+  return hash ^ (cgltf_vrm_hash_string((char const*)textures, sizeof(cgltf_vrm_mtoon_texture_binding) * cgltf_vrm_mtoon_texture_slot_max_enum) * 31u);
+}
+
+static
+cgltf_size cgltf_vrm_mtoon_cache_probe(cgltf_vrm_mtoon_cache const* cache, cgltf_vrm_mtoon_block const* block, cgltf_vrm_mtoon_texture_binding const* textures, cgltf_uint hash)
+{
+  cgltf_size mask = cache->slots_count - 1;
+  cgltf_size slot = hash & mask;
+
+  for (;;)
+  {
+    cgltf_uint entry = cache->slots[slot];
+    if (entry == 0)
     {
-      ++i;
-      out->allow_political_or_religious_usage = cgltf_json_to_bool(tokens + i, json_chunk);
-      ++i;
+      return slot;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "avatarPermission") == 0)
+
+    cgltf_size index = entry - 1;
+    if ((cache->hashes[index] == hash)
+      && (memcmp(&cache->blocks[index], block, sizeof(cgltf_vrm_mtoon_block)) == 0)
+      && (memcmp(&cache->textures[index * cgltf_vrm_mtoon_texture_slot_max_enum], textures, sizeof(cgltf_vrm_mtoon_texture_binding) * cgltf_vrm_mtoon_texture_slot_max_enum) == 0))
     {
-      ++i;
-      out->avatar_permission = cgltf_vrm_string_to_meta_avatar_permission(tokens + i, json_chunk);
-      ++i;
+      return slot;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "commercialUsage") == 0)
+    slot = (slot + 1) & mask;
+  }
+}
+
+static
+cgltf_bool cgltf_vrm_mtoon_cache_grow(cgltf_vrm_mtoon_cache* cache)
+{
+  cgltf_memory_options* memory = &cache->memory;
+
+  /* Block arrays */
+  if (cache->blocks_count == cache->blocks_capacity)
+  {
+    cgltf_size capacity = (cache->blocks_capacity > 0) ? 2 * cache->blocks_capacity : 32;
+    cgltf_vrm_mtoon_block* blocks = (cgltf_vrm_mtoon_block*)memory->alloc_func(memory->user_data, capacity * sizeof(cgltf_vrm_mtoon_block));
+    cgltf_vrm_mtoon_texture_binding* textures = (cgltf_vrm_mtoon_texture_binding*)memory->alloc_func(memory->user_data, capacity * sizeof(cgltf_vrm_mtoon_texture_binding) * cgltf_vrm_mtoon_texture_slot_max_enum);
+    cgltf_uint* feature_keys = (cgltf_uint*)memory->alloc_func(memory->user_data, capacity * sizeof(cgltf_uint));
+    cgltf_uint* hashes = (cgltf_uint*)memory->alloc_func(memory->user_data, capacity * sizeof(cgltf_uint));
+    if (!blocks || !textures || !feature_keys || !hashes)
+    {
+      if (blocks) memory->free_func(memory->user_data, blocks);
+      if (textures) memory->free_func(memory->user_data, textures);
+      if (feature_keys) memory->free_func(memory->user_data, feature_keys);
+      if (hashes) memory->free_func(memory->user_data, hashes);
+      return 0;
+    }
+    if (cache->blocks_count > 0)
+    {
+      memcpy(blocks, cache->blocks, cache->blocks_count * sizeof(cgltf_vrm_mtoon_block));
+      memcpy(textures, cache->textures, cache->blocks_count * sizeof(cgltf_vrm_mtoon_texture_binding) * cgltf_vrm_mtoon_texture_slot_max_enum);
+      memcpy(feature_keys, cache->feature_keys, cache->blocks_count * sizeof(cgltf_uint));
+      memcpy(hashes, cache->hashes, cache->blocks_count * sizeof(cgltf_uint));
+    }
+    if (cache->blocks) memory->free_func(memory->user_data, cache->blocks);
+    if (cache->textures) memory->free_func(memory->user_data, cache->textures);
+    if (cache->feature_keys) memory->free_func(memory->user_data, cache->feature_keys);
+    if (cache->hashes) memory->free_func(memory->user_data, cache->hashes);
+    cache->blocks = blocks;
+    cache->textures = textures;
+    cache->feature_keys = feature_keys;
+    cache->hashes = hashes;
+    cache->blocks_capacity = capacity;
+  }
+
+  /* Hash table, kept at most half full */
+  if (2 * (cache->blocks_count + 1) > cache->slots_count)
+  {
+    cgltf_size slots_count = (cache->slots_count > 0) ? 2 * cache->slots_count : 64;
+    cgltf_uint* slots = (cgltf_uint*)memory->alloc_func(memory->user_data, slots_count * sizeof(cgltf_uint));
+    if (!slots)
     {
-      ++i;
-      out->commercial_usage = cgltf_vrm_string_to_meta_commercial_usage(tokens + i, json_chunk);
-      ++i;
+      return 0;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "creditNotation") == 0)
+    memset(slots, 0, slots_count * sizeof(cgltf_uint));
+
+    for (cgltf_size i = 0; i < cache->blocks_count; ++i)
     {
-      ++i;
-      out->credit_notation = cgltf_vrm_string_to_meta_credit_notation(tokens + i, json_chunk);
-      ++i;
+      cgltf_size slot = cache->hashes[i] & (slots_count - 1);
+      while (slots[slot] != 0)
+      {
+        slot = (slot + 1) & (slots_count - 1);
+      }
+      slots[slot] = (cgltf_uint)(i + 1);
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "modification") == 0)
+
+    if (cache->slots) memory->free_func(memory->user_data, cache->slots);
+    cache->slots = slots;
+    cache->slots_count = slots_count;
+  }
+
+  return 1;
+}
+
+cgltf_result cgltf_vrm_mtoon_cache_init(cgltf_vrm_mtoon_cache* cache, cgltf_memory_options const* memory)
+{
+  if (cache == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  memset(cache, 0, sizeof(cgltf_vrm_mtoon_cache));
+
+  if (memory != NULL)
+  {
+    cache->memory = *memory;
+  }
+  if (cache->memory.alloc_func == NULL)
+  {
+    cache->memory.alloc_func = &cgltf_default_alloc;
+  }
+  if (cache->memory.free_func == NULL)
+  {
+    cache->memory.free_func = &cgltf_default_free;
+  }
+
+  return cgltf_result_success;
+}
+
+cgltf_result cgltf_vrm_mtoon_cache_add(cgltf_vrm_mtoon_cache* cache, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_int const* texture_ids, cgltf_int* out_blocks)
+{
+  if (cache == NULL || gltf == NULL || vrm == NULL || out_blocks == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  for (cgltf_size i = 0; i < gltf->materials_count; ++i)
+  {
+    cgltf_vrm_mtoon_block block;
+    cgltf_vrm_mtoon_texture_binding textures[cgltf_vrm_mtoon_texture_slot_max_enum];
+
+    out_blocks[i] = -1;
+    if (i >= vrm->extended_materials_count || !vrm->extended_materials[i].has_mtoon)
     {
-      ++i;
-      out->modification = cgltf_vrm_string_to_meta_modification(tokens + i, json_chunk);
-      ++i;
+      continue;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "allowRedistribution") == 0)
+
+    cgltf_vrm_mtoon_pack_block(gltf, &gltf->materials[i], &vrm->extended_materials[i].mtoon, &block, textures);
+    if (texture_ids != NULL)
     {
-      ++i;
-      out->allow_redistribution = cgltf_json_to_bool(tokens + i, json_chunk);
-      ++i;
+      for (int t = 0; t < cgltf_vrm_mtoon_texture_slot_max_enum; ++t)
+      {
+        textures[t].texture = (textures[t].texture >= 0) ? texture_ids[textures[t].texture] : -1;
+      }
     }
-    else
+
+    cgltf_uint hash = cgltf_vrm_mtoon_cache_hash(&block, textures);
+    if (cache->slots_count > 0)
+    {
+      cgltf_size slot = cgltf_vrm_mtoon_cache_probe(cache, &block, textures, hash);
+      if (cache->slots[slot] != 0)
+      {
+        out_blocks[i] = (cgltf_int)(cache->slots[slot] - 1);
+        continue;
+      }
+    }
+
+    if (!cgltf_vrm_mtoon_cache_grow(cache))
+    {
+      return cgltf_result_out_of_memory;
+    }
+
+    cgltf_size index = cache->blocks_count++;
+    cache->blocks[index] = block;
+    memcpy(&cache->textures[index * cgltf_vrm_mtoon_texture_slot_max_enum], textures, sizeof(textures));
+    cache->feature_keys[index] = cgltf_vrm_mtoon_feature_key(gltf, &gltf->materials[i], &vrm->extended_materials[i].mtoon);
+    cache->hashes[index] = hash;
+    cache->slots[cgltf_vrm_mtoon_cache_probe(cache, &block, textures, hash)] = (cgltf_uint)(index + 1);
+    out_blocks[i] = (cgltf_int)index;
+  }
+
+  return cgltf_result_success;
+}
+
+void cgltf_vrm_mtoon_cache_free(cgltf_vrm_mtoon_cache* cache)
+{
+  if (!cache || !cache->memory.free_func)
+  {
+    return;
+  }
+
+  cache->memory.free_func(cache->memory.user_data, cache->blocks);
+  cache->memory.free_func(cache->memory.user_data, cache->textures);
+  cache->memory.free_func(cache->memory.user_data, cache->feature_keys);
+  cache->memory.free_func(cache->memory.user_data, cache->hashes);
+  cache->memory.free_func(cache->memory.user_data, cache->slots);
+  memset(cache, 0, sizeof(cgltf_vrm_mtoon_cache));
+}
+
+/* ----------- MToon UV animation ----------- */
+
+cgltf_result cgltf_vrm_mtoon_uv_animations_init(cgltf_options const* options, cgltf_vrm_data const* vrm, cgltf_vrm_mtoon_uv_animations* animations)
+{
+  cgltf_options fixed_options;
+  cgltf_size count = 0;
+
+  if (options == NULL || vrm == NULL || animations == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
+
+  memset(animations, 0, sizeof(cgltf_vrm_mtoon_uv_animations));
+  animations->memory = fixed_options.memory;
+
+  for (cgltf_size i = 0; i < vrm->extended_materials_count; ++i)
+  {
+    cgltf_vrm_mtoon const* mtoon = &vrm->extended_materials[i].mtoon;
+    count += vrm->extended_materials[i].has_mtoon && ((mtoon->uv_animation_scroll_x_speed_factor != 0.0f)
+      || (mtoon->uv_animation_scroll_y_speed_factor != 0.0f) || (mtoon->uv_animation_rotation_speed_factor != 0.0f));
+  }
+
+  animations->materials = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), count + 1);
+  animations->has_mask = (cgltf_bool*)cgltf_calloc(&fixed_options, sizeof(cgltf_bool), count + 1);
+  animations->scroll_x_speeds = (cgltf_float*)cgltf_calloc(&fixed_options, sizeof(cgltf_float), count + 1);
+  animations->scroll_y_speeds = (cgltf_float*)cgltf_calloc(&fixed_options, sizeof(cgltf_float), count + 1);
+  animations->rotation_speeds = (cgltf_float*)cgltf_calloc(&fixed_options, sizeof(cgltf_float), count + 1);
+  animations->transforms = (cgltf_vrm_mtoon_uv_transform*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_mtoon_uv_transform), count + 1);
+  if (!animations->materials || !animations->has_mask || !animations->scroll_x_speeds || !animations->scroll_y_speeds
+    || !animations->rotation_speeds || !animations->transforms)
+  {
+    cgltf_vrm_mtoon_uv_animations_free(animations);
+    return cgltf_result_out_of_memory;
+  }
+
+  for (cgltf_size i = 0; i < vrm->extended_materials_count; ++i)
+  {
+    cgltf_vrm_mtoon const* mtoon = &vrm->extended_materials[i].mtoon;
+    if (!vrm->extended_materials[i].has_mtoon || ((mtoon->uv_animation_scroll_x_speed_factor == 0.0f)
+      && (mtoon->uv_animation_scroll_y_speed_factor == 0.0f) && (mtoon->uv_animation_rotation_speed_factor == 0.0f)))
     {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.meta.")
+      continue;
     }
+
+    cgltf_size n = animations->count++;
+    animations->materials[n] = (cgltf_uint)i;
+    animations->has_mask[n] = (mtoon->uv_animation_mask_texture.index >= 0);
+    animations->scroll_x_speeds[n] = mtoon->uv_animation_scroll_x_speed_factor;
+    animations->scroll_y_speeds[n] = mtoon->uv_animation_scroll_y_speed_factor;
+    animations->rotation_speeds[n] = mtoon->uv_animation_rotation_speed_factor;
   }
 
-  return i;
+  cgltf_vrm_mtoon_uv_animations_evaluate(animations, 0.0);
+
+  return cgltf_result_success;
 }
 
+/* A period of 0 keeps the phase unwrapped. */
 static
-int cgltf_vrm_parse_json_first_person(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_first_person* out)
+cgltf_float cgltf_vrm_wrap_phase(double speed, double time, double period)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  if (period <= 0.0)
+  {
+    return (cgltf_float)(speed * time);
+  }
 
-  int size = tokens[i].size;
-  ++i;
+  /* In double, so that long running times keep their precision */
+  double phase = fmod(speed * time, period);
+  return (cgltf_float)((phase < 0.0) ? phase + period : phase);
+}
 
-  for (int j = 0; j < size; ++j)
+void cgltf_vrm_mtoon_uv_animations_evaluate(cgltf_vrm_mtoon_uv_animations* animations, double time)
+{
+  double const two_pi = 6.283185307179586;
+  cgltf_vrm_mtoon_uv_transform* transforms = animations->transforms;
+
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_mtoon_uv_animations_evaluate");
+  for (cgltf_size i = 0; i < animations->count; ++i)
   {
-    CGLTF_CHECK_KEY(tokens[i]);
+    /* mask * phase is only continuous on the unwrapped phase */
+    double scroll_period = animations->has_mask[i] ? 0.0 : 1.0;
+    double rotation_period = animations->has_mask[i] ? 0.0 : two_pi;
+    transforms[i].scroll[0] = cgltf_vrm_wrap_phase(animations->scroll_x_speeds[i], time, scroll_period);
+    transforms[i].scroll[1] = cgltf_vrm_wrap_phase(animations->scroll_y_speeds[i], time, scroll_period);
+    transforms[i].rotation = cgltf_vrm_wrap_phase(animations->rotation_speeds[i], time, rotation_period);
+  }
 
-    if (cgltf_json_strcmp(tokens+i, json_chunk, "meshAnnotations") == 0)
+  for (cgltf_size i = 0; i < animations->count; ++i)
+  {
+    cgltf_vrm_mtoon_uv_transform* t = &transforms[i];
+    cgltf_float c = cosf(t->rotation);
+    cgltf_float s = sinf(t->rotation);
+    cgltf_float x = t->scroll[0] - 0.5f;
+    cgltf_float y = t->scroll[1] - 0.5f;
+
+    /* uv' = R (uv + scroll - 0.5) + 0.5 */
+    t->matrix[0] = c;
+    t->matrix[1] = -s;
+    t->matrix[2] = s;
+    t->matrix[3] = c;
+    t->matrix[4] = c * x + s * y + 0.5f;
+    t->matrix[5] = -s * x + c * y + 0.5f;
+  }
+  CGLTF_VRM_PROFILE_END(NULL, zone);
+}
+
+void cgltf_vrm_mtoon_uv_animations_free(cgltf_vrm_mtoon_uv_animations* animations)
+{
+  if (!animations || !animations->memory.free_func)
+  {
+    return;
+  }
+
+  animations->memory.free_func(animations->memory.user_data, animations->materials);
+  animations->memory.free_func(animations->memory.user_data, animations->has_mask);
+  animations->memory.free_func(animations->memory.user_data, animations->scroll_x_speeds);
+  animations->memory.free_func(animations->memory.user_data, animations->scroll_y_speeds);
+  animations->memory.free_func(animations->memory.user_data, animations->rotation_speeds);
+  animations->memory.free_func(animations->memory.user_data, animations->transforms);
+  memset(animations, 0, sizeof(cgltf_vrm_mtoon_uv_animations));
+}
+
+/* ----------- MToon outline normals ----------- */
+
+static
+cgltf_accessor const* cgltf_vrm_primitive_attribute(cgltf_primitive const* primitive, cgltf_attribute_type type, cgltf_int index)
+{
+  for (cgltf_size i = 0; i < primitive->attributes_count; ++i)
+  {
+    if (primitive->attributes[i].type == type && primitive->attributes[i].index == index)
     {
-      i = cgltf_parse_json_array(options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_first_person_mesh_annotation), (void**)&out->mesh_annotations, &out->mesh_annotations_count);
+      return primitive->attributes[i].data;
+    }
+  }
+  return NULL;
+}
 
-      if (i < 0)
-      {
-        return i;
-      }
-      for (cgltf_size k = 0; k < out->mesh_annotations_count; ++k)
+cgltf_result cgltf_vrm_outline_normals_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_outline_normals* normals)
+{
+  cgltf_options fixed_options;
+  cgltf_size count = 0;
+
+  if (options == NULL || gltf == NULL || vrm == NULL || normals == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
+
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
+
+  memset(normals, 0, sizeof(cgltf_vrm_outline_normals));
+  normals->memory = fixed_options.memory;
+
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    for (cgltf_size m = 0; m < gltf->meshes_count; ++m)
+    {
+      cgltf_mesh const* mesh = &gltf->meshes[m];
+
+      for (cgltf_size p = 0; p < mesh->primitives_count; ++p)
       {
-        cgltf_size nElems = tokens[i].size;
-        ++i;
+        cgltf_primitive const* primitive = &mesh->primitives[p];
+        cgltf_accessor const* positions = cgltf_vrm_primitive_attribute(primitive, cgltf_attribute_type_position, 0);
+        cgltf_size material = primitive->material ? (cgltf_size)(primitive->material - gltf->materials) : vrm->extended_materials_count;
 
-        for (cgltf_size l = 0; l < nElems; ++l)
+        if (positions == NULL || material >= vrm->extended_materials_count || !vrm->extended_materials[material].has_mtoon)
         {
-          if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0)
-          {
-            ++i;
-            out->mesh_annotations[k].node = CGLTF_PTRINDEX(cgltf_node, cgltf_json_to_int(tokens + i, json_chunk));
-            ++i;
-          }
-          else if (cgltf_json_strcmp(tokens + i, json_chunk, "type") == 0)
-          {
-            ++i;
-            out->mesh_annotations[k].type = cgltf_vrm_string_to_first_person_mesh_annotation(tokens + i, json_chunk);
-            ++i;
-          }
+          continue;
         }
-        if (i < 0)
+
+        cgltf_vrm_mtoon const* mtoon = &vrm->extended_materials[material].mtoon;
+        if (mtoon->outline_width_mode == cgltf_vrm_mtoon_outline_width_mode_none
+          || mtoon->outline_width_mode == cgltf_vrm_mtoon_outline_width_mode_max_enum || mtoon->outline_width_factor <= 0.0f)
         {
-          return i;
+          continue;
+        }
+
+        if (pass == 1)
+        {
+          cgltf_vrm_outline_primitive* out = &normals->primitives[normals->primitives_count++];
+          out->primitive = primitive;
+          out->mesh = m;
+          out->primitive_index = p;
+          out->material = (cgltf_uint)material;
+          out->width_texture = (mtoon->outline_width_multiply_texture.index >= 0
+            && (cgltf_size)mtoon->outline_width_multiply_texture.index < gltf->textures_count) ? mtoon->outline_width_multiply_texture.index : -1;
+          out->width_tex_coord = mtoon->outline_width_multiply_texture.tex_coord;
+          out->vertices_offset = normals->vertices_count;
+          out->vertices_count = positions->count;
+          normals->vertices_count += positions->count;
+        }
+        else
+        {
+          ++count;
         }
       }
     }
-    else
-    {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.firstPerson.")
-    }
 
-    if (i < 0)
+    if (pass == 0)
     {
-      return i;
+      normals->primitives = (cgltf_vrm_outline_primitive*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_outline_primitive), count + 1);
+      if (!normals->primitives)
+      {
+        return cgltf_result_out_of_memory;
+      }
     }
   }
 
-  return i;
+  normals->normals = (cgltf_float*)cgltf_calloc(&fixed_options, 4 * sizeof(cgltf_float), normals->vertices_count + 1);
+  if (!normals->normals)
+  {
+    cgltf_vrm_outline_normals_free(normals);
+    return cgltf_result_out_of_memory;
+  }
+
+  return cgltf_result_success;
 }
 
 static
-int cgltf_vrm_parse_json_expression_morph_target_binds(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_expression_morph_target_bind* out)
+cgltf_uint cgltf_vrm_position_hash(cgltf_float const* position)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
-
-  cgltf_size size = tokens[i].size;
-  ++i;
+  uint32_t bits[3];
 
-  for (cgltf_size j = 0; j < size; ++j)
+  for (int c = 0; c < 3; ++c)
   {
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "index") == 0)
-    {
-      ++i;
-      out->index = cgltf_json_to_int(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0)
-    {
-      ++i;
-      out->node = CGLTF_PTRINDEX(cgltf_node, cgltf_json_to_int(tokens + i, json_chunk));
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "weight") == 0)
-    {
-      ++i;
-      out->weight = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
+    cgltf_float v = (position[c] == 0.0f) ? 0.0f : position[c]; /* -0 */
+    memcpy(&bits[c], &v, sizeof(uint32_t));
   }
-
-  return i;
+  return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
 }
 
-static
-int cgltf_vrm_parse_json_expressions_dict(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_expression** out, cgltf_size *out_size, char const* tag)
+cgltf_result cgltf_vrm_outline_normals_compute(cgltf_vrm_outline_normals* normals, cgltf_size primitive, cgltf_vrm_outline_width_sample_func sample, void* user_data)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  cgltf_vrm_outline_primitive const* job;
+  cgltf_accessor const* position_accessor;
+  cgltf_accessor const* normal_accessor;
+  cgltf_size n;
+  cgltf_size slots_count = 16;
+  cgltf_size groups_count = 0;
+
+  if (normals == NULL || primitive >= normals->primitives_count)
+  {
+    return cgltf_result_invalid_options;
+  }
 
-  *out_size = tokens[i].size;
-  *out = (cgltf_vrm_expression*)cgltf_calloc(options, sizeof(cgltf_vrm_expression), *out_size);
-  ++i;
+  job = &normals->primitives[primitive];
+  n = job->vertices_count;
+  if (n == 0)
+  {
+    return cgltf_result_success;
+  }
 
-  if (!*out)
+  position_accessor = cgltf_vrm_primitive_attribute(job->primitive, cgltf_attribute_type_position, 0);
+  normal_accessor = cgltf_vrm_primitive_attribute(job->primitive, cgltf_attribute_type_normal, 0);
+  if (position_accessor == NULL || position_accessor->count != n || (normal_accessor && normal_accessor->count != n))
   {
-    return CGLTF_ERROR_NOMEM;
+    return cgltf_result_invalid_gltf;
   }
 
-  for (cgltf_size j = 0; j < *out_size; ++j)
+  while (slots_count < 2 * n)
   {
-    cgltf_vrm_expression *expression = &(*out)[j];
+    slots_count *= 2;
+  }
 
-    CGLTF_CHECK_KEY(tokens[i]);
-    i = cgltf_parse_json_string(options, tokens, i, json_chunk, &expression->name);
+  /* positions (3n), vertex normals (3n), group sums as x / y / z arrays (3n), vertex groups (n), slots */
+  cgltf_size floats_size = 9 * n * sizeof(cgltf_float);
+  void* scratch = normals->memory.alloc_func(normals->memory.user_data, floats_size + (n + slots_count) * sizeof(cgltf_uint));
+  if (!scratch)
+  {
+    return cgltf_result_out_of_memory;
+  }
 
-    cgltf_size nElems = tokens[i].size;
-    ++i;
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_outline_normals_compute");
+  cgltf_float* positions = (cgltf_float*)scratch;
+  cgltf_float* vertex_normals = positions + 3 * n;
+  cgltf_float* gx = vertex_normals + 3 * n;
+  cgltf_float* gy = gx + n;
+  cgltf_float* gz = gy + n;
+  cgltf_uint* groups = (cgltf_uint*)((char*)scratch + floats_size);
+  cgltf_uint* slots = groups + n;
+
+  /* Unloaded buffers and unsupported accessors unpack nothing, the scratch would be read uninitialized. */
+  if (cgltf_accessor_unpack_floats(position_accessor, positions, 3 * n) != 3 * n
+    || (normal_accessor && cgltf_accessor_unpack_floats(normal_accessor, vertex_normals, 3 * n) != 3 * n))
+  {
+    CGLTF_VRM_PROFILE_END(NULL, zone);
+    normals->memory.free_func(normals->memory.user_data, scratch);
+    return cgltf_result_data_too_short;
+  }
 
-    for (cgltf_size k = 0; k < nElems; ++k)
-    {
-      CGLTF_CHECK_KEY(tokens[i]);
+  if (!normal_accessor)
+  {
+    /* Area weighted face normals */
+    cgltf_primitive const* source = job->primitive;
+    cgltf_size indices_count = source->indices ? source->indices->count : n;
 
-      if (cgltf_json_strcmp(tokens+i, json_chunk, "isBinary") == 0)
-      {
-        ++i;
-        expression->is_binary = cgltf_json_to_bool(tokens + i, json_chunk);
-        ++i;
-      }
-      else if (cgltf_json_strcmp(tokens+i, json_chunk, "overrideBlink") == 0)
-      {
-        ++i;
-        expression->override_blink = cgltf_vrm_string_to_expression_override(tokens + i, json_chunk);
-        ++i;
-      }
-      else if (cgltf_json_strcmp(tokens+i, json_chunk, "overrideMouth") == 0)
-      {
-        ++i;
-        expression->override_mouth = cgltf_vrm_string_to_expression_override(tokens + i, json_chunk);
-        ++i;
-      }
-      else if (cgltf_json_strcmp(tokens+i, json_chunk, "overrideLookAt") == 0)
+    memset(vertex_normals, 0, 3 * n * sizeof(cgltf_float));
+    for (cgltf_size t = 0; (source->type == cgltf_primitive_type_triangles) && (t + 2 < indices_count); t += 3)
+    {
+      cgltf_size v[3];
+      for (int k = 0; k < 3; ++k)
       {
-        ++i;
-        expression->override_look_at = cgltf_vrm_string_to_expression_override(tokens + i, json_chunk);
-        ++i;
+        v[k] = source->indices ? cgltf_accessor_read_index(source->indices, t + k) : t + k;
       }
-      else if (cgltf_json_strcmp(tokens+i, json_chunk, "morphTargetBinds") == 0)
+      if (v[0] >= n || v[1] >= n || v[2] >= n)
       {
-        i = cgltf_parse_json_array(options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_expression_morph_target_bind), (void**)&expression->morph_target_binds, &expression->morph_target_binds_count);
-        if (i < 0)
-        {
-          return i;
-        }
-        for (cgltf_size l = 0; l < expression->morph_target_binds_count; ++l)
-        {
-          i = cgltf_vrm_parse_json_expression_morph_target_binds(options, tokens, i, json_chunk, &expression->morph_target_binds[l]);
-          if (i < 0)
-          {
-            return i;
-          }
-        }
+        continue;
       }
-      /*
-      else if (cgltf_json_strcmp(tokens+i, json_chunk, "materialColorBinds") == 0)
+
+      cgltf_float const* a = &positions[3 * v[0]];
+      cgltf_float const* b = &positions[3 * v[1]];
+      cgltf_float const* c = &positions[3 * v[2]];
+      cgltf_float e0[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+      cgltf_float e1[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+      cgltf_float face[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+
+      for (int k = 0; k < 3; ++k)
       {
-        // i = cgltf_parse_json_array(options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_expression_material_color_bind), (void**)&expression->material_color_binds, &outexpression->material_color_binds_count);
+        vertex_normals[3 * v[k] + 0] += face[0];
+        vertex_normals[3 * v[k] + 1] += face[1];
+        vertex_normals[3 * v[k] + 2] += face[2];
       }
-      else if (cgltf_json_strcmp(tokens+i, json_chunk, "transformBinds") == 0)
+    }
+  }
+
+  /* Spatial hash on the exact position, giving each vertex the index of its position group */
+  memset(slots, 0, slots_count * sizeof(cgltf_uint));
+  for (cgltf_size i = 0; i < n; ++i)
+  {
+    cgltf_float const* p = &positions[3 * i];
+    cgltf_size slot = cgltf_vrm_position_hash(p) & (slots_count - 1);
+
+    for (;;)
+    {
+      cgltf_uint entry = slots[slot];
+      if (entry == 0)
       {
-        // i = cgltf_parse_json_array(options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_expression_texture_transform_bind), (void**)&expression->texture_transform_binds, &expression->texture_transform_binds_count);
+        slots[slot] = (cgltf_uint)(i + 1);
+        groups[i] = (cgltf_uint)groups_count++;
+        break;
       }
-      */
-      else
+
+      cgltf_float const* q = &positions[3 * (entry - 1)];
+      if (p[0] == q[0] && p[1] == q[1] && p[2] == q[2])
       {
-        CGLTF_VRM_LOG_SKIPPED(tag)
+        groups[i] = groups[entry - 1];
+        break;
       }
+      slot = (slot + 1) & (slots_count - 1);
     }
   }
 
-  return i;
-}
-
-static
-int cgltf_vrm_parse_json_expressions(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_expressions* out)
-{
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
-  memset(out, 0, sizeof(cgltf_vrm_expression));
-
-  int size = tokens[i].size;
-  ++i;
+  memset(gx, 0, 3 * n * sizeof(cgltf_float));
+  for (cgltf_size i = 0; i < n; ++i)
+  {
+    gx[groups[i]] += vertex_normals[3 * i + 0];
+    gy[groups[i]] += vertex_normals[3 * i + 1];
+    gz[groups[i]] += vertex_normals[3 * i + 2];
+  }
 
-  for (int j = 0; j < size; ++j)
+  /* Normalized in place over the group arrays, so the loop vectorizes */
+  for (cgltf_size g = 0; g < groups_count; ++g)
   {
-    CGLTF_CHECK_KEY(tokens[i]);
+    cgltf_float length = sqrtf(gx[g] * gx[g] + gy[g] * gy[g] + gz[g] * gz[g]);
+    cgltf_float scale = (length > 0.0f) ? 1.0f / length : 0.0f;
+    gx[g] *= scale;
+    gy[g] *= scale;
+    gz[g] *= scale;
+  }
 
-    if (cgltf_json_strcmp(tokens+i, json_chunk, "preset") == 0)
-    {
-      i = cgltf_vrm_parse_json_expressions_dict(options, tokens, i + 1, json_chunk, &out->preset, &out->preset_count, "VRMC_vrm.expressions.preset");
-    }
-    else if (cgltf_json_strcmp(tokens+i, json_chunk, "custom") == 0)
-    {
-      i = cgltf_vrm_parse_json_expressions_dict(options, tokens, i + 1, json_chunk, &out->custom, &out->custom_count, "VRMC_vrm.expressions.custom");
-    }
-    else
-    {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.expressions.")
-    }
+  cgltf_float* out = &normals->normals[4 * job->vertices_offset];
+  for (cgltf_size i = 0; i < n; ++i)
+  {
+    out[4 * i + 0] = gx[groups[i]];
+    out[4 * i + 1] = gy[groups[i]];
+    out[4 * i + 2] = gz[groups[i]];
+    out[4 * i + 3] = 1.0f;
+  }
 
-    if (i < 0)
+  if (sample != NULL && job->width_texture >= 0)
+  {
+    cgltf_accessor const* uvs = cgltf_vrm_primitive_attribute(job->primitive, cgltf_attribute_type_texcoord, job->width_tex_coord);
+    for (cgltf_size i = 0; uvs && i < n; ++i)
     {
-      return i;
+      cgltf_float uv[2] = { 0.0f, 0.0f };
+      cgltf_accessor_read_float(uvs, i, uv, 2);
+      out[4 * i + 3] = sample(user_data, job->width_texture, uv[0], uv[1]);
     }
   }
 
-  return i;
+  CGLTF_VRM_PROFILE_END(NULL, zone);
+  normals->memory.free_func(normals->memory.user_data, scratch);
+
+  return cgltf_result_success;
 }
 
-static
-int cgltf_vrm_parse_json_look_at_range_map(jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_look_at_range_map* out)
+void cgltf_vrm_outline_normals_free(cgltf_vrm_outline_normals* normals)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  if (!normals || !normals->memory.free_func)
+  {
+    return;
+  }
 
-  cgltf_size size = tokens[i].size;
-  ++i;
+  normals->memory.free_func(normals->memory.user_data, normals->primitives);
+  normals->memory.free_func(normals->memory.user_data, normals->normals);
+  memset(normals, 0, sizeof(cgltf_vrm_outline_normals));
+}
 
-  for (cgltf_size j = 0; j < size; ++j)
+/* ----------- Draw sorting ----------- */
+
+cgltf_int cgltf_vrm_mtoon_render_queue(cgltf_material const* material, cgltf_vrm_mtoon const* mtoon, cgltf_vrm_mtoon_transparency* out_transparency)
+{
+  cgltf_vrm_mtoon_transparency transparency = cgltf_vrm_mtoon_transparency_opaque;
+  cgltf_int offset = mtoon ? mtoon->render_queue_offset_number : 0;
+  cgltf_int queue = 2000;
+
+  if (material->alpha_mode == cgltf_alpha_mode_mask)
   {
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "inputMaxValue") == 0)
-    {
-      ++i;
-      out->input_max_value = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outputScale") == 0)
+    transparency = cgltf_vrm_mtoon_transparency_cutout;
+    queue = 2450;
+  }
+  else if (material->alpha_mode == cgltf_alpha_mode_blend)
+  {
+    if (mtoon && mtoon->transparent_with_z_write)
     {
-      ++i;
-      out->output_scale = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
+      transparency = cgltf_vrm_mtoon_transparency_transparent_with_z_write;
+      queue = 2501 + ((offset < 0) ? 0 : (offset > 9) ? 9 : offset);
     }
     else
     {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.lookAt.rangeMap??")
+      transparency = cgltf_vrm_mtoon_transparency_transparent;
+      queue = 3000 + ((offset < -9) ? -9 : (offset > 0) ? 0 : offset);
     }
   }
 
-  return i;
+  if (out_transparency)
+  {
+    *out_transparency = transparency;
+  }
+  return queue;
 }
 
-static
-int cgltf_vrm_parse_json_look_at(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_look_at* out)
+uint64_t cgltf_vrm_mtoon_sort_key(cgltf_material const* material, cgltf_vrm_mtoon const* mtoon, cgltf_uint feature_key, cgltf_uint material_id)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  cgltf_vrm_mtoon_transparency transparency;
+  cgltf_int queue = cgltf_vrm_mtoon_render_queue(material, mtoon, &transparency);
 
-  memset(out, 0, sizeof(cgltf_vrm_look_at));
+  return ((uint64_t)(queue & 0xfff) << 52)
+    | ((uint64_t)transparency << 50)
+    | ((uint64_t)(feature_key & 0x1ffffff) << 25)
+    | (uint64_t)(material_id & 0x1ffffff);
+}
 
-  int size = tokens[i].size;
-  ++i;
+void cgltf_vrm_sort_draws(uint64_t* keys, cgltf_uint* indices, cgltf_size count, uint64_t* tmp_keys, cgltf_uint* tmp_indices)
+{
+  uint64_t* src_keys = keys;
+  cgltf_uint* src_indices = indices;
+  uint64_t* dst_keys = tmp_keys;
+  cgltf_uint* dst_indices = tmp_indices;
+  cgltf_size histograms[8][256];
 
-  for (int j = 0; j < size; ++j)
+  if (count < 2)
   {
-    CGLTF_CHECK_KEY(tokens[i]);
+    return;
+  }
 
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "type") == 0)
-    {
-      ++i;
-      out->type = cgltf_vrm_string_to_look_at(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "offsetFromHeadBone") == 0)
-    {
-      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->offset_from_head_bone, 3);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rangeMapHorizontalInner") == 0)
-    {
-      i = cgltf_vrm_parse_json_look_at_range_map(tokens, i + 1, json_chunk, &out->range_map_horizontal_inner);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rangeMapHorizontalOuter") == 0)
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_sort_draws");
+  /* All the digit histograms in a single read */
+  memset(histograms, 0, sizeof(histograms));
+  for (cgltf_size i = 0; i < count; ++i)
+  {
+    uint64_t key = keys[i];
+    for (int d = 0; d < 8; ++d)
     {
-      i = cgltf_vrm_parse_json_look_at_range_map(tokens, i + 1, json_chunk, &out->range_map_horizontal_outer);
+      histograms[d][(key >> (8 * d)) & 0xff] += 1;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rangeMapVerticalUp") == 0)
+  }
+
+  for (int d = 0; d < 8; ++d)
+  {
+    cgltf_size* histogram = histograms[d];
+    cgltf_size sum = 0;
+
+    /* Digits shared by every key (most of the queue and feature bits) need no pass */
+    if (histogram[(src_keys[0] >> (8 * d)) & 0xff] == count)
     {
-      i = cgltf_vrm_parse_json_look_at_range_map(tokens, i + 1, json_chunk, &out->range_map_vertical_up);
+      continue;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rangeMapVerticalDown") == 0)
+
+    for (int b = 0; b < 256; ++b)
     {
-      i = cgltf_vrm_parse_json_look_at_range_map(tokens, i + 1, json_chunk, &out->range_map_vertical_down);
+      cgltf_size n = histogram[b];
+      histogram[b] = sum;
+      sum += n;
     }
-    else
+
+    for (cgltf_size i = 0; i < count; ++i)
     {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.lookAt.")
+      cgltf_size slot = histogram[(src_keys[i] >> (8 * d)) & 0xff]++;
+      dst_keys[slot] = src_keys[i];
+      dst_indices[slot] = src_indices[i];
     }
+
+    uint64_t* swap_keys = src_keys;
+    cgltf_uint* swap_indices = src_indices;
+    src_keys = dst_keys;
+    src_indices = dst_indices;
+    dst_keys = swap_keys;
+    dst_indices = swap_indices;
   }
 
-  return i;
+  if (src_keys != keys)
+  {
+    memcpy(keys, src_keys, count * sizeof(uint64_t));
+    memcpy(indices, src_indices, count * sizeof(cgltf_uint));
+  }
+  CGLTF_VRM_PROFILE_END(NULL, zone);
 }
 
-static
-int cgltf_vrm_parse_json_vrm(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_core* out)
-{
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+/* ----------- Texture usage ----------- */
 
-  memset(out, 0, sizeof(cgltf_vrm_core));
+static
+cgltf_uint const cgltf_vrm_texture_role_default_priorities[cgltf_vrm_texture_role_max_enum] = {
+  0, /* base color */
+  1, /* shade multiply */
+  2, /* shading shift */
+  2, /* normal */
+  2, /* emissive */
+  4, /* matcap */
+  4, /* rim multiply */
+  3, /* outline width multiply */
+  3, /* uv animation mask */
+  3, /* metallic roughness */
+  3, /* occlusion */
+  5, /* thumbnail */
+};
 
-  int size = tokens[i].size;
-  ++i;
+static
+void cgltf_vrm_texture_usage_add(cgltf_vrm_texture_usage* usage, cgltf_data const* gltf, cgltf_uint const* priorities, cgltf_int texture, cgltf_int material, cgltf_vrm_texture_role role, cgltf_bool animated)
+{
+  cgltf_vrm_texture_use* use;
 
-  for (int j = 0; j < size; ++j)
+  if (texture < 0 || (cgltf_size)texture >= gltf->textures_count)
   {
-    CGLTF_CHECK_KEY(tokens[i]);
-
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "specVersion") == 0)
-    {
-      ++i;
-      out->spec_version = cgltf_vrm_string_to_spec_version(tokens, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "humanoid") == 0)
-    {
-      i = cgltf_vrm_parse_json_humanoid(options, tokens, i + 1, json_chunk, &out->humanoid);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "meta") == 0)
-    {
-      i = cgltf_vrm_parse_json_meta(options, tokens, i + 1, json_chunk, &out->meta);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "firstPerson") == 0)
-    {
-      i = cgltf_vrm_parse_json_first_person(options, tokens, i + 1, json_chunk, &out->first_person);
-      out->has_first_person = 1;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "expressions") == 0)
-    {
-      i = cgltf_vrm_parse_json_expressions(options, tokens, i + 1, json_chunk, &out->expressions);
-      out->has_expressions = 1;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "lookAt") == 0)
-    {
-      i = cgltf_vrm_parse_json_look_at(options, tokens, i + 1, json_chunk, &out->look_at);
-      out->has_look_at = 1;
-    }
-    else
-    {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_vrm.")
-    }
-
-    if (i < 0)
-    {
-      return i;
-    }
+    return;
   }
 
-  return i;
+  use = &usage->uses[usage->uses_count++];
+  use->texture = texture;
+  use->image = gltf->textures[texture].image ? (cgltf_int)(gltf->textures[texture].image - gltf->images) : -1;
+  use->material = material;
+  use->role = role;
+  use->priority = priorities[role];
+  use->animated = animated && (role != cgltf_vrm_texture_role_matcap);
 }
 
-/* ----------- VRMC_springBone ----------- */
-
 static
-int cgltf_vrm_parse_json_spring_bone_colliders(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone_collider* out)
+int cgltf_vrm_compare_texture_uses(void const* a, void const* b)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  cgltf_vrm_texture_use const* ua = (cgltf_vrm_texture_use const*)a;
+  cgltf_vrm_texture_use const* ub = (cgltf_vrm_texture_use const*)b;
 
-  cgltf_size size = tokens[i].size;
-  ++i;
+  if (ua->priority != ub->priority)
+  {
+    return (ua->priority < ub->priority) ? -1 : 1;
+  }
+  if (ua->image != ub->image)
+  {
+    return (ua->image < ub->image) ? -1 : 1;
+  }
+  return (ua->material < ub->material) ? -1 : (ua->material > ub->material);
+}
 
-  for (cgltf_size j = 0; j < size; ++j)
+cgltf_result cgltf_vrm_texture_usage_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_uint const* role_priorities, cgltf_vrm_texture_usage* usage)
+{
+  cgltf_options fixed_options;
+  cgltf_uint const* priorities = role_priorities ? role_priorities : cgltf_vrm_texture_role_default_priorities;
+  cgltf_bool* transformed;
+
+  if (options == NULL || gltf == NULL || vrm == NULL || usage == NULL)
   {
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0)
-    {
-      ++i;
-      out->node = CGLTF_PTRINDEX(cgltf_node, cgltf_json_to_int(tokens + i, json_chunk));
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shape") == 0)
-    {
-      cgltf_size nElems;
+    return cgltf_result_invalid_options;
+  }
 
-      i += 2;
-      out->shape = cgltf_vrm_string_to_spring_bone_collider_shape(tokens + i, json_chunk);
-      ++i;
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
 
-      nElems = tokens[i].size;
-      ++i;
+  memset(usage, 0, sizeof(cgltf_vrm_texture_usage));
+  usage->memory = fixed_options.memory;
 
-      for (cgltf_size k = 0; k < nElems; ++k)
+  usage->uses = (cgltf_vrm_texture_use*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_texture_use), gltf->materials_count * cgltf_vrm_texture_role_thumbnail + 1);
+  usage->texture_roles = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), gltf->textures_count + 1);
+  usage->texture_priorities = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), gltf->textures_count + 1);
+  usage->image_priorities = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), gltf->images_count + 1);
+  transformed = (cgltf_bool*)cgltf_calloc(&fixed_options, sizeof(cgltf_bool), gltf->materials_count + 1);
+  if (!usage->uses || !usage->texture_roles || !usage->texture_priorities || !usage->image_priorities || !transformed)
+  {
+    fixed_options.memory.free_func(fixed_options.memory.user_data, transformed);
+    cgltf_vrm_texture_usage_free(usage);
+    return cgltf_result_out_of_memory;
+  }
+  usage->textures_count = gltf->textures_count;
+  usage->images_count = gltf->images_count;
+
+  /* Materials moved by expression texture transform binds */
+  for (int preset = 0; preset < 2; ++preset)
+  {
+    cgltf_vrm_expression const* expressions = preset ? vrm->core.expressions.preset : vrm->core.expressions.custom;
+    cgltf_size count = preset ? vrm->core.expressions.preset_count : vrm->core.expressions.custom_count;
+
+    for (cgltf_size i = 0; vrm->core.has_expressions && i < count; ++i)
+    {
+      for (cgltf_size j = 0; j < expressions[i].texture_transform_binds_count; ++j)
       {
-        if (cgltf_json_strcmp(tokens + i, json_chunk, "radius") == 0)
-        {
-          ++i;
-          out->radius = cgltf_json_to_float(tokens + i, json_chunk);
-          ++i;
-        }
-        else if (cgltf_json_strcmp(tokens + i, json_chunk, "offset") == 0)
-        {
-          i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->offset, 3);
-        }
-        else if (cgltf_json_strcmp(tokens + i, json_chunk, "tail") == 0)
-        {
-          i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->tail, 3);
-        }
-        else
+        cgltf_material const* material = expressions[i].texture_transform_binds[j].material;
+        if (material != NULL)
         {
-          CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.colliders.shape.")
+          transformed[material - gltf->materials] = 1;
         }
       }
     }
+  }
+
+  for (cgltf_size i = 0; i < gltf->materials_count; ++i)
+  {
+    cgltf_material const* material = &gltf->materials[i];
+    cgltf_int m = (cgltf_int)i;
+    cgltf_bool animated = transformed[i];
+
+    if (i < vrm->extended_materials_count && vrm->extended_materials[i].has_mtoon)
+    {
+      cgltf_vrm_mtoon const* mtoon = &vrm->extended_materials[i].mtoon;
+
+      animated |= (mtoon->uv_animation_scroll_x_speed_factor != 0.0f) || (mtoon->uv_animation_scroll_y_speed_factor != 0.0f)
+        || (mtoon->uv_animation_rotation_speed_factor != 0.0f);
+
+      cgltf_vrm_texture_usage_add(usage, gltf, priorities, mtoon->shade_multiply_texture.index, m, cgltf_vrm_texture_role_shade_multiply, animated);
+      cgltf_vrm_texture_usage_add(usage, gltf, priorities, mtoon->shading_shift_texture.index, m, cgltf_vrm_texture_role_shading_shift, animated);
+      cgltf_vrm_texture_usage_add(usage, gltf, priorities, mtoon->matcap_texture.index, m, cgltf_vrm_texture_role_matcap, animated);
+      cgltf_vrm_texture_usage_add(usage, gltf, priorities, mtoon->rim_multiply_texture.index, m, cgltf_vrm_texture_role_rim_multiply, animated);
+      cgltf_vrm_texture_usage_add(usage, gltf, priorities, mtoon->outline_width_multiply_texture.index, m, cgltf_vrm_texture_role_outline_width_multiply, animated);
+      cgltf_vrm_texture_usage_add(usage, gltf, priorities, mtoon->uv_animation_mask_texture.index, m, cgltf_vrm_texture_role_uv_animation_mask, animated);
+    }
     else
     {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.colliders.")
+      cgltf_vrm_texture_usage_add(usage, gltf, priorities, cgltf_vrm_texture_view_index(gltf, &material->pbr_metallic_roughness.metallic_roughness_texture), m, cgltf_vrm_texture_role_metallic_roughness, animated);
+      cgltf_vrm_texture_usage_add(usage, gltf, priorities, cgltf_vrm_texture_view_index(gltf, &material->occlusion_texture), m, cgltf_vrm_texture_role_occlusion, animated);
     }
+
+    cgltf_vrm_texture_usage_add(usage, gltf, priorities, cgltf_vrm_texture_view_index(gltf, &material->pbr_metallic_roughness.base_color_texture), m, cgltf_vrm_texture_role_base_color, animated);
+    cgltf_vrm_texture_usage_add(usage, gltf, priorities, cgltf_vrm_texture_view_index(gltf, &material->normal_texture), m, cgltf_vrm_texture_role_normal, animated);
+    cgltf_vrm_texture_usage_add(usage, gltf, priorities, cgltf_vrm_texture_view_index(gltf, &material->emissive_texture), m, cgltf_vrm_texture_role_emissive, animated);
   }
 
-  return i;
-}
+  fixed_options.memory.free_func(fixed_options.memory.user_data, transformed);
 
-static
-int cgltf_vrm_parse_json_spring_bone_collider_groups(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone_collider_group* out)
-{
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  if (vrm->core.meta.has_thumbnail_image && vrm->core.meta.thumbnail_image != NULL)
+  {
+    cgltf_vrm_texture_use* use = &usage->uses[usage->uses_count++];
+    use->texture = -1;
+    use->image = (cgltf_int)(vrm->core.meta.thumbnail_image - gltf->images);
+    use->material = -1;
+    use->role = cgltf_vrm_texture_role_thumbnail;
+    use->priority = priorities[cgltf_vrm_texture_role_thumbnail];
+  }
 
-  cgltf_size size = tokens[i].size;
-  ++i;
+  qsort(usage->uses, usage->uses_count, sizeof(cgltf_vrm_texture_use), cgltf_vrm_compare_texture_uses);
 
-  for (cgltf_size j = 0; j < size; ++j)
+  for (cgltf_size i = 0; i < usage->textures_count; ++i)
   {
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "name") == 0)
-    {
-      i = cgltf_parse_json_string(options, tokens, i + 1, json_chunk, &out->name);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "colliders") == 0)
+    usage->texture_priorities[i] = CGLTF_VRM_TEXTURE_UNUSED;
+  }
+  for (cgltf_size i = 0; i < usage->images_count; ++i)
+  {
+    usage->image_priorities[i] = CGLTF_VRM_TEXTURE_UNUSED;
+  }
+
+  /* Sorted, so the first use of a texture or image has its best priority */
+  for (cgltf_size i = 0; i < usage->uses_count; ++i)
+  {
+    cgltf_vrm_texture_use const* use = &usage->uses[i];
+
+    if (use->texture >= 0)
     {
-      i = cgltf_parse_json_array(options, tokens, i + 1, json_chunk, sizeof(int), (void**)&out->colliders, &out->colliders_count);
-      if (i < 0)
-      {
-        return i;
-      }
-      for (cgltf_size k = 0; k < out->colliders_count; ++k)
+      usage->texture_roles[use->texture] |= 1u << use->role;
+      if (usage->texture_priorities[use->texture] == CGLTF_VRM_TEXTURE_UNUSED)
       {
-        out->colliders[k] = cgltf_json_to_int(tokens + i, json_chunk);
-        ++i;
+        usage->texture_priorities[use->texture] = use->priority;
       }
     }
-    else
+    if (use->image >= 0 && usage->image_priorities[use->image] == CGLTF_VRM_TEXTURE_UNUSED)
     {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.colliderGroups.")
+      usage->image_priorities[use->image] = use->priority;
     }
   }
 
-  return i;
+  return cgltf_result_success;
 }
 
+void cgltf_vrm_texture_usage_free(cgltf_vrm_texture_usage* usage)
+{
+  if (!usage || !usage->memory.free_func)
+  {
+    return;
+  }
+
+  usage->memory.free_func(usage->memory.user_data, usage->uses);
+  usage->memory.free_func(usage->memory.user_data, usage->texture_roles);
+  usage->memory.free_func(usage->memory.user_data, usage->texture_priorities);
+  usage->memory.free_func(usage->memory.user_data, usage->image_priorities);
+  memset(usage, 0, sizeof(cgltf_vrm_texture_usage));
+}
+
+/* ----------- Spring bone simulation ----------- */
+
 static
-int cgltf_vrm_parse_json_spring_bone_spring_joint(jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone_spring_joint* out)
+void cgltf_vrm_quat_mul(cgltf_float const* a, cgltf_float const* b, cgltf_float* out)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  cgltf_float x = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+  cgltf_float y = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+  cgltf_float z = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+  cgltf_float w = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+  out[3] = w;
+}
 
-  memset(out, 0, sizeof(cgltf_vrm_spring_bone_spring_joint));
+static
+void cgltf_vrm_quat_conjugate(cgltf_float const* q, cgltf_float* out)
+{
+  out[0] = -q[0];
+  out[1] = -q[1];
+  out[2] = -q[2];
+  out[3] = q[3];
+}
 
-  int size = tokens[i].size;
-  ++i;
+static
+void cgltf_vrm_quat_rotate(cgltf_float const* q, cgltf_float const* v, cgltf_float* out)
+{
+  /* v + w * t + q x t, with t = 2 * q x v */
+  cgltf_float tx = 2.0f * (q[1] * v[2] - q[2] * v[1]);
+  cgltf_float ty = 2.0f * (q[2] * v[0] - q[0] * v[2]);
+  cgltf_float tz = 2.0f * (q[0] * v[1] - q[1] * v[0]);
+
+  cgltf_float x = v[0] + q[3] * tx + (q[1] * tz - q[2] * ty);
+  cgltf_float y = v[1] + q[3] * ty + (q[2] * tx - q[0] * tz);
+  cgltf_float z = v[2] + q[3] * tz + (q[0] * ty - q[1] * tx);
+
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+}
 
-  for (int j = 0; j < size; ++j)
+/* Shortest arc between two unit vectors. */
+static
+void cgltf_vrm_quat_from_to(cgltf_float const* from, cgltf_float const* to, cgltf_float* out)
+{
+  cgltf_float d = from[0] * to[0] + from[1] * to[1] + from[2] * to[2];
+
+  if (d < -0.999999f)
   {
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "node") == 0)
-    {
-      ++i;
-      out->node = CGLTF_PTRINDEX(cgltf_node, cgltf_json_to_int(tokens + i, json_chunk));
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "dragForce") == 0)
-    {
-      ++i;
-      out->drag_force = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "hitRadius") == 0)
-    {
-      ++i;
-      out->hit_radius = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "stiffness") == 0)
-    {
-      ++i;
-      out->stiffness = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "gravityPower") == 0)
-    {
-      ++i;
-      out->gravity_power = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "gravityDir") == 0)
+    /* Opposite vectors, half turn around any orthogonal axis. */
+    cgltf_float axis[3] = { 0.0f, -from[2], from[1] };
+    if (fabsf(from[0]) > 0.9f)
+    {
+      axis[0] = from[2];
+      axis[1] = 0.0f;
+      axis[2] = -from[0];
+    }
+    cgltf_float length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    out[0] = axis[0] / length;
+    out[1] = axis[1] / length;
+    out[2] = axis[2] / length;
+    out[3] = 0.0f;
+    return;
+  }
+
+  out[0] = from[1] * to[2] - from[2] * to[1];
+  out[1] = from[2] * to[0] - from[0] * to[2];
+  out[2] = from[0] * to[1] - from[1] * to[0];
+  out[3] = 1.0f + d;
+
+  cgltf_float inv_length = 1.0f / sqrtf(out[0] * out[0] + out[1] * out[1] + out[2] * out[2] + out[3] * out[3]);
+  for (int c = 0; c < 4; ++c)
+  {
+    out[c] *= inv_length;
+  }
+}
+
+/* Rotation of a column major transform, its scale removed. */
+static
+void cgltf_vrm_quat_from_matrix(cgltf_float const* m, cgltf_float* out)
+{
+  cgltf_float r[9];
+
+  for (int c = 0; c < 3; ++c)
+  {
+    cgltf_float length = sqrtf(m[4 * c] * m[4 * c] + m[4 * c + 1] * m[4 * c + 1] + m[4 * c + 2] * m[4 * c + 2]);
+    cgltf_float inv_length = (length > 0.0f) ? 1.0f / length : 0.0f;
+    for (int k = 0; k < 3; ++k)
     {
-      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->gravity_dir, 3);
+      r[3 * c + k] = m[4 * c + k] * inv_length;
     }
-    else
+  }
+
+  /* r[3 * column + row] */
+  cgltf_float m00 = r[0], m10 = r[1], m20 = r[2];
+  cgltf_float m01 = r[3], m11 = r[4], m21 = r[5];
+  cgltf_float m02 = r[6], m12 = r[7], m22 = r[8];
+  cgltf_float trace = m00 + m11 + m22;
+
+  if (trace > 0.0f)
+  {
+    cgltf_float s = 0.5f / sqrtf(trace + 1.0f);
+    out[0] = (m21 - m12) * s;
+    out[1] = (m02 - m20) * s;
+    out[2] = (m10 - m01) * s;
+    out[3] = 0.25f / s;
+  }
+  else if (m00 > m11 && m00 > m22)
+  {
+    cgltf_float s = 2.0f * sqrtf(1.0f + m00 - m11 - m22);
+    out[0] = 0.25f * s;
+    out[1] = (m01 + m10) / s;
+    out[2] = (m02 + m20) / s;
+    out[3] = (m21 - m12) / s;
+  }
+  else if (m11 > m22)
+  {
+    cgltf_float s = 2.0f * sqrtf(1.0f + m11 - m00 - m22);
+    out[0] = (m01 + m10) / s;
+    out[1] = 0.25f * s;
+    out[2] = (m12 + m21) / s;
+    out[3] = (m02 - m20) / s;
+  }
+  else
+  {
+    cgltf_float s = 2.0f * sqrtf(1.0f + m22 - m00 - m11);
+    out[0] = (m02 + m20) / s;
+    out[1] = (m12 + m21) / s;
+    out[2] = 0.25f * s;
+    out[3] = (m10 - m01) / s;
+  }
+}
+
+static
+void cgltf_vrm_quat_slerp(cgltf_float const* a, cgltf_float const* b, cgltf_float t, cgltf_float* out)
+{
+  cgltf_float qb[4];
+  memcpy(qb, b, sizeof(qb));
+  memmove(out, a, sizeof(cgltf_float) * 4);
+
+  cgltf_float* pa[4] = { out, out + 1, out + 2, out + 3 };
+  cgltf_float* pb[4] = { qb, qb + 1, qb + 2, qb + 3 };
+  cgltf_vrm_quat_slerp_batch(1, &t, pa, pb);
+}
+
+static
+void cgltf_vrm_matrix_compose(cgltf_float const* t, cgltf_float const* q, cgltf_float const* s, cgltf_float* out)
+{
+  cgltf_float x = q[0], y = q[1], z = q[2], w = q[3];
+
+  out[0] = (1.0f - 2.0f * (y * y + z * z)) * s[0];
+  out[1] = 2.0f * (x * y + z * w) * s[0];
+  out[2] = 2.0f * (x * z - y * w) * s[0];
+  out[3] = 0.0f;
+  out[4] = 2.0f * (x * y - z * w) * s[1];
+  out[5] = (1.0f - 2.0f * (x * x + z * z)) * s[1];
+  out[6] = 2.0f * (y * z + x * w) * s[1];
+  out[7] = 0.0f;
+  out[8] = 2.0f * (x * z + y * w) * s[2];
+  out[9] = 2.0f * (y * z - x * w) * s[2];
+  out[10] = (1.0f - 2.0f * (x * x + y * y)) * s[2];
+  out[11] = 0.0f;
+  out[12] = t[0];
+  out[13] = t[1];
+  out[14] = t[2];
+  out[15] = 1.0f;
+}
+
+/* out = a * b, column major, `out` must not alias the inputs. */
+static
+void cgltf_vrm_matrix_multiply(cgltf_float const* a, cgltf_float const* b, cgltf_float* out)
+{
+  for (int c = 0; c < 4; ++c)
+  {
+    for (int r = 0; r < 4; ++r)
     {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.springJoints.")
+      out[4 * c + r] = a[r] * b[4 * c] + a[4 + r] * b[4 * c + 1] + a[8 + r] * b[4 * c + 2] + a[12 + r] * b[4 * c + 3];
     }
   }
+}
 
-  return i;
+static
+void cgltf_vrm_node_rest_transform(cgltf_node const* node, cgltf_float* t, cgltf_float* q, cgltf_float* s)
+{
+  if (!node->has_matrix)
+  {
+    memcpy(t, node->translation, sizeof(cgltf_float) * 3);
+    memcpy(q, node->rotation, sizeof(cgltf_float) * 4);
+    memcpy(s, node->scale, sizeof(cgltf_float) * 3);
+    return;
+  }
+
+  cgltf_float const* m = node->matrix;
+  for (int c = 0; c < 3; ++c)
+  {
+    t[c] = m[12 + c];
+    s[c] = sqrtf(m[4 * c] * m[4 * c] + m[4 * c + 1] * m[4 * c + 1] + m[4 * c + 2] * m[4 * c + 2]);
+  }
+  cgltf_vrm_quat_from_matrix(m, q);
 }
 
 static
-int cgltf_vrm_parse_json_spring_bone_springs(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone_spring* out)
+void cgltf_vrm_normalize3(cgltf_float* v, cgltf_float const* fallback)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  cgltf_float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
 
-  cgltf_size size = tokens[i].size;
-  ++i;
+  for (int c = 0; c < 3; ++c)
+  {
+    v[c] = (length > 0.0f) ? v[c] / length : fallback[c];
+  }
+}
 
-  for (cgltf_size j = 0; j < size; ++j)
+cgltf_result cgltf_vrm_spring_bone_state_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_spring_bone const* spring_bone, cgltf_vrm_spring_bone_state* state)
+{
+  static const cgltf_float axis_y[3] = { 0.0f, 1.0f, 0.0f };
+  cgltf_options fixed_options;
+  cgltf_size joints_count = 0;
+  cgltf_size colliders_count = 0;
+
+  if (options == NULL || gltf == NULL || spring_bone == NULL || state == NULL)
   {
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "name") == 0)
+    return cgltf_result_invalid_options;
+  }
+
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
+
+  memset(state, 0, sizeof(cgltf_vrm_spring_bone_state));
+  state->memory = fixed_options.memory;
+  state->springs_count = spring_bone->springs_count;
+
+  for (cgltf_size s = 0; s < spring_bone->springs_count; ++s)
+  {
+    cgltf_vrm_spring_bone_spring const* spring = &spring_bone->springs[s];
+
+    for (cgltf_size i = 0; i + 1 < spring->joints_count; ++i)
     {
-      i = cgltf_parse_json_string(options, tokens, i + 1, json_chunk, &out->name);
+      joints_count += (spring->joints[i].node != NULL && spring->joints[i + 1].node != NULL);
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "joints") == 0)
+    for (cgltf_size g = 0; g < spring->collider_groups_count; ++g)
     {
-      i = cgltf_parse_json_array(options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_spring_bone_spring_joint), (void**)&out->joints, &out->joints_count);
-      if (i < 0)
+      cgltf_int group = spring->collider_groups[g];
+      if (group >= 0 && (cgltf_size)group < spring_bone->collider_groups_count)
       {
-        return i;
+        colliders_count += spring_bone->collider_groups[group].colliders_count;
       }
-      for (cgltf_size k = 0; k < out->joints_count; ++k)
+    }
+  }
+
+  state->nodes = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), joints_count + 1);
+  state->tails = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), joints_count + 1);
+  state->parents = (cgltf_int*)cgltf_calloc(&fixed_options, sizeof(cgltf_int), joints_count + 1);
+  state->spring_joints = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), state->springs_count + 1);
+  state->spring_colliders = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), state->springs_count + 1);
+  state->colliders = (cgltf_int*)cgltf_calloc(&fixed_options, sizeof(cgltf_int), colliders_count + 1);
+  state->storage = (cgltf_float*)cgltf_calloc(&fixed_options, sizeof(cgltf_float), joints_count * 33 + 1);
+  if (!state->nodes || !state->tails || !state->parents || !state->spring_joints || !state->spring_colliders || !state->colliders || !state->storage)
+  {
+    cgltf_vrm_spring_bone_state_free(state);
+    return cgltf_result_out_of_memory;
+  }
+
+  cgltf_float* storage = state->storage;
+  for (int c = 0; c < 4; ++c)
+  {
+    state->rest_rotation[c] = storage + joints_count * c;
+    state->rotation[c] = storage + joints_count * (4 + c);
+  }
+  for (int c = 0; c < 3; ++c)
+  {
+    state->rest_translation[c] = storage + joints_count * (8 + c);
+    state->rest_scale[c] = storage + joints_count * (11 + c);
+    state->bone_axis[c] = storage + joints_count * (14 + c);
+    state->gravity[c] = storage + joints_count * (17 + c);
+    state->prev_tail[c] = storage + joints_count * (20 + c);
+    state->current_tail[c] = storage + joints_count * (23 + c);
+  }
+  state->bone_length = storage + joints_count * 26;
+  state->stiffness = storage + joints_count * 27;
+  state->drag = storage + joints_count * 28;
+  state->hit_radius = storage + joints_count * 29;
+
+  cgltf_size j = 0;
+  cgltf_size k = 0;
+  for (cgltf_size s = 0; s < spring_bone->springs_count; ++s)
+  {
+    cgltf_vrm_spring_bone_spring const* spring = &spring_bone->springs[s];
+
+    state->spring_joints[s] = (cgltf_uint)j;
+    state->spring_colliders[s] = (cgltf_uint)k;
+
+    for (cgltf_size g = 0; g < spring->collider_groups_count; ++g)
+    {
+      cgltf_int group = spring->collider_groups[g];
+      if (group >= 0 && (cgltf_size)group < spring_bone->collider_groups_count)
       {
-        i = cgltf_vrm_parse_json_spring_bone_spring_joint(tokens, i, json_chunk, &out->joints[k]);
+        cgltf_vrm_spring_bone_collider_group const* collider_group = &spring_bone->collider_groups[group];
+        memcpy(state->colliders + k, collider_group->colliders, sizeof(cgltf_int) * collider_group->colliders_count);
+        k += collider_group->colliders_count;
       }
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "colliderGroups") == 0)
+
+    for (cgltf_size i = 0; i + 1 < spring->joints_count; ++i)
     {
-      i = cgltf_parse_json_array(options, tokens, i + 1, json_chunk, sizeof(int), (void**)&out->collider_groups, &out->collider_groups_count);
-      if (i < 0)
+      cgltf_vrm_spring_bone_spring_joint const* joint = &spring->joints[i];
+      cgltf_node const* head = joint->node;
+      cgltf_node const* tail = spring->joints[i + 1].node;
+      cgltf_float head_world[16];
+      cgltf_float tail_world[16];
+      cgltf_float t[3], q[4], scale[3], axis[3];
+
+      if (head == NULL || tail == NULL)
       {
-        return i;
+        continue;
       }
-      for (cgltf_size k = 0; k < out->collider_groups_count; ++k)
+
+      state->nodes[j] = (cgltf_uint)(head - gltf->nodes);
+      state->tails[j] = (cgltf_uint)(tail - gltf->nodes);
+      state->parents[j] = head->parent ? (cgltf_int)(head->parent - gltf->nodes) : -1;
+
+      cgltf_vrm_node_rest_transform(head, t, q, scale);
+      cgltf_node_transform_world(head, head_world);
+      cgltf_node_transform_world(tail, tail_world);
+
+      if (tail->parent == head)
       {
-        out->collider_groups[k] = cgltf_json_to_int(tokens + i, json_chunk);
-        ++i;
+        cgltf_float tail_q[4], tail_scale[3];
+        cgltf_vrm_node_rest_transform(tail, axis, tail_q, tail_scale);
       }
+      else
+      {
+        /* Not a child, bring the world offset into the head space. */
+        cgltf_float head_q[4], offset[3];
+        cgltf_vrm_quat_from_matrix(head_world, head_q);
+        cgltf_vrm_quat_conjugate(head_q, head_q);
+        for (int c = 0; c < 3; ++c)
+        {
+          offset[c] = tail_world[12 + c] - head_world[12 + c];
+        }
+        cgltf_vrm_quat_rotate(head_q, offset, axis);
+      }
+      cgltf_vrm_normalize3(axis, axis_y);
+
+      cgltf_float length = 0.0f;
+      for (int c = 0; c < 3; ++c)
+      {
+        cgltf_float d = tail_world[12 + c] - head_world[12 + c];
+        length += d * d;
+      }
+
+      for (int c = 0; c < 4; ++c)
+      {
+        state->rest_rotation[c][j] = q[c];
+        state->rotation[c][j] = q[c];
+      }
+      for (int c = 0; c < 3; ++c)
+      {
+        state->rest_translation[c][j] = t[c];
+        state->rest_scale[c][j] = scale[c];
+        state->bone_axis[c][j] = axis[c];
+        state->gravity[c][j] = joint->gravity_dir[c] * joint->gravity_power;
+        state->prev_tail[c][j] = tail_world[12 + c];
+        state->current_tail[c][j] = tail_world[12 + c];
+      }
+      state->bone_length[j] = sqrtf(length);
+      state->stiffness[j] = joint->stiffness;
+      state->drag[j] = joint->drag_force;
+      state->hit_radius[j] = joint->hit_radius;
+      ++j;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "center") == 0)
-    {
-      ++i;
-      out->center = CGLTF_PTRINDEX(cgltf_node, cgltf_json_to_int(tokens + i, json_chunk));
-      ++i;
-    }
-    else
+  }
+
+  state->spring_joints[state->springs_count] = (cgltf_uint)j;
+  state->spring_colliders[state->springs_count] = (cgltf_uint)k;
+  state->joints_count = j;
+
+  return cgltf_result_success;
+}
+
+void cgltf_vrm_spring_bone_state_reset(cgltf_vrm_spring_bone_state* state, cgltf_float const* world_matrices)
+{
+  for (cgltf_size j = 0; j < state->joints_count; ++j)
+  {
+    cgltf_float const* tail = world_matrices + 16 * state->tails[j];
+
+    for (int c = 0; c < 3; ++c)
     {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.springs.")
+      state->prev_tail[c][j] = tail[12 + c];
+      state->current_tail[c][j] = tail[12 + c];
     }
   }
-
-  return i;
 }
 
+/* Keeps the tail on the sphere of the bone length around the head. */
 static
-int cgltf_vrm_parse_json_spring_bone(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_spring_bone* out)
+void cgltf_vrm_spring_bone_constrain_length(cgltf_float const* head, cgltf_float* tail, cgltf_float const* rest_direction, cgltf_float length)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  cgltf_float direction[3] = { tail[0] - head[0], tail[1] - head[1], tail[2] - head[2] };
 
-  memset(out, 0, sizeof(cgltf_vrm_spring_bone));
+  cgltf_vrm_normalize3(direction, rest_direction);
+  for (int c = 0; c < 3; ++c)
+  {
+    tail[c] = head[c] + direction[c] * length;
+  }
+}
 
-  int size = tokens[i].size;
-  ++i;
+/* The VRMC_springBone integration, joint after joint down each chain :
+ *   next = current + (current - prev) * (1 - drag) + rest direction * stiffness * dt + gravity * dt,
+ * projected back to the bone length, pushed out of the colliders, then the head is rotated from its rest
+ * direction toward the new tail. */
+void cgltf_vrm_spring_bone_state_step(cgltf_vrm_spring_bone_state* state, cgltf_data const* gltf, cgltf_vrm_spring_bone_collider_set const* colliders, cgltf_float* world_matrices, cgltf_float delta_time)
+{
+  static const cgltf_float identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
 
-  for (int j = 0; j < size; ++j)
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_spring_bone_state_step");
+  for (cgltf_size s = 0; s < state->springs_count; ++s)
   {
-    CGLTF_CHECK_KEY(tokens[i]);
+    cgltf_size begin = state->spring_joints[s];
+    cgltf_size end = state->spring_joints[s + 1];
+    cgltf_int const* spring_colliders = state->colliders + state->spring_colliders[s];
+    cgltf_size spring_colliders_count = state->spring_colliders[s + 1] - state->spring_colliders[s];
 
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "specVersion") == 0)
-    {
-      ++i;
-      out->spec_version = cgltf_vrm_string_to_spec_version(tokens, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "colliders") == 0)
+    for (cgltf_size j = begin; j < end; ++j)
     {
-      i = cgltf_parse_json_array(options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_spring_bone_collider), (void**)&out->colliders, &out->colliders_count);
-      if (i < 0)
+      cgltf_float const* parent = (state->parents[j] >= 0) ? world_matrices + 16 * state->parents[j] : identity;
+      cgltf_float t[3], q[4], scale[3], axis[3];
+      cgltf_float head[3], parent_q[4], rest_q[4], rest_direction[3];
+      cgltf_float next[3], direction[3], from_to[4], local[16];
+
+      for (int c = 0; c < 3; ++c)
       {
-        return i;
+        t[c] = state->rest_translation[c][j];
+        scale[c] = state->rest_scale[c][j];
+        axis[c] = state->bone_axis[c][j];
       }
-      for (cgltf_size k = 0; k < out->colliders_count; ++k)
+      for (int c = 0; c < 4; ++c)
       {
-        i = cgltf_vrm_parse_json_spring_bone_colliders(options, tokens, i, json_chunk, &out->colliders[k]);
-        if (i < 0)
-        {
-          return i;
-        }
+        q[c] = state->rest_rotation[c][j];
       }
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "colliderGroups") == 0)
-    {
-      i = cgltf_parse_json_array(options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_spring_bone_collider_group), (void**)&out->collider_groups, &out->collider_groups_count);
-      if (i < 0)
+
+      cgltf_vrm_transform_point(parent, t, head);
+      cgltf_vrm_quat_from_matrix(parent, parent_q);
+      cgltf_vrm_quat_mul(parent_q, q, rest_q);
+      cgltf_vrm_quat_rotate(rest_q, axis, rest_direction);
+
+      cgltf_float inertia = 1.0f - state->drag[j];
+      cgltf_float stiffness = state->stiffness[j] * delta_time;
+      for (int c = 0; c < 3; ++c)
       {
-        return i;
+        cgltf_float current = state->current_tail[c][j];
+        next[c] = current + (current - state->prev_tail[c][j]) * inertia + rest_direction[c] * stiffness + state->gravity[c][j] * delta_time;
       }
-      for (cgltf_size k = 0; k < out->collider_groups_count; ++k)
+      cgltf_vrm_spring_bone_constrain_length(head, next, rest_direction, state->bone_length[j]);
+
+      if (colliders != NULL && spring_colliders_count > 0)
       {
-        i = cgltf_vrm_parse_json_spring_bone_collider_groups(options, tokens, i, json_chunk, &out->collider_groups[k]);
-        if (i < 0)
+        if (cgltf_vrm_spring_bone_collide(colliders, spring_colliders, spring_colliders_count, 1, &next[0], &next[1], &next[2], &state->hit_radius[j]) > 0)
         {
-          return i;
+          cgltf_vrm_spring_bone_constrain_length(head, next, rest_direction, state->bone_length[j]);
         }
       }
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "springs") == 0)
-    {
-      i = cgltf_parse_json_array(options, tokens, i + 1, json_chunk, sizeof(cgltf_vrm_spring_bone_spring), (void**)&out->springs, &out->springs_count);
-      if (i < 0)
+
+      for (int c = 0; c < 3; ++c)
       {
-        return i;
+        state->prev_tail[c][j] = state->current_tail[c][j];
+        state->current_tail[c][j] = next[c];
+        direction[c] = next[c] - head[c];
       }
-      for (cgltf_size k = 0; k < out->springs_count; ++k)
+      cgltf_vrm_normalize3(direction, rest_direction);
+
+      /* local = inverse(parent) * fromTo * parent * rest */
+      cgltf_vrm_quat_from_to(rest_direction, direction, from_to);
+      cgltf_vrm_quat_mul(from_to, rest_q, q);
+      cgltf_vrm_quat_conjugate(parent_q, parent_q);
+      cgltf_vrm_quat_mul(parent_q, q, q);
+      for (int c = 0; c < 4; ++c)
       {
-        i = cgltf_vrm_parse_json_spring_bone_springs(options, tokens, i, json_chunk, &out->springs[k]);
-        if (i < 0)
-        {
-          return i;
-        }
+        state->rotation[c][j] = q[c];
       }
-    }
-    else
-    {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_springBone.")
-    }
 
-    if (i < 0)
-    {
-      return i;
+      cgltf_float* world = world_matrices + 16 * state->nodes[j];
+      cgltf_vrm_matrix_compose(t, q, scale, local);
+      cgltf_vrm_matrix_multiply(parent, local, world);
+
+      if (j + 1 == end)
+      {
+        cgltf_node_transform_local(&gltf->nodes[state->tails[j]], local);
+        cgltf_vrm_matrix_multiply(world, local, world_matrices + 16 * state->tails[j]);
+      }
     }
   }
-
-  return i;
+  CGLTF_VRM_PROFILE_END(NULL, zone);
 }
 
-/* ----------- VRMC_node_constraint ----------- */
-
-static
-cgltf_int cgltf_vrm_node_extension_index(cgltf_node* node, char const* extension)
+void cgltf_vrm_spring_bone_state_free(cgltf_vrm_spring_bone_state* state)
 {
-  if (node == NULL || extension == NULL)
+  if (!state || !state->memory.free_func)
   {
-    return -1;
+    return;
   }
 
-  for (cgltf_size i = 0; i < node->extensions_count; ++i)
-  {
-    if (strcmp(node->extensions[i].name, extension) == 0)
-    {
-      return i;
-    }
-  }
-  return -1;
+  state->memory.free_func(state->memory.user_data, state->nodes);
+  state->memory.free_func(state->memory.user_data, state->tails);
+  state->memory.free_func(state->memory.user_data, state->parents);
+  state->memory.free_func(state->memory.user_data, state->spring_joints);
+  state->memory.free_func(state->memory.user_data, state->spring_colliders);
+  state->memory.free_func(state->memory.user_data, state->colliders);
+  state->memory.free_func(state->memory.user_data, state->storage);
+  memset(state, 0, sizeof(cgltf_vrm_spring_bone_state));
 }
 
-static
-cgltf_extension* cgltf_vrm_get_node_extension(cgltf_node* node, char const* extension)
-{
-  cgltf_int index = cgltf_vrm_node_extension_index(node, extension);
-  return (index >= 0) ? &node->extensions[index] : NULL;
-}
+/* ----------- Node constraints ----------- */
 
-static
-int cgltf_vrm_parse_json_node_constraint(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_node_constraint* out)
+cgltf_result cgltf_vrm_node_constraint_set_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_node_constraint_set* set)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  cgltf_options fixed_options;
+  cgltf_size count = 0;
 
-  memset(out, 0, sizeof(cgltf_vrm_node_constraint));
+  if (options == NULL || gltf == NULL || vrm == NULL || set == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
 
-  int size = tokens[i].size;
-  ++i;
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
 
-  for (int j = 0; j < size; ++j)
+  memset(set, 0, sizeof(cgltf_vrm_node_constraint_set));
+  set->memory = fixed_options.memory;
+
+  cgltf_size nodes_count = (vrm->extended_nodes_count < gltf->nodes_count) ? vrm->extended_nodes_count : gltf->nodes_count;
+  for (cgltf_size n = 0; n < nodes_count; ++n)
   {
-    CGLTF_CHECK_KEY(tokens[i]);
+    cgltf_vrm_extended_node const* node = &vrm->extended_nodes[n];
+    count += (node->has_node_constraint && node->node_constraint.source != NULL);
+  }
 
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "specVersion") == 0)
+  set->nodes = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), count + 1);
+  set->sources = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), count + 1);
+  set->parents = (cgltf_int*)cgltf_calloc(&fixed_options, sizeof(cgltf_int), count + 1);
+  set->types = (uint8_t*)cgltf_calloc(&fixed_options, sizeof(uint8_t), count + 1);
+  set->axes = (uint8_t*)cgltf_calloc(&fixed_options, sizeof(uint8_t), count + 1);
+  set->storage = (cgltf_float*)cgltf_calloc(&fixed_options, sizeof(cgltf_float), count * 9 + 1);
+  /* constrained nodes, their depth in the constraint graph, then the constraint of every node */
+  cgltf_int* scratch = (cgltf_int*)cgltf_calloc(&fixed_options, sizeof(cgltf_int), count * 2 + nodes_count + 1);
+  if (!set->nodes || !set->sources || !set->parents || !set->types || !set->axes || !set->storage || !scratch)
+  {
+    fixed_options.memory.free_func(fixed_options.memory.user_data, scratch);
+    cgltf_vrm_node_constraint_set_free(set);
+    return cgltf_result_out_of_memory;
+  }
+
+  set->weights = set->storage;
+  for (int c = 0; c < 4; ++c)
+  {
+    set->dst_rest_rotation[c] = set->storage + count * (1 + c);
+    set->src_rest_rotation[c] = set->storage + count * (5 + c);
+  }
+
+  cgltf_int* order = scratch;
+  cgltf_int* depths = scratch + count;
+  cgltf_int* node_constraints = scratch + count * 2;
+  cgltf_size k = 0;
+  for (cgltf_size n = 0; n < nodes_count; ++n)
+  {
+    cgltf_vrm_extended_node const* node = &vrm->extended_nodes[n];
+    node_constraints[n] = -1;
+    if (node->has_node_constraint && node->node_constraint.source != NULL)
     {
-      ++i;
-      out->spec_version = cgltf_vrm_string_to_spec_version(tokens, json_chunk);
-      ++i;
+      node_constraints[n] = (cgltf_int)k;
+      order[k++] = (cgltf_int)n;
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "constraint") == 0)
-    {
-      i += 2;
-      out->type = cgltf_vrm_string_to_node_constraint_type(tokens + i, json_chunk);
-      ++i;
-
-      cgltf_size nElems = tokens[i].size;
-      ++i;
+  }
 
-      for (cgltf_size k = 0; k < nElems; ++k)
+  /* A constraint goes one level below the constraint driving its source, cycles stop deepening after count passes. */
+  for (cgltf_size pass = 0; pass < count; ++pass)
+  {
+    cgltf_bool changed = 0;
+    for (cgltf_size i = 0; i < count; ++i)
+    {
+      cgltf_size source = (cgltf_size)(vrm->extended_nodes[order[i]].node_constraint.source - gltf->nodes);
+      cgltf_int driver = (source < nodes_count) ? node_constraints[source] : -1;
+      if (driver >= 0 && depths[i] < depths[driver] + 1)
       {
-        if (cgltf_json_strcmp(tokens + i, json_chunk, "source") == 0)
-        {
-          ++i;
-          out->source = CGLTF_PTRINDEX(cgltf_node, cgltf_json_to_int(tokens + i, json_chunk));
-          ++i;
-        }
-        else if (cgltf_json_strcmp(tokens + i, json_chunk, "weight") == 0)
-        {
-          ++i;
-          out->weight = cgltf_json_to_float(tokens + i, json_chunk);
-          ++i;
-        }
-        else if (cgltf_json_strcmp(tokens + i, json_chunk, "aimAxis") == 0)
-        {
-          ++i;
-          out->axis.aim = cgltf_vrm_string_to_node_constraint_aim_axis(tokens + i, json_chunk);
-          ++i;
-        }
-        else if (cgltf_json_strcmp(tokens + i, json_chunk, "rollAxis") == 0)
-        {
-          ++i;
-          out->axis.roll = cgltf_vrm_string_to_node_constraint_roll_axis(tokens + i, json_chunk);
-          ++i;
-        }
-        else
-        {
-          CGLTF_VRM_LOG_SKIPPED("VRMC_node_constraint.constraint.")
-        }
+        depths[i] = depths[driver] + 1;
+        changed = 1;
       }
     }
-    else
+    if (!changed)
+    {
+      break;
+    }
+  }
+
+  /* Stable insertion sort by depth, constraint graphs are small. */
+  for (cgltf_size i = 1; i < count; ++i)
+  {
+    cgltf_int node = order[i];
+    cgltf_int depth = depths[i];
+    cgltf_size p = i;
+    for (; p > 0 && depths[p - 1] > depth; --p)
+    {
+      order[p] = order[p - 1];
+      depths[p] = depths[p - 1];
+    }
+    order[p] = node;
+    depths[p] = depth;
+  }
+
+  for (cgltf_size i = 0; i < count; ++i)
+  {
+    cgltf_node const* node = &gltf->nodes[order[i]];
+    cgltf_vrm_node_constraint const* constraint = &vrm->extended_nodes[order[i]].node_constraint;
+    cgltf_float t[3], q[4], scale[3];
+
+    set->nodes[i] = (cgltf_uint)order[i];
+    set->sources[i] = (cgltf_uint)(constraint->source - gltf->nodes);
+    set->parents[i] = node->parent ? (cgltf_int)(node->parent - gltf->nodes) : -1;
+    set->types[i] = (uint8_t)constraint->type;
+    set->axes[i] = (uint8_t)((constraint->type == cgltf_vrm_node_constraint_type_roll) ? (int)constraint->axis.roll
+      : (constraint->type == cgltf_vrm_node_constraint_type_aim) ? (int)constraint->axis.aim : 0);
+    set->weights[i] = constraint->weight;
+
+    cgltf_vrm_node_rest_transform(node, t, q, scale);
+    for (int c = 0; c < 4; ++c)
     {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_node_constraint.")
+      set->dst_rest_rotation[c][i] = q[c];
     }
-
-    if (i < 0)
+    cgltf_vrm_node_rest_transform(constraint->source, t, q, scale);
+    for (int c = 0; c < 4; ++c)
     {
-      return i;
+      set->src_rest_rotation[c][i] = q[c];
     }
   }
+  set->constraints_count = count;
 
-  return i;
+  fixed_options.memory.free_func(fixed_options.memory.user_data, scratch);
+  return cgltf_result_success;
 }
 
-/* ----------- VRMC_materials_mtoon ----------- */
-
-static
-cgltf_int cgltf_vrm_material_extension_index(cgltf_material* material, char const* extension)
+/* The VRMC_node_constraint formulas, each result is slerped from the destination rest rotation by the weight :
+ *   rotation : dstRest * inverse(srcRest) * src
+ *   roll : dstRest * the twist around the roll axis of the source delta, expressed in the destination space
+ *   aim : inverse(parentWorld) * fromTo(aim axis, direction to the source) * parentWorld * dstRest */
+void cgltf_vrm_node_constraint_set_evaluate(cgltf_vrm_node_constraint_set const* set, cgltf_float* local_rotations, cgltf_float const* world_matrices)
 {
-  if (material == NULL || extension == NULL)
-  {
-    return -1;
-  }
+  static const cgltf_float identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
 
-  for (cgltf_size i = 0; i < material->extensions_count; ++i)
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_node_constraint_set_evaluate");
+  for (cgltf_size i = 0; i < set->constraints_count; ++i)
   {
-    if (strcmp(material->extensions[i].name, extension) == 0)
+    cgltf_float* dst = local_rotations + 4 * set->nodes[i];
+    cgltf_float const* src = local_rotations + 4 * set->sources[i];
+    cgltf_float dst_rest[4], src_rest[4], inverse[4], delta[4], target[4];
+
+    for (int c = 0; c < 4; ++c)
     {
-      return i;
+      dst_rest[c] = set->dst_rest_rotation[c][i];
+      src_rest[c] = set->src_rest_rotation[c][i];
+    }
+
+    switch (set->types[i])
+    {
+      case cgltf_vrm_node_constraint_type_rotation:
+        cgltf_vrm_quat_conjugate(src_rest, inverse);
+        cgltf_vrm_quat_mul(inverse, src, delta);
+        cgltf_vrm_quat_mul(dst_rest, delta, target);
+        break;
+
+      case cgltf_vrm_node_constraint_type_roll:
+      {
+        cgltf_float axis[3] = { 0.0f, 0.0f, 0.0f };
+        cgltf_float to[3], swing[4];
+        axis[set->axes[i] % 3] = 1.0f;
+
+        /* source delta in the parent space, then in the destination rest space */
+        cgltf_vrm_quat_conjugate(src_rest, inverse);
+        cgltf_vrm_quat_mul(src, inverse, delta);
+        cgltf_vrm_quat_mul(delta, dst_rest, delta);
+        cgltf_vrm_quat_conjugate(dst_rest, inverse);
+        cgltf_vrm_quat_mul(inverse, delta, delta);
+
+        /* remove the swing, keeping the twist around the axis */
+        cgltf_vrm_quat_rotate(delta, axis, to);
+        cgltf_vrm_quat_from_to(axis, to, swing);
+        cgltf_vrm_quat_conjugate(swing, swing);
+        cgltf_vrm_quat_mul(swing, delta, delta);
+        cgltf_vrm_quat_mul(dst_rest, delta, target);
+        break;
+      }
+
+      case cgltf_vrm_node_constraint_type_aim:
+      {
+        cgltf_float axis[3] = { 0.0f, 0.0f, 0.0f };
+        cgltf_float parent_q[4], from[3], to[3], from_to[4];
+
+        if (world_matrices == NULL)
+        {
+          continue;
+        }
+
+        axis[(set->axes[i] / 2) % 3] = (set->axes[i] % 2) ? -1.0f : 1.0f;
+        cgltf_float const* parent = (set->parents[i] >= 0) ? world_matrices + 16 * set->parents[i] : identity;
+        cgltf_float const* dst_world = world_matrices + 16 * set->nodes[i];
+        cgltf_float const* src_world = world_matrices + 16 * set->sources[i];
+
+        cgltf_vrm_quat_from_matrix(parent, parent_q);
+        cgltf_vrm_quat_mul(parent_q, dst_rest, delta);
+        cgltf_vrm_quat_rotate(delta, axis, from);
+        for (int c = 0; c < 3; ++c)
+        {
+          to[c] = src_world[12 + c] - dst_world[12 + c];
+        }
+        cgltf_vrm_normalize3(to, from);
+
+        cgltf_vrm_quat_from_to(from, to, from_to);
+        cgltf_vrm_quat_mul(from_to, delta, delta);
+        cgltf_vrm_quat_conjugate(parent_q, parent_q);
+        cgltf_vrm_quat_mul(parent_q, delta, target);
+        break;
+      }
+
+      default:
+        continue;
     }
+
+    cgltf_vrm_quat_slerp(dst_rest, target, set->weights[i], dst);
   }
-  return -1;
+  CGLTF_VRM_PROFILE_END(NULL, zone);
+}
+
+void cgltf_vrm_node_constraint_set_free(cgltf_vrm_node_constraint_set* set)
+{
+  if (!set || !set->memory.free_func)
+  {
+    return;
+  }
+
+  set->memory.free_func(set->memory.user_data, set->nodes);
+  set->memory.free_func(set->memory.user_data, set->sources);
+  set->memory.free_func(set->memory.user_data, set->parents);
+  set->memory.free_func(set->memory.user_data, set->types);
+  set->memory.free_func(set->memory.user_data, set->axes);
+  set->memory.free_func(set->memory.user_data, set->storage);
+  memset(set, 0, sizeof(cgltf_vrm_node_constraint_set));
 }
 
+/* ----------- Look at ----------- */
+
 static
-cgltf_extension* cgltf_vrm_get_material_extension(cgltf_material* material, char const* extension)
+cgltf_float cgltf_vrm_look_at_map(cgltf_vrm_look_at_range_map const* map, cgltf_float angle)
 {
-  cgltf_int index = cgltf_vrm_material_extension_index(material, extension);
-  return (index >= 0) ? &material->extensions[index] : NULL;
+  if (map->input_max_value <= 0.0f)
+  {
+    return 0.0f;
+  }
+  return fminf(angle, map->input_max_value) / map->input_max_value * map->output_scale;
 }
 
 static
-int cgltf_vrm_parse_json_mtoon_texture_info(jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_mtoon_texture_info* out)
+void cgltf_vrm_look_at_eye(cgltf_float yaw, cgltf_float pitch, cgltf_float* out)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  /* yaw around +Y, then pitch around -X (+Z turns up for positive angles) */
+  cgltf_float const to_half_radians = 0.5f * 3.14159265358979f / 180.0f;
+  cgltf_float const q_yaw[4] = { 0.0f, sinf(yaw * to_half_radians), 0.0f, cosf(yaw * to_half_radians) };
+  cgltf_float const q_pitch[4] = { -sinf(pitch * to_half_radians), 0.0f, 0.0f, cosf(pitch * to_half_radians) };
 
-  memset(out, 0, sizeof(cgltf_vrm_mtoon_texture_info));
+  cgltf_vrm_quat_mul(q_yaw, q_pitch, out);
+}
 
-  cgltf_size size = tokens[i].size;
-  ++i;
+void cgltf_vrm_look_at_evaluate(cgltf_vrm_look_at const* look_at, cgltf_float const* head_world_matrix, cgltf_float const* target, cgltf_vrm_look_at_pose* out)
+{
+  cgltf_float const to_degrees = 180.0f / 3.14159265358979f;
+  cgltf_float eye[3], offset[3], local[3];
 
-  for (cgltf_size j = 0; j < size; ++j)
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_look_at_evaluate");
+  cgltf_vrm_transform_point(head_world_matrix, look_at->offset_from_head_bone, eye);
+  for (int c = 0; c < 3; ++c)
   {
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "index") == 0)
-    {
-      ++i;
-      out->index = cgltf_json_to_int(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "texCoord") == 0)
-    {
-      ++i;
-      out->tex_coord = cgltf_json_to_int(tokens + i, json_chunk);
-      ++i;
-    }
-    else
-    {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_materials_mtoon.textureInfo.")
-    }
+    offset[c] = target[c] - eye[c];
   }
 
-  return i;
+  /* into the head space, without its scale */
+  for (int c = 0; c < 3; ++c)
+  {
+    cgltf_float const* column = head_world_matrix + 4 * c;
+    cgltf_float length = sqrtf(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]);
+    local[c] = (length > 0.0f) ? (column[0] * offset[0] + column[1] * offset[1] + column[2] * offset[2]) / length : 0.0f;
+  }
+
+  cgltf_float yaw = atan2f(local[0], local[2]) * to_degrees;
+  cgltf_float pitch = atan2f(local[1], sqrtf(local[0] * local[0] + local[2] * local[2])) * to_degrees;
+  out->yaw = yaw;
+  out->pitch = pitch;
+
+  /* Looking toward +X turns the left eye outward and the right eye inward. */
+  cgltf_float outer = cgltf_vrm_look_at_map(&look_at->range_map_horizontal_outer, fabsf(yaw));
+  cgltf_float inner = cgltf_vrm_look_at_map(&look_at->range_map_horizontal_inner, fabsf(yaw));
+  cgltf_float up = (pitch > 0.0f) ? cgltf_vrm_look_at_map(&look_at->range_map_vertical_up, pitch) : 0.0f;
+  cgltf_float down = (pitch < 0.0f) ? cgltf_vrm_look_at_map(&look_at->range_map_vertical_down, -pitch) : 0.0f;
+
+  cgltf_vrm_look_at_eye((yaw >= 0.0f) ? outer : -inner, up - down, out->left_eye);
+  cgltf_vrm_look_at_eye((yaw >= 0.0f) ? inner : -outer, up - down, out->right_eye);
+
+  /* Expressions only use the outer horizontal range. */
+  out->weights[0] = fminf(up, 1.0f);
+  out->weights[1] = fminf(down, 1.0f);
+  out->weights[2] = (yaw > 0.0f) ? fminf(outer, 1.0f) : 0.0f;
+  out->weights[3] = (yaw < 0.0f) ? fminf(outer, 1.0f) : 0.0f;
+  CGLTF_VRM_PROFILE_END(NULL, zone);
 }
 
+/* ----------- Referenced nodes ----------- */
+
+/* Adds `node` and its ancestors, up to the first one already in the set. */
 static
-int cgltf_vrm_parse_json_mtoon_shading_shift_texture_info(jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_mtoon_shading_shift_texture_info* out)
+void cgltf_vrm_node_set_add(cgltf_data const* gltf, cgltf_vrm_node_set* set, cgltf_node const* node)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
-
-  memset(out, 0, sizeof(cgltf_vrm_mtoon_shading_shift_texture_info));
-
-  cgltf_size size = tokens[i].size;
-  ++i;
-
-  for (cgltf_size j = 0; j < size; ++j)
+  for (; node != NULL; node = node->parent)
   {
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "index") == 0)
-    {
-      ++i;
-      out->index = cgltf_json_to_int(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "texCoord") == 0)
-    {
-      ++i;
-      out->tex_coord = cgltf_json_to_int(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "scale") == 0)
-    {
-      ++i;
-      out->scale = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else
+    cgltf_size n = (cgltf_size)(node - gltf->nodes);
+    if (set->bits[n / 32] & (1u << (n % 32)))
     {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_materials_mtoon.shadingShiftTextureInfo.")
+      break;
     }
+    set->bits[n / 32] |= 1u << (n % 32);
+    set->nodes_count++;
   }
-
-  return i;
 }
 
 static
-int cgltf_vrm_parse_json_material_mtoon(cgltf_options* options, jsmntok_t const* tokens, int i, uint8_t const* json_chunk, cgltf_vrm_mtoon* out)
+void cgltf_vrm_node_set_add_humanoid(cgltf_data const* gltf, cgltf_vrm_node_set* set, cgltf_vrm_humanoid const* humanoid)
 {
-  CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+  for (cgltf_size i = 0; i < humanoid->human_bones_count; ++i)
+  {
+    cgltf_vrm_node_set_add(gltf, set, humanoid->human_bones[i].node);
+  }
+}
 
-  memset(out, 0, sizeof(cgltf_vrm_mtoon));
+cgltf_result cgltf_vrm_node_set_init_referenced(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_node_set* set)
+{
+  cgltf_options fixed_options;
 
-  int size = tokens[i].size;
-  ++i;
+  if (options == NULL || gltf == NULL || vrm == NULL || set == NULL)
+  {
+    return cgltf_result_invalid_options;
+  }
 
-  for (int j = 0; j < size; ++j)
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
+
+  memset(set, 0, sizeof(cgltf_vrm_node_set));
+  set->memory = fixed_options.memory;
+  set->gltf_nodes_count = gltf->nodes_count;
+
+  set->bits = (uint32_t*)cgltf_calloc(&fixed_options, sizeof(uint32_t), (gltf->nodes_count + 31) / 32 + 1);
+  if (!set->bits)
   {
-    CGLTF_CHECK_KEY(tokens[i]);
+    cgltf_vrm_node_set_free(set);
+    return cgltf_result_out_of_memory;
+  }
 
-    if (cgltf_json_strcmp(tokens + i, json_chunk, "specVersion") == 0)
-    {
-      ++i;
-      out->spec_version = cgltf_vrm_string_to_spec_version(tokens, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "transparentWithZWrite") == 0)
-    {
-      ++i;
-      out->transparent_with_z_write = cgltf_json_to_bool(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "renderQueueOffsetNumber") == 0)
-    {
-      ++i;
-      out->render_queue_offset_number = cgltf_json_to_int(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shadeColorFactor") == 0)
-    {
-      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->shade_color_factor, 3);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shadingShiftFactor") == 0)
-    {
-      ++i;
-      out->shading_shift_factor = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shadingToonyFactor") == 0)
-    {
-      ++i;
-      out->shading_toony_factor = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shadeMultiplyTexture") == 0)
-    {
-      i = cgltf_vrm_parse_json_mtoon_texture_info(tokens, i + 1, json_chunk, &out->shade_multiply_texture);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "shadingShiftTexture") == 0)
-    {
-      i = cgltf_vrm_parse_json_mtoon_shading_shift_texture_info(tokens, i + 1, json_chunk, &out->shading_shift_texture);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "giEqualizationFactor") == 0)
-    {
-      ++i;
-      out->gi_equalization_factor = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "matcapFactor") == 0)
-    {
-      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->matcap_factor, 3);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "matcapTexture") == 0)
-    {
-      i = cgltf_vrm_parse_json_mtoon_texture_info(tokens, i + 1, json_chunk, &out->matcap_texture);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "parametricRimColorFactor") == 0)
-    {
-      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->parametric_rim_color_factor, 3);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "parametricRimFresnelPowerFactor") == 0)
-    {
-      ++i;
-      out->parametric_rim_fresnel_power_factor = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "parametricRimLiftFactor") == 0)
-    {
-      ++i;
-      out->parametric_rim_lift_factor = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rimMultiplyTexture") == 0)
-    {
-      i = cgltf_vrm_parse_json_mtoon_texture_info(tokens, i + 1, json_chunk, &out->rim_multiply_texture);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "rimLightingMixFactor") == 0)
-    {
-      ++i;
-      out->rim_lighting_mix_factor = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outlineWidthMode") == 0)
-    {
-      ++i;
-      out->outline_width_mode = cgltf_vrm_string_to_mtoon_outline_width_mode(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outlineWidthFactor") == 0)
-    {
-      ++i;
-      out->outline_width_factor = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outlineWidthMultiplyTexture") == 0)
-    {
-      i = cgltf_vrm_parse_json_mtoon_texture_info(tokens, i + 1, json_chunk, &out->outline_width_multiply_texture);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outlineColorFactor") == 0)
-    {
-      i = cgltf_parse_json_float_array(tokens, i + 1, json_chunk, out->outline_color_factor, 3);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "outlineLightingMixFactor") == 0)
-    {
-      ++i;
-      out->outline_lighting_mix_factor = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "uvAnimationMaskTexture") == 0)
-    {
-      i = cgltf_vrm_parse_json_mtoon_texture_info(tokens, i + 1, json_chunk, &out->uv_animation_mask_texture);
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "uvAnimationScrollXSpeedFactor") == 0)
-    {
-      ++i;
-      out->uv_animation_scroll_x_speed_factor = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
-    }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "uvAnimationScrollYSpeedFactor") == 0)
+  cgltf_vrm_node_set_add_humanoid(gltf, set, &vrm->core.humanoid);
+  if (vrm->has_animation)
+  {
+    cgltf_vrm_node_set_add_humanoid(gltf, set, &vrm->animation.humanoid);
+    cgltf_vrm_node_set_add(gltf, set, vrm->animation.look_at_node);
+  }
+  if (vrm->has_spring_bone)
+  {
+    for (cgltf_size i = 0; i < vrm->spring_bone.colliders_count; ++i)
     {
-      ++i;
-      out->uv_animation_scroll_y_speed_factor = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
+      cgltf_vrm_node_set_add(gltf, set, vrm->spring_bone.colliders[i].node);
     }
-    else if (cgltf_json_strcmp(tokens + i, json_chunk, "uvAnimationRotationSpeedFactor") == 0)
+    for (cgltf_size i = 0; i < vrm->spring_bone.springs_count; ++i)
     {
-      ++i;
-      out->uv_animation_rotation_speed_factor = cgltf_json_to_float(tokens + i, json_chunk);
-      ++i;
+      cgltf_vrm_spring_bone_spring const* spring = &vrm->spring_bone.springs[i];
+      cgltf_vrm_node_set_add(gltf, set, spring->center);
+      for (cgltf_size j = 0; j < spring->joints_count; ++j)
+      {
+        cgltf_vrm_node_set_add(gltf, set, spring->joints[j].node);
+      }
     }
-    else
+  }
+  cgltf_size nodes_count = (vrm->extended_nodes_count < gltf->nodes_count) ? vrm->extended_nodes_count : gltf->nodes_count;
+  for (cgltf_size n = 0; n < nodes_count; ++n)
+  {
+    cgltf_vrm_extended_node const* node = &vrm->extended_nodes[n];
+    if (node->has_node_constraint && node->node_constraint.source != NULL)
     {
-      CGLTF_VRM_LOG_SKIPPED("VRMC_materials_mtoon.")
+      cgltf_vrm_node_set_add(gltf, set, &gltf->nodes[n]);
+      cgltf_vrm_node_set_add(gltf, set, node->node_constraint.source);
     }
+  }
 
-    if (i < 0)
+  set->nodes = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), set->nodes_count + 1);
+  if (!set->nodes)
+  {
+    cgltf_vrm_node_set_free(set);
+    return cgltf_result_out_of_memory;
+  }
+
+  cgltf_size k = 0;
+  for (cgltf_size n = 0; n < gltf->nodes_count; ++n)
+  {
+    if (set->bits[n / 32] & (1u << (n % 32)))
     {
-      return i;
+      set->nodes[k++] = (cgltf_uint)n;
     }
   }
 
-  return i;
+  return cgltf_result_success;
 }
 
-/* -------------------------------------------------------------------------- */
+cgltf_bool cgltf_vrm_node_set_contains(cgltf_vrm_node_set const* set, cgltf_size node_index)
+{
+  return node_index < set->gltf_nodes_count && (set->bits[node_index / 32] & (1u << (node_index % 32))) != 0;
+}
 
-static
-int cgltf_vrm_fixup_pointers(cgltf_data const* gltf, cgltf_vrm_data* vrm)
+void cgltf_vrm_node_set_free(cgltf_vrm_node_set* set)
 {
-  cgltf_vrm_core *vrmc = &vrm->core;
+  if (!set || !set->memory.free_func)
+  {
+    return;
+  }
 
-  /* VRMC_vrm.humanoid */
-  for (cgltf_size i = 0; i < vrmc->humanoid.human_bones_count; ++i)
+  set->memory.free_func(set->memory.user_data, set->nodes);
+  set->memory.free_func(set->memory.user_data, set->bits);
+  memset(set, 0, sizeof(cgltf_vrm_node_set));
+}
+
+/* ----------- Skeleton ----------- */
+
+cgltf_result cgltf_vrm_skeleton_init(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data const* vrm, cgltf_vrm_skeleton* skeleton)
+{
+  cgltf_options fixed_options;
+  cgltf_vrm_node_set referenced;
+
+  if (options == NULL || gltf == NULL || vrm == NULL || skeleton == NULL)
   {
-    CGLTF_PTRFIXUP(vrmc->humanoid.human_bones[i].node, gltf->nodes, gltf->nodes_count);
+    return cgltf_result_invalid_options;
   }
 
-  /* VRMC_vrm.meta */
-  if (vrmc->meta.has_thumbnail_image)
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
+
+  memset(skeleton, 0, sizeof(cgltf_vrm_skeleton));
+  skeleton->memory = fixed_options.memory;
+
+  cgltf_result result = cgltf_vrm_node_set_init_referenced(&fixed_options, gltf, vrm, &referenced);
+  if (result != cgltf_result_success)
   {
-    CGLTF_PTRFIXUP(vrmc->meta.thumbnail_image, gltf->images, gltf->images_count);
+    return result;
   }
 
-  /* VRMC_vrm.firstPerson */
-  for (cgltf_size i = 0; i < vrmc->first_person.mesh_annotations_count; ++i)
+  cgltf_size nodes_count = gltf->nodes_count;
+  cgltf_size count = referenced.nodes_count;
+  uint32_t* marks = referenced.bits;
+  skeleton->nodes = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), count + 1);
+  skeleton->parents = (cgltf_int*)cgltf_calloc(&fixed_options, sizeof(cgltf_int), count + 1);
+  skeleton->linear_indices = (cgltf_int*)cgltf_calloc(&fixed_options, sizeof(cgltf_int), nodes_count + 1);
+  skeleton->storage = (cgltf_float*)cgltf_calloc(&fixed_options, sizeof(cgltf_float), count * 10 + 1);
+  cgltf_uint* stack = (cgltf_uint*)cgltf_calloc(&fixed_options, sizeof(cgltf_uint), count + 1);
+  if (!skeleton->nodes || !skeleton->parents || !skeleton->linear_indices || !skeleton->storage || !stack)
   {
-    cgltf_vrm_first_person_mesh_annotation *mesh_annotation = &vrmc->first_person.mesh_annotations[i];
-    CGLTF_PTRFIXUP(mesh_annotation->node, gltf->nodes, gltf->nodes_count);
+    fixed_options.memory.free_func(fixed_options.memory.user_data, stack);
+    cgltf_vrm_node_set_free(&referenced);
+    cgltf_vrm_skeleton_free(skeleton);
+    return cgltf_result_out_of_memory;
   }
 
-  /* VRMC_vrm.expressions */
-  for (cgltf_size i = 0; i < vrmc->expressions.preset_count; ++i)
+  for (int c = 0; c < 3; ++c)
   {
-    cgltf_vrm_expression *preset = &vrmc->expressions.preset[i];
-    for (cgltf_size j = 0; j < preset->morph_target_binds_count; ++j)
-    {
-      CGLTF_PTRFIXUP(preset->morph_target_binds[j].node, gltf->nodes, gltf->nodes_count);
-    }
+    skeleton->translation[c] = skeleton->storage + count * c;
+    skeleton->scale[c] = skeleton->storage + count * (3 + c);
   }
-  for (cgltf_size i = 0; i < vrmc->expressions.custom_count; ++i)
+  for (int c = 0; c < 4; ++c)
   {
-    cgltf_vrm_expression *custom = &vrmc->expressions.custom[i];
-    for (cgltf_size j = 0; j < custom->morph_target_binds_count; ++j)
-    {
-      CGLTF_PTRFIXUP(custom->morph_target_binds[j].node, gltf->nodes, gltf->nodes_count);
-    }
+    skeleton->rotation[c] = skeleton->storage + count * (6 + c);
   }
-
-  if (vrm->has_spring_bone)
+  for (cgltf_size n = 0; n < nodes_count; ++n)
   {
-    cgltf_vrm_spring_bone *sb = &vrm->spring_bone;
+    skeleton->linear_indices[n] = -1;
+  }
+  skeleton->gltf_nodes_count = nodes_count;
 
-    /* VRMC_springBone.colliders */
-    for (cgltf_size i = 0; i < sb->colliders_count; ++i)
+  /* Depth first from the roots in node order, children are pushed in reverse to keep their order. A node is
+   * unmarked when pushed so that malformed hierarchies cannot visit it twice, nodes in parent cycles are dropped. */
+  cgltf_size k = 0;
+  for (cgltf_size r = 0; r < nodes_count; ++r)
+  {
+    if (!(marks[r / 32] & (1u << (r % 32))) || gltf->nodes[r].parent != NULL)
     {
-      CGLTF_PTRFIXUP(sb->colliders[i].node, gltf->nodes, gltf->nodes_count);
+      continue;
     }
 
-    /* VRMC_springBone.springs */
-    for (cgltf_size i = 0; i < sb->springs_count; ++i)
+    cgltf_size top = 0;
+    stack[top++] = (cgltf_uint)r;
+    marks[r / 32] &= ~(1u << (r % 32));
+    while (top > 0)
     {
-      CGLTF_PTRFIXUP(sb->springs[i].center, gltf->nodes, gltf->nodes_count);
+      cgltf_uint n = stack[--top];
+      cgltf_node const* node = &gltf->nodes[n];
+      cgltf_float t[3], q[4], s[3];
 
-      for (cgltf_size j = 0; j < sb->springs[i].joints_count; ++j)
+      skeleton->linear_indices[n] = (cgltf_int)k;
+      skeleton->nodes[k] = n;
+      skeleton->parents[k] = node->parent ? skeleton->linear_indices[node->parent - gltf->nodes] : -1;
+
+      cgltf_vrm_node_rest_transform(node, t, q, s);
+      for (int c = 0; c < 3; ++c)
       {
-        CGLTF_PTRFIXUP(sb->springs[i].joints[j].node, gltf->nodes, gltf->nodes_count);
+        skeleton->translation[c][k] = t[c];
+        skeleton->scale[c][k] = s[c];
+      }
+      for (int c = 0; c < 4; ++c)
+      {
+        skeleton->rotation[c][k] = q[c];
+      }
+      ++k;
+
+      for (cgltf_size c = node->children_count; c > 0; --c)
+      {
+        cgltf_node const* child = node->children[c - 1];
+        cgltf_size m = (cgltf_size)(child - gltf->nodes);
+        if (child->parent == node && (marks[m / 32] & (1u << (m % 32))))
+        {
+          marks[m / 32] &= ~(1u << (m % 32));
+          stack[top++] = (cgltf_uint)m;
+        }
       }
     }
   }
+  skeleton->nodes_count = k;
 
-  /* VRMC_node_constraint */
-  for (cgltf_size i = 0; i < vrm->extended_nodes_count; ++i)
+  fixed_options.memory.free_func(fixed_options.memory.user_data, stack);
+  cgltf_vrm_node_set_free(&referenced);
+  return cgltf_result_success;
+}
+
+void cgltf_vrm_skeleton_compute_world(cgltf_vrm_skeleton const* skeleton, cgltf_float* world_matrices)
+{
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_skeleton_compute_world");
+  for (cgltf_size i = 0; i < skeleton->nodes_count; ++i)
   {
-    cgltf_vrm_extended_node* node = &vrm->extended_nodes[i];
+    cgltf_float t[3], q[4], s[3], local[16];
+    cgltf_float* world = world_matrices + 16 * i;
 
-    if (node->has_node_constraint)
+    for (int c = 0; c < 3; ++c)
     {
-      CGLTF_PTRFIXUP(node->node_constraint.source, gltf->nodes, gltf->nodes_count);
+      t[c] = skeleton->translation[c][i];
+      s[c] = skeleton->scale[c][i];
+    }
+    for (int c = 0; c < 4; ++c)
+    {
+      q[c] = skeleton->rotation[c][i];
     }
-  }
 
-  return 0;
+    if (skeleton->parents[i] < 0)
+    {
+      cgltf_vrm_matrix_compose(t, q, s, world);
+      continue;
+    }
+    cgltf_vrm_matrix_compose(t, q, s, local);
+    cgltf_vrm_matrix_multiply(world_matrices + 16 * skeleton->parents[i], local, world);
+  }
+  CGLTF_VRM_PROFILE_END(NULL, zone);
 }
 
-/* -------------------------------------------------------------------------- */
-
-#define CGLTF_VRM_FREE(vrm, data) if (data) (vrm)->memory.free_func((vrm)->memory.user_data, data)
+void cgltf_vrm_skeleton_scatter_world(cgltf_vrm_skeleton const* skeleton, cgltf_float const* world_matrices, cgltf_float* node_world_matrices)
+{
+  for (cgltf_size i = 0; i < skeleton->nodes_count; ++i)
+  {
+    memcpy(node_world_matrices + 16 * skeleton->nodes[i], world_matrices + 16 * i, sizeof(cgltf_float) * 16);
+  }
+}
 
-/* [incomplete] */
-void cgltf_vrm_free(cgltf_vrm_data *vrm)
+void cgltf_vrm_skeleton_free(cgltf_vrm_skeleton* skeleton)
 {
-  if (!vrm)
+  if (!skeleton || !skeleton->memory.free_func)
   {
     return;
   }
 
-  cgltf_vrm_core *vrmc = &vrm->core;
+  skeleton->memory.free_func(skeleton->memory.user_data, skeleton->nodes);
+  skeleton->memory.free_func(skeleton->memory.user_data, skeleton->parents);
+  skeleton->memory.free_func(skeleton->memory.user_data, skeleton->linear_indices);
+  skeleton->memory.free_func(skeleton->memory.user_data, skeleton->storage);
+  memset(skeleton, 0, sizeof(cgltf_vrm_skeleton));
+}
+
+/* ----------- Retargeting ----------- */
+
+static
+void cgltf_vrm_node_rest_world_rotation(cgltf_node const* node, cgltf_float* out)
+{
+  out[0] = out[1] = out[2] = 0.0f;
+  out[3] = 1.0f;
+  for (; node != NULL; node = node->parent)
+  {
+    cgltf_float t[3], q[4], s[3];
+    cgltf_vrm_node_rest_transform(node, t, q, s);
+    cgltf_vrm_quat_mul(q, out, out);
+  }
+}
 
-  if (vrmc->humanoid.human_bones_count > 0)
+/* First bone of each type, NULL when missing. */
+static
+void cgltf_vrm_humanoid_bone_nodes(cgltf_vrm_humanoid const* humanoid, cgltf_node const** nodes)
+{
+  memset(nodes, 0, sizeof(cgltf_node const*) * cgltf_vrm_humanoid_bone_type_max_enum);
+  for (cgltf_size i = 0; humanoid && i < humanoid->human_bones_count; ++i)
   {
-    for (cgltf_size i = 0; i < vrmc->humanoid.human_bones_count; ++i)
+    cgltf_vrm_humanoid_bone const* bone = &humanoid->human_bones[i];
+    if ((unsigned)bone->type < cgltf_vrm_humanoid_bone_type_max_enum && nodes[bone->type] == NULL)
     {
-      CGLTF_VRM_FREE(vrm, vrmc->humanoid.human_bones[i].name);
+      nodes[bone->type] = bone->node;
     }
-    CGLTF_VRM_FREE(vrm, vrmc->humanoid.human_bones);
   }
+}
 
-  CGLTF_VRM_FREE(vrm, vrmc->meta.name);
-  CGLTF_VRM_FREE(vrm, vrmc->meta.version);
-  CGLTF_VRM_FREE(vrm, vrmc->meta.license_url);
-  CGLTF_VRM_FREE(vrm, vrmc->meta.copyright_information);
-  CGLTF_VRM_FREE(vrm, vrmc->meta.contact_information);
-  for (cgltf_size i = 0; i < vrmc->meta.authors_count; ++i)
+cgltf_result cgltf_vrm_retarget_table_init(cgltf_vrm_humanoid const* source, cgltf_vrm_humanoid const* target, cgltf_vrm_retarget_table* table)
+{
+  cgltf_node const* source_nodes[cgltf_vrm_humanoid_bone_type_max_enum];
+  cgltf_node const* target_nodes[cgltf_vrm_humanoid_bone_type_max_enum];
+
+  if (target == NULL || table == NULL)
   {
-    CGLTF_VRM_FREE(vrm, vrmc->meta.authors[i]);
+    return cgltf_result_invalid_options;
   }
-  CGLTF_VRM_FREE(vrm, vrmc->meta.authors);
 
-  if (vrmc->expressions.preset_count > 0)
+  memset(table, 0, sizeof(cgltf_vrm_retarget_table));
+  cgltf_vrm_humanoid_bone_nodes(source, source_nodes);
+  cgltf_vrm_humanoid_bone_nodes(target, target_nodes);
+
+  for (int b = 0; b < cgltf_vrm_humanoid_bone_type_max_enum; ++b)
   {
-    for (cgltf_size i = 0; i < vrmc->expressions.preset_count; ++i)
+    cgltf_float source_parent[4], source_rest[4], target_parent[4], target_rest[4], t[3], s[3], q[4];
+    cgltf_float* pre = table->pre_rotations[b];
+    cgltf_float* post = table->post_rotations[b];
+
+    pre[3] = post[3] = 1.0f;
+    if (target_nodes[b] == NULL)
     {
-      cgltf_vrm_expression *expression = &vrmc->expressions.preset[i];
-      CGLTF_VRM_FREE(vrm, expression->name);
+      continue;
+    }
 
-      if (expression->morph_target_binds_count > 0)
-      {
-        CGLTF_VRM_FREE(vrm, expression->morph_target_binds);
-      }
+    cgltf_vrm_node_rest_transform(target_nodes[b], t, target_rest, s);
+    if (source != NULL && source_nodes[b] == NULL)
+    {
+      memcpy(post, target_rest, sizeof(cgltf_float) * 4);
+      table->bones[b] = cgltf_vrm_retarget_bone_rest;
+      continue;
+    }
+
+    cgltf_vrm_node_rest_world_rotation(target_nodes[b]->parent, target_parent);
+    source_parent[0] = source_parent[1] = source_parent[2] = 0.0f;
+    source_parent[3] = 1.0f;
+    memcpy(source_rest, source_parent, sizeof(source_rest));
+    if (source != NULL)
+    {
+      cgltf_vrm_node_rest_world_rotation(source_nodes[b]->parent, source_parent);
+      cgltf_vrm_node_rest_transform(source_nodes[b], t, source_rest, s);
     }
-    CGLTF_VRM_FREE(vrm, vrmc->expressions.preset);
+
+    cgltf_vrm_quat_conjugate(target_parent, q);
+    cgltf_vrm_quat_mul(q, source_parent, pre);
+
+    cgltf_vrm_quat_mul(source_parent, source_rest, q);
+    cgltf_vrm_quat_conjugate(q, q);
+    cgltf_vrm_quat_mul(q, target_parent, q);
+    cgltf_vrm_quat_mul(q, target_rest, post);
+    table->bones[b] = cgltf_vrm_retarget_bone_mapped;
   }
 
-  if (vrmc->expressions.custom_count > 0)
+  table->hips_scale = 1.0f;
+  cgltf_node const* source_hips = source_nodes[cgltf_vrm_humanoid_bone_type_hips];
+  cgltf_node const* target_hips = target_nodes[cgltf_vrm_humanoid_bone_type_hips];
+  if (source_hips != NULL && target_hips != NULL)
   {
-    for (cgltf_size i = 0; i < vrmc->expressions.custom_count; ++i)
+    cgltf_float source_world[16], target_world[16];
+    cgltf_node_transform_world(source_hips, source_world);
+    cgltf_node_transform_world(target_hips, target_world);
+    if (source_world[13] > 0.0f && target_world[13] > 0.0f)
     {
-      cgltf_vrm_expression *expression = &vrmc->expressions.custom[i];
-      CGLTF_VRM_FREE(vrm, expression->name);
-
-      if (expression->morph_target_binds_count > 0)
-      {
-        CGLTF_VRM_FREE(vrm, expression->morph_target_binds);
-      }
+      table->hips_scale = target_world[13] / source_world[13];
     }
-    CGLTF_VRM_FREE(vrm, vrmc->expressions.custom);
   }
 
-  if (vrm->has_spring_bone)
+  return cgltf_result_success;
+}
+
+/* Bone major so that each correction stays in registers across the poses. */
+void cgltf_vrm_retarget_apply(cgltf_vrm_retarget_table const* table, cgltf_size count, cgltf_float const* source_rotations, cgltf_float const* source_hips_translations, cgltf_float* target_rotations, cgltf_float* target_hips_translations)
+{
+  cgltf_size const stride = 4 * cgltf_vrm_humanoid_bone_type_max_enum;
+
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_retarget_apply");
+  for (int b = 0; b < cgltf_vrm_humanoid_bone_type_max_enum; ++b)
   {
-    cgltf_vrm_spring_bone *sb = &vrm->spring_bone;
+    cgltf_float const* pre = table->pre_rotations[b];
+    cgltf_float const* post = table->post_rotations[b];
 
-    for (cgltf_size i = 0; i < sb->collider_groups_count; ++i)
+    switch (table->bones[b])
     {
-      CGLTF_VRM_FREE(vrm, sb->collider_groups[i].name);
-      CGLTF_VRM_FREE(vrm, sb->collider_groups[i].colliders);
+      case cgltf_vrm_retarget_bone_mapped:
+        for (cgltf_size i = 0; i < count; ++i)
+        {
+          cgltf_float q[4];
+          cgltf_vrm_quat_mul(pre, source_rotations + i * stride + 4 * b, q);
+          cgltf_vrm_quat_mul(q, post, target_rotations + i * stride + 4 * b);
+        }
+        break;
+
+      case cgltf_vrm_retarget_bone_rest:
+        for (cgltf_size i = 0; i < count; ++i)
+        {
+          memcpy(target_rotations + i * stride + 4 * b, post, sizeof(cgltf_float) * 4);
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  if (source_hips_translations != NULL && target_hips_translations != NULL)
+  {
+    cgltf_float const* pre = table->pre_rotations[cgltf_vrm_humanoid_bone_type_hips];
+    for (cgltf_size i = 0; i < count; ++i)
+    {
+      cgltf_float t[3];
+      cgltf_vrm_quat_rotate(pre, source_hips_translations + 3 * i, t);
+      for (int c = 0; c < 3; ++c)
+      {
+        target_hips_translations[3 * i + c] = t[c] * table->hips_scale;
+      }
     }
-    CGLTF_VRM_FREE(vrm, sb->collider_groups);
   }
+  CGLTF_VRM_PROFILE_END(NULL, zone);
 }
 
-#undef CGLTF_VRM_FREE
+/* ----------- Two bone IK ----------- */
 
-cgltf_result cgltf_vrm_parse_init(cgltf_options *options, char* json_chunk, jsmntok_t** tokens)
-{
-  const size_t size = strlen(json_chunk);
+static const cgltf_vrm_humanoid_bone_type cgltf_vrm_limb_bones[cgltf_vrm_limb_max_enum][3] = {
+  { cgltf_vrm_humanoid_bone_type_left_upper_leg, cgltf_vrm_humanoid_bone_type_left_lower_leg, cgltf_vrm_humanoid_bone_type_left_foot },
+  { cgltf_vrm_humanoid_bone_type_right_upper_leg, cgltf_vrm_humanoid_bone_type_right_lower_leg, cgltf_vrm_humanoid_bone_type_right_foot },
+  { cgltf_vrm_humanoid_bone_type_left_upper_arm, cgltf_vrm_humanoid_bone_type_left_lower_arm, cgltf_vrm_humanoid_bone_type_left_hand },
+  { cgltf_vrm_humanoid_bone_type_right_upper_arm, cgltf_vrm_humanoid_bone_type_right_lower_arm, cgltf_vrm_humanoid_bone_type_right_hand },
+};
 
-  jsmn_parser parser = { 0, 0, 0 };
+cgltf_bool cgltf_vrm_humanoid_limb_nodes(cgltf_data const* gltf, cgltf_vrm_humanoid const* humanoid, cgltf_vrm_limb limb, cgltf_int* nodes)
+{
+  cgltf_node const* bone_nodes[cgltf_vrm_humanoid_bone_type_max_enum];
+  cgltf_bool complete = 1;
 
-  if (options->json_token_count == 0)
+  cgltf_vrm_humanoid_bone_nodes(humanoid, bone_nodes);
+  for (int k = 0; k < 3; ++k)
   {
-    int token_count = jsmn_parse(&parser, (const char*)json_chunk, size, NULL, 0);
-    if (token_count <= 0)
-    {
-      return cgltf_result_invalid_json;
-    }
+    cgltf_node const* node = ((unsigned)limb < cgltf_vrm_limb_max_enum) ? bone_nodes[cgltf_vrm_limb_bones[limb][k]] : NULL;
+    nodes[k] = node ? (cgltf_int)(node - gltf->nodes) : -1;
+    complete &= (node != NULL);
+  }
+  return complete;
+}
 
-    options->json_token_count = token_count;
+cgltf_result cgltf_vrm_two_bone_ik_batch_init(cgltf_options const* options, cgltf_size limbs_count, cgltf_vrm_two_bone_ik_batch* batch)
+{
+  cgltf_options fixed_options;
+
+  if (options == NULL || batch == NULL)
+  {
+    return cgltf_result_invalid_options;
   }
 
-  *tokens = (jsmntok_t*)options->memory.alloc_func(options->memory.user_data, sizeof(jsmntok_t) * (options->json_token_count + 1));
-  if (!*tokens)
+  fixed_options = *options;
+  cgltf_vrm_fix_memory_options(&fixed_options);
+
+  memset(batch, 0, sizeof(cgltf_vrm_two_bone_ik_batch));
+  batch->memory = fixed_options.memory;
+
+  batch->storage = (cgltf_float*)cgltf_calloc(&fixed_options, sizeof(cgltf_float), limbs_count * 32 + 1);
+  if (!batch->storage)
   {
     return cgltf_result_out_of_memory;
   }
 
-  jsmn_init(&parser);
-
-  int token_count = jsmn_parse(&parser, (const char*)json_chunk, size, *tokens, options->json_token_count);
-  if (token_count <= 0)
+  cgltf_float* next = batch->storage;
+  for (int c = 0; c < 3; ++c)
   {
-    options->memory.free_func(options->memory.user_data, *tokens);
-    return cgltf_result_invalid_json;
+    batch->upper_position[c] = next; next += limbs_count;
+    batch->lower_position[c] = next; next += limbs_count;
+    batch->end_position[c] = next; next += limbs_count;
+    batch->target[c] = next; next += limbs_count;
+    batch->pole[c] = next; next += limbs_count;
   }
-  (*tokens)[token_count].type = JSMN_UNDEFINED;
+  for (int c = 0; c < 4; ++c)
+  {
+    batch->parent_rotation[c] = next; next += limbs_count;
+    batch->lower_parent_rotation[c] = next; next += limbs_count;
+    batch->upper_rotation[c] = next; next += limbs_count;
+    batch->lower_rotation[c] = next; next += limbs_count;
+  }
+  batch->weight = next;
+  batch->limbs_count = limbs_count;
 
   return cgltf_result_success;
 }
 
-cgltf_result cgltf_vrm_parse_cgltf_data(cgltf_options const* options, cgltf_data const* gltf, cgltf_vrm_data* vrm)
+void cgltf_vrm_two_bone_ik_batch_gather(cgltf_vrm_two_bone_ik_batch* batch, cgltf_size index, cgltf_data const* gltf, cgltf_int const* nodes, cgltf_float const* local_rotations, cgltf_float const* world_matrices)
 {
-  jsmntok_t* tokens = NULL;
-  cgltf_options fixed_options;
+  cgltf_node const* parent = gltf->nodes[nodes[0]].parent;
+  cgltf_node const* lower_parent = gltf->nodes[nodes[1]].parent;
+  cgltf_float parent_rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+  cgltf_float lower_parent_rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
 
-  if (options == NULL)
+  if (parent != NULL)
   {
-    return cgltf_result_invalid_options;
+    cgltf_vrm_quat_from_matrix(world_matrices + 16 * (parent - gltf->nodes), parent_rotation);
+  }
+  if (lower_parent != NULL)
+  {
+    cgltf_vrm_quat_from_matrix(world_matrices + 16 * (lower_parent - gltf->nodes), lower_parent_rotation);
   }
 
-  fixed_options = *options;
-  if (fixed_options.memory.alloc_func == NULL)
+  for (int c = 0; c < 3; ++c)
   {
-    fixed_options.memory.alloc_func = &cgltf_default_alloc;
+    batch->upper_position[c][index] = world_matrices[16 * nodes[0] + 12 + c];
+    batch->lower_position[c][index] = world_matrices[16 * nodes[1] + 12 + c];
+    batch->end_position[c][index] = world_matrices[16 * nodes[2] + 12 + c];
   }
-  if (fixed_options.memory.free_func == NULL)
+  for (int c = 0; c < 4; ++c)
   {
-    fixed_options.memory.free_func = &cgltf_default_free;
+    batch->parent_rotation[c][index] = parent_rotation[c];
+    batch->lower_parent_rotation[c][index] = lower_parent_rotation[c];
+    batch->upper_rotation[c][index] = local_rotations[4 * nodes[0] + c];
+    batch->lower_rotation[c][index] = local_rotations[4 * nodes[1] + c];
   }
+}
 
-  memset(vrm, 0, sizeof(cgltf_vrm_data));
-  vrm->memory = fixed_options.memory; /**/
+/* Interior angle facing `opposite` in a triangle of sides `a`, `b` and `opposite`. */
+static
+cgltf_float cgltf_vrm_triangle_angle(cgltf_float a, cgltf_float b, cgltf_float opposite)
+{
+  cgltf_float c = (a * a + b * b - opposite * opposite) / (2.0f * a * b);
+  return acosf(fminf(fmaxf(c, -1.0f), 1.0f));
+}
+
+static
+void cgltf_vrm_quat_from_axis_angle(cgltf_float const* axis, cgltf_float angle, cgltf_float* out)
+{
+  cgltf_float s = sinf(0.5f * angle);
+  out[0] = axis[0] * s;
+  out[1] = axis[1] * s;
+  out[2] = axis[2] * s;
+  out[3] = cosf(0.5f * angle);
+}
+
+static
+void cgltf_vrm_cross3(cgltf_float const* a, cgltf_float const* b, cgltf_float* out)
+{
+  cgltf_float x = a[1] * b[2] - a[2] * b[1];
+  cgltf_float y = a[2] * b[0] - a[0] * b[2];
+  cgltf_float z = a[0] * b[1] - a[1] * b[0];
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+}
 
-  /* --- Generic Extensions --- */
+/* World space deltas : the lower bone turns by `bend` around its head, then the whole limb by `swing` around the
+ * upper head. In local space upper' = inverse(parent) * swing * parent * upper and lower' = inverse(lowerParent)
+ * * bend * lowerParent * lower, the swing carrying any node between the two bones along. */
+void cgltf_vrm_two_bone_ik_solve(cgltf_vrm_two_bone_ik_batch* batch)
+{
+  static const cgltf_float identity[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+  static const cgltf_float zero[3] = { 0.0f, 0.0f, 0.0f };
 
-  for (cgltf_size i = 0; i < gltf->data_extensions_count; ++i)
+  CGLTF_VRM_PROFILE_BEGIN(NULL, zone, "cgltf_vrm_two_bone_ik_solve");
+  for (cgltf_size i = 0; i < batch->limbs_count; ++i)
   {
-    cgltf_extension* ext = &gltf->data_extensions[i];
-    char* json_chunk = ext->data;
+    cgltf_float ab[3], bc[3], ac[3], at[3], ap[3], axis[3], bend[4], swing[4], twist[4], q[4], inverse[4];
+    cgltf_float parent[4], lower_parent[4], upper[4], lower[4];
+    cgltf_float weight = batch->weight[i];
 
-    cgltf_result result = cgltf_vrm_parse_init(&fixed_options, json_chunk, &tokens);
-    if (result != cgltf_result_success)
+    if (!(weight > 0.0f))
     {
-      if (tokens != NULL)
-      {
-        fixed_options.memory.free_func(fixed_options.memory.user_data, tokens);
-      }
-      return result;
+      continue;
     }
 
-    if ((strcmp(ext->name, "VRMC_vrm") == 0) || (strcmp(ext->name, "VRM") == 0))
+    for (int c = 0; c < 3; ++c)
     {
-      cgltf_vrm_parse_json_vrm(&fixed_options, tokens, 0, (uint8_t const*)json_chunk, &vrm->core);
+      ab[c] = batch->lower_position[c][i] - batch->upper_position[c][i];
+      bc[c] = batch->end_position[c][i] - batch->lower_position[c][i];
+      ac[c] = ab[c] + bc[c];
+      at[c] = batch->target[c][i] - batch->upper_position[c][i];
+      ap[c] = batch->pole[c][i] - batch->upper_position[c][i];
     }
-    else if ((strcmp(ext->name, "VRMC_springBone") == 0) || (strcmp(ext->name, "springBone") == 0))
+
+    cgltf_float upper_length = sqrtf(ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2]);
+    cgltf_float lower_length = sqrtf(bc[0] * bc[0] + bc[1] * bc[1] + bc[2] * bc[2]);
+    cgltf_float end_length = sqrtf(ac[0] * ac[0] + ac[1] * ac[1] + ac[2] * ac[2]);
+    cgltf_float target_length = sqrtf(at[0] * at[0] + at[1] * at[1] + at[2] * at[2]);
+    if (upper_length <= 0.0f || lower_length <= 0.0f || target_length <= 0.0f)
     {
-      cgltf_vrm_parse_json_spring_bone(&fixed_options, tokens, 0, (uint8_t const*)json_chunk, &vrm->spring_bone);
-      vrm->has_spring_bone = true;
+      continue;
     }
 
-    fixed_options.memory.free_func(fixed_options.memory.user_data, tokens);
-    tokens = NULL;
-  }
-
-  /* --- Node extensions --- */
-
-  vrm->extended_nodes_count = gltf->nodes_count;
-  vrm->extended_nodes = (cgltf_vrm_extended_node*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_extended_node), vrm->extended_nodes_count);
-
-  for (cgltf_size i = 0; i < gltf->nodes_count; ++i)
-  {
-    cgltf_extension *ext = cgltf_vrm_get_node_extension(&gltf->nodes[i], "VRMC_node_constraint");
-    if (ext == NULL)
+    /* Bend in the current limb plane, the pole one when the limb is straight. */
+    cgltf_float margin = 1e-4f * (upper_length + lower_length);
+    target_length = fminf(fmaxf(target_length, fabsf(upper_length - lower_length) + margin), upper_length + lower_length - margin);
+    cgltf_vrm_cross3(ab, bc, axis);
+    if (axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] <= 1e-12f * upper_length * upper_length * lower_length * lower_length)
     {
-      ext = cgltf_vrm_get_node_extension(&gltf->nodes[i], "node_constraint");
+      cgltf_vrm_cross3(ab, ap, axis);
     }
+    cgltf_vrm_normalize3(axis, zero);
+    cgltf_float angle = cgltf_vrm_triangle_angle(upper_length, lower_length, end_length) - cgltf_vrm_triangle_angle(upper_length, lower_length, target_length);
+    cgltf_vrm_quat_from_axis_angle(axis, angle, bend);
 
-    if (ext != NULL)
+    /* Aim the bent limb at the target. */
+    cgltf_vrm_quat_rotate(bend, bc, ac);
+    for (int c = 0; c < 3; ++c)
     {
-      cgltf_vrm_extended_node *node = &vrm->extended_nodes[i];
-      char* json_chunk = ext->data;
-
-      cgltf_result result = cgltf_vrm_parse_init(&fixed_options, json_chunk, &tokens);
-      if (result != cgltf_result_success)
-      {
-        if (tokens != NULL)
-        {
-          fixed_options.memory.free_func(fixed_options.memory.user_data, tokens);
-        }
-        return result;
-      }
-
-      cgltf_vrm_parse_json_node_constraint(&fixed_options, tokens, 0, (uint8_t const*)json_chunk, &node->node_constraint);
-      node->has_node_constraint = true;
-
-      fixed_options.memory.free_func(fixed_options.memory.user_data, tokens);
-      tokens = NULL;
+      ac[c] += ab[c];
     }
-  }
+    cgltf_vrm_normalize3(ac, zero);
+    cgltf_vrm_normalize3(at, zero);
+    cgltf_vrm_quat_from_to(ac, at, swing);
 
-  /* --- Material extensions --- */
-
-  vrm->extended_materials_count = gltf->materials_count;
-  vrm->extended_materials = (cgltf_vrm_extended_material*)cgltf_calloc(&fixed_options, sizeof(cgltf_vrm_extended_material), vrm->extended_materials_count);
-
-  for (cgltf_size i = 0; i < gltf->materials_count; ++i)
-  {
-    cgltf_extension *ext = cgltf_vrm_get_material_extension(&gltf->materials[i], "VRMC_materials_mtoon");
-    if (ext == NULL)
+    /* Turn around the target axis so that the middle joint faces the pole. */
+    cgltf_float u[3], v[3];
+    cgltf_vrm_quat_rotate(swing, ab, u);
+    cgltf_float du = u[0] * at[0] + u[1] * at[1] + u[2] * at[2];
+    cgltf_float dv = ap[0] * at[0] + ap[1] * at[1] + ap[2] * at[2];
+    for (int c = 0; c < 3; ++c)
     {
-      ext = cgltf_vrm_get_material_extension(&gltf->materials[i], "materials_mtoon");
+      u[c] -= du * at[c];
+      v[c] = ap[c] - dv * at[c];
     }
-
-    if (ext != NULL)
+    cgltf_float u_length = sqrtf(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+    cgltf_float v_length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (u_length > margin && v_length > margin)
     {
-      cgltf_vrm_extended_material *mat = &vrm->extended_materials[i];
-      char* json_chunk = ext->data;
+      cgltf_float cross[3];
+      cgltf_vrm_cross3(u, v, cross);
+      cgltf_float sine = (cross[0] * at[0] + cross[1] * at[1] + cross[2] * at[2]) / (u_length * v_length);
+      cgltf_float cosine = (u[0] * v[0] + u[1] * v[1] + u[2] * v[2]) / (u_length * v_length);
+      cgltf_vrm_quat_from_axis_angle(at, atan2f(sine, cosine), twist);
+      cgltf_vrm_quat_mul(twist, swing, swing);
+    }
 
-      cgltf_result result = cgltf_vrm_parse_init(&fixed_options, json_chunk, &tokens);
-      if (result != cgltf_result_success)
-      {
-        if (tokens != NULL)
-        {
-          fixed_options.memory.free_func(fixed_options.memory.user_data, tokens);
-        }
-        return result;
-      }
+    cgltf_vrm_quat_slerp(identity, bend, weight, bend);
+    cgltf_vrm_quat_slerp(identity, swing, weight, swing);
 
-      cgltf_vrm_parse_json_material_mtoon(&fixed_options, tokens, 0, (uint8_t const*)json_chunk, &mat->mtoon);
-      mat->has_mtoon = true;
+    for (int c = 0; c < 4; ++c)
+    {
+      parent[c] = batch->parent_rotation[c][i];
+      lower_parent[c] = batch->lower_parent_rotation[c][i];
+      upper[c] = batch->upper_rotation[c][i];
+      lower[c] = batch->lower_rotation[c][i];
+    }
+    cgltf_vrm_quat_conjugate(lower_parent, inverse);
+    cgltf_vrm_quat_mul(inverse, bend, q);
+    cgltf_vrm_quat_mul(q, lower_parent, q);
+    cgltf_vrm_quat_mul(q, lower, lower);
+
+    cgltf_vrm_quat_conjugate(parent, inverse);
+    cgltf_vrm_quat_mul(inverse, swing, q);
+    cgltf_vrm_quat_mul(q, parent, q);
+    cgltf_vrm_quat_mul(q, upper, upper);
 
-      fixed_options.memory.free_func(fixed_options.memory.user_data, tokens);
-      tokens = NULL;
+    for (int c = 0; c < 4; ++c)
+    {
+      batch->upper_rotation[c][i] = upper[c];
+      batch->lower_rotation[c][i] = lower[c];
     }
   }
+  CGLTF_VRM_PROFILE_END(NULL, zone);
+}
 
-  /* --------------------------- */
+void cgltf_vrm_two_bone_ik_batch_scatter(cgltf_vrm_two_bone_ik_batch const* batch, cgltf_size index, cgltf_int const* nodes, cgltf_float* local_rotations)
+{
+  for (int c = 0; c < 4; ++c)
+  {
+    local_rotations[4 * nodes[0] + c] = batch->upper_rotation[c][index];
+    local_rotations[4 * nodes[1] + c] = batch->lower_rotation[c][index];
+  }
+}
 
-  if (cgltf_vrm_fixup_pointers(gltf, vrm) < 0)
+void cgltf_vrm_two_bone_ik_batch_free(cgltf_vrm_two_bone_ik_batch* batch)
+{
+  if (!batch || !batch->memory.free_func)
   {
-    cgltf_vrm_free(vrm);
-    return cgltf_result_invalid_gltf;
+    return;
   }
 
-  return cgltf_result_success;
+  batch->memory.free_func(batch->memory.user_data, batch->storage);
+  memset(batch, 0, sizeof(cgltf_vrm_two_bone_ik_batch));
 }
 
 /*
@@ -2160,10 +9886,15 @@ cgltf_result cgltf_vrm_parse(cgltf_options const* options, void const* data, cgl
 }
 */
 
-#undef CGLTF_VRM_JSON_LOG
 #undef CGLTF_VRM_JSON_SKIP
+#undef CGLTF_VRM_DIAGNOSE
 #undef CGLTF_VRM_LOG_SKIPPED
+#undef CGLTF_VRM_CHECK_ENUM
+#undef CGLTF_VRM_DIAGNOSTICS_PER_KIND
+#undef CGLTF_VRM_GLTF_COUNT
 #undef CGLTF_VRM_RET_STRING_TYPE
+#undef CGLTF_VRM_RET_STRING_TYPE_AS
+#undef CGLTF_VRM_ERROR_BUDGET
 
 #endif /* CGLTF_IMPLEMENTATION */
 
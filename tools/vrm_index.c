@@ -0,0 +1,560 @@
+/**
+ * vrm_index - walks directory trees of .vrm files and extracts VRMC_vrm.meta,
+ * license enums and complexity counts in parallel with cgltf_vrm_parse_meta_file.
+ *
+ * Rows are streamed to <prefix>.csv and to a simple columnar file, <prefix>.vcol,
+ * as they are produced : memory use does not grow with the corpus.
+ *
+ * Building (POSIX):
+ *   cc -O2 -pthread -I.. -I<path to cgltf> vrm_index.c -o vrm_index
+ *
+ * Usage:
+ *   vrm_index [-j threads] [-o prefix] <directory>...
+ *
+ * .vcol layout (little endian) :
+ *   "VRMCOLS1", u32 column_count,
+ *   per column : u8 type (0 = u32, 1 = i32, 2 = string), u8 name_length, name bytes,
+ *   then row groups of up to VRM_INDEX_GROUP_ROWS rows : u32 row_count followed by each
+ *   column in order, either row_count fixed width values, or row_count + 1 u32 offsets
+ *   followed by the concatenated string bytes. A row_count of 0 ends the file.
+ */
+#define _XOPEN_SOURCE 700
+
+#define CGLTF_IMPLEMENTATION
+#include "cgltf.h"
+#include "cgltf_vrm.h"
+
+#include <ftw.h>
+#include <pthread.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#define VRM_INDEX_QUEUE_SIZE 1024
+#define VRM_INDEX_GROUP_ROWS 4096
+#define VRM_INDEX_MAX_THREADS 256
+
+/* -------------------------------------------------------------------------- */
+/* -- Columns -- */
+
+typedef enum vrm_index_column_type
+{
+  vrm_index_column_type_u32,
+  vrm_index_column_type_i32,
+  vrm_index_column_type_string,
+} vrm_index_column_type;
+
+typedef enum vrm_index_column_id
+{
+  COL_PATH, COL_STATUS, COL_FILE_SIZE, COL_NAME, COL_VERSION, COL_AUTHORS, COL_LICENSE_URL,
+  COL_AVATAR_PERMISSION, COL_COMMERCIAL_USAGE, COL_CREDIT_NOTATION, COL_MODIFICATION,
+  COL_ALLOW_REDISTRIBUTION, COL_ALLOW_ANTISOCIAL_OR_HATE, COL_ALLOW_EXCESSIVELY_SEXUAL,
+  COL_ALLOW_EXCESSIVELY_VIOLENT, COL_ALLOW_POLITICAL_OR_RELIGIOUS, COL_THUMBNAIL_IMAGE,
+  COL_HUMAN_BONES, COL_EXPRESSIONS, COL_SPRINGS, COL_SPRING_JOINTS, COL_COLLIDERS,
+  COL_MATERIALS, COL_MTOON_MATERIALS,
+  COL_COUNT
+} vrm_index_column_id;
+
+static const struct { const char* name; vrm_index_column_type type; } vrm_index_columns[COL_COUNT] = {
+  { "path", vrm_index_column_type_string },
+  { "status", vrm_index_column_type_u32 },
+  { "file_size", vrm_index_column_type_u32 },
+  { "name", vrm_index_column_type_string },
+  { "version", vrm_index_column_type_string },
+  { "authors", vrm_index_column_type_string },
+  { "license_url", vrm_index_column_type_string },
+  { "avatar_permission", vrm_index_column_type_u32 },
+  { "commercial_usage", vrm_index_column_type_u32 },
+  { "credit_notation", vrm_index_column_type_u32 },
+  { "modification", vrm_index_column_type_u32 },
+  { "allow_redistribution", vrm_index_column_type_u32 },
+  { "allow_antisocial_or_hate_usage", vrm_index_column_type_u32 },
+  { "allow_excessively_sexual_usage", vrm_index_column_type_u32 },
+  { "allow_excessively_violent_usage", vrm_index_column_type_u32 },
+  { "allow_political_or_religious_usage", vrm_index_column_type_u32 },
+  { "thumbnail_image", vrm_index_column_type_i32 },
+  { "human_bones", vrm_index_column_type_u32 },
+  { "expressions", vrm_index_column_type_u32 },
+  { "springs", vrm_index_column_type_u32 },
+  { "spring_joints", vrm_index_column_type_u32 },
+  { "colliders", vrm_index_column_type_u32 },
+  { "materials", vrm_index_column_type_u32 },
+  { "mtoon_materials", vrm_index_column_type_u32 },
+};
+
+typedef struct vrm_index_row
+{
+  const char* strings[COL_COUNT];
+  uint32_t values[COL_COUNT];
+} vrm_index_row;
+
+/* One row group per column : fixed width values, or string offsets plus bytes. */
+typedef struct vrm_index_group
+{
+  uint32_t rows;
+  uint32_t values[COL_COUNT][VRM_INDEX_GROUP_ROWS];
+  uint32_t offsets[COL_COUNT][VRM_INDEX_GROUP_ROWS + 1];
+  char* bytes[COL_COUNT];
+  size_t bytes_capacity[COL_COUNT];
+} vrm_index_group;
+
+/* -------------------------------------------------------------------------- */
+/* -- Shared state -- */
+
+typedef struct vrm_index_job
+{
+  char* path;
+  uint32_t file_size;
+} vrm_index_job;
+
+typedef struct vrm_index_state
+{
+  pthread_mutex_t queue_mutex;
+  pthread_cond_t queue_not_empty;
+  pthread_cond_t queue_not_full;
+  vrm_index_job queue[VRM_INDEX_QUEUE_SIZE];
+  size_t queue_head;
+  size_t queue_count;
+  int walk_done;
+  int aborted; /* the output could not grow, remaining jobs are dropped */
+
+  pthread_mutex_t output_mutex;
+  FILE* csv;
+  FILE* vcol;
+  vrm_index_group group;
+
+  size_t files;
+  size_t failures;
+  double bytes;
+  double start_time;
+  double last_report;
+} vrm_index_state;
+
+static vrm_index_state g_state;
+
+static double vrm_index_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* -------------------------------------------------------------------------- */
+/* -- Output -- */
+
+static void vrm_index_write_csv_string(FILE* file, const char* str)
+{
+  fputc('"', file);
+  for (; str && *str; ++str)
+  {
+    if (*str == '"')
+    {
+      fputc('"', file);
+    }
+    fputc(*str, file);
+  }
+  fputc('"', file);
+}
+
+static void vrm_index_write_header(vrm_index_state* state)
+{
+  uint32_t column_count = COL_COUNT;
+
+  fwrite("VRMCOLS1", 1, 8, state->vcol);
+  fwrite(&column_count, sizeof(column_count), 1, state->vcol);
+
+  for (int c = 0; c < COL_COUNT; ++c)
+  {
+    uint8_t type = (uint8_t)vrm_index_columns[c].type;
+    uint8_t length = (uint8_t)strlen(vrm_index_columns[c].name);
+    fwrite(&type, 1, 1, state->vcol);
+    fwrite(&length, 1, 1, state->vcol);
+    fwrite(vrm_index_columns[c].name, 1, length, state->vcol);
+
+    fprintf(state->csv, "%s%s", c ? "," : "", vrm_index_columns[c].name);
+  }
+  fputc('\n', state->csv);
+}
+
+static void vrm_index_flush_group(vrm_index_state* state)
+{
+  vrm_index_group* group = &state->group;
+
+  fwrite(&group->rows, sizeof(uint32_t), 1, state->vcol);
+  if (group->rows == 0)
+  {
+    return;
+  }
+
+  for (int c = 0; c < COL_COUNT; ++c)
+  {
+    if (vrm_index_columns[c].type == vrm_index_column_type_string)
+    {
+      fwrite(group->offsets[c], sizeof(uint32_t), group->rows + 1, state->vcol);
+      fwrite(group->bytes[c], 1, group->offsets[c][group->rows], state->vcol);
+    }
+    else
+    {
+      fwrite(group->values[c], sizeof(uint32_t), group->rows, state->vcol);
+    }
+  }
+  group->rows = 0;
+}
+
+/* Grows the string bytes of column `c` to hold `size` bytes, returns 0 when out of memory. */
+static int vrm_index_reserve_bytes(vrm_index_group* group, int c, size_t size)
+{
+  if (size <= group->bytes_capacity[c])
+  {
+    return 1;
+  }
+
+  size_t capacity = group->bytes_capacity[c] ? group->bytes_capacity[c] : 4096;
+  while (size > capacity)
+  {
+    capacity *= 2;
+  }
+  char* bytes = (char*)realloc(group->bytes[c], capacity);
+  if (!bytes)
+  {
+    return 0;
+  }
+  group->bytes[c] = bytes;
+  group->bytes_capacity[c] = capacity;
+  return 1;
+}
+
+/* Returns 0 when out of memory, nothing of the row is written then. */
+static int vrm_index_append_row(vrm_index_state* state, const vrm_index_row* row)
+{
+  vrm_index_group* group = &state->group;
+  uint32_t r = group->rows;
+
+  for (int c = 0; c < COL_COUNT; ++c)
+  {
+    if (vrm_index_columns[c].type == vrm_index_column_type_string)
+    {
+      const char* str = row->strings[c] ? row->strings[c] : "";
+      if (!vrm_index_reserve_bytes(group, c, group->offsets[c][r] + strlen(str)))
+      {
+        return 0;
+      }
+    }
+  }
+
+  for (int c = 0; c < COL_COUNT; ++c)
+  {
+    if (vrm_index_columns[c].type == vrm_index_column_type_string)
+    {
+      const char* str = row->strings[c] ? row->strings[c] : "";
+      size_t length = strlen(str);
+      uint32_t offset = group->offsets[c][r];
+
+      if (length)
+      {
+        memcpy(group->bytes[c] + offset, str, length);
+      }
+      group->offsets[c][r + 1] = offset + (uint32_t)length;
+
+      if (c) fputc(',', state->csv);
+      vrm_index_write_csv_string(state->csv, str);
+    }
+    else
+    {
+      group->values[c][r] = row->values[c];
+      if (vrm_index_columns[c].type == vrm_index_column_type_i32)
+      {
+        fprintf(state->csv, ",%d", (int32_t)row->values[c]);
+      }
+      else
+      {
+        fprintf(state->csv, ",%u", row->values[c]);
+      }
+    }
+  }
+  fputc('\n', state->csv);
+
+  if (++group->rows == VRM_INDEX_GROUP_ROWS)
+  {
+    vrm_index_flush_group(state);
+  }
+  return 1;
+}
+
+/* -------------------------------------------------------------------------- */
+/* -- Workers -- */
+
+static void vrm_index_process(vrm_index_state* state, const vrm_index_job* job, cgltf_options const* options)
+{
+  cgltf_vrm_meta_summary summary;
+  vrm_index_row row;
+  char authors[1024];
+
+  memset(&row, 0, sizeof(row));
+
+  cgltf_result result = cgltf_vrm_parse_meta_file(options, job->path, &summary);
+
+  row.strings[COL_PATH] = job->path;
+  row.values[COL_STATUS] = (uint32_t)result;
+  row.values[COL_FILE_SIZE] = job->file_size;
+  row.values[COL_THUMBNAIL_IMAGE] = (uint32_t)-1;
+
+  if (result == cgltf_result_success)
+  {
+    cgltf_vrm_meta const* meta = &summary.meta;
+    size_t length = 0;
+
+    authors[0] = '\0';
+    for (cgltf_size i = 0; i < meta->authors_count && meta->authors[i]; ++i)
+    {
+      int n = snprintf(authors + length, sizeof(authors) - length, "%s%s", i ? ";" : "", meta->authors[i]);
+      if (n < 0 || (size_t)n >= sizeof(authors) - length)
+      {
+        break;
+      }
+      length += (size_t)n;
+    }
+
+    row.strings[COL_NAME] = meta->name;
+    row.strings[COL_VERSION] = meta->version;
+    row.strings[COL_AUTHORS] = authors;
+    row.strings[COL_LICENSE_URL] = meta->license_url;
+    row.values[COL_AVATAR_PERMISSION] = meta->avatar_permission;
+    row.values[COL_COMMERCIAL_USAGE] = meta->commercial_usage;
+    row.values[COL_CREDIT_NOTATION] = meta->credit_notation;
+    row.values[COL_MODIFICATION] = meta->modification;
+    row.values[COL_ALLOW_REDISTRIBUTION] = meta->allow_redistribution;
+    row.values[COL_ALLOW_ANTISOCIAL_OR_HATE] = meta->allow_antisocial_or_hate_usage;
+    row.values[COL_ALLOW_EXCESSIVELY_SEXUAL] = meta->allow_excessively_sexual_usage;
+    row.values[COL_ALLOW_EXCESSIVELY_VIOLENT] = meta->allow_excessively_violent_usage;
+    row.values[COL_ALLOW_POLITICAL_OR_RELIGIOUS] = meta->allow_political_or_religious_usage;
+    row.values[COL_THUMBNAIL_IMAGE] = (uint32_t)summary.thumbnail_image_index;
+    row.values[COL_HUMAN_BONES] = (uint32_t)summary.human_bones_count;
+    row.values[COL_EXPRESSIONS] = (uint32_t)summary.expressions_count;
+    row.values[COL_SPRINGS] = (uint32_t)summary.springs_count;
+    row.values[COL_SPRING_JOINTS] = (uint32_t)summary.spring_joints_count;
+    row.values[COL_COLLIDERS] = (uint32_t)summary.colliders_count;
+    row.values[COL_MATERIALS] = (uint32_t)summary.materials_count;
+    row.values[COL_MTOON_MATERIALS] = (uint32_t)summary.mtoon_materials_count;
+  }
+
+  pthread_mutex_lock(&state->output_mutex);
+  if (!vrm_index_append_row(state, &row))
+  {
+    pthread_mutex_unlock(&state->output_mutex);
+    fprintf(stderr, "out of memory while indexing '%s', stopping\n", job->path);
+
+    pthread_mutex_lock(&state->queue_mutex);
+    state->aborted = 1;
+    pthread_mutex_unlock(&state->queue_mutex);
+
+    if (result == cgltf_result_success)
+    {
+      cgltf_vrm_meta_summary_free(&summary);
+    }
+    return;
+  }
+  state->files += 1;
+  state->failures += (result != cgltf_result_success);
+  state->bytes += job->file_size;
+
+  double now = vrm_index_now();
+  if (now - state->last_report >= 5.0)
+  {
+    fprintf(stderr, "%zu files, %.1f files/s\n", state->files, state->files / (now - state->start_time));
+    state->last_report = now;
+  }
+  pthread_mutex_unlock(&state->output_mutex);
+
+  if (result == cgltf_result_success)
+  {
+    cgltf_vrm_meta_summary_free(&summary);
+  }
+}
+
+static void* vrm_index_worker(void* arg)
+{
+  vrm_index_state* state = (vrm_index_state*)arg;
+  cgltf_options options;
+
+  memset(&options, 0, sizeof(options));
+
+  for (;;)
+  {
+    vrm_index_job job;
+
+    pthread_mutex_lock(&state->queue_mutex);
+    while (state->queue_count == 0 && !state->walk_done)
+    {
+      pthread_cond_wait(&state->queue_not_empty, &state->queue_mutex);
+    }
+    if (state->queue_count == 0)
+    {
+      pthread_mutex_unlock(&state->queue_mutex);
+      return NULL;
+    }
+    job = state->queue[state->queue_head];
+    state->queue_head = (state->queue_head + 1) % VRM_INDEX_QUEUE_SIZE;
+    state->queue_count -= 1;
+    int aborted = state->aborted;
+    pthread_cond_signal(&state->queue_not_full);
+    pthread_mutex_unlock(&state->queue_mutex);
+
+    if (!aborted)
+    {
+      vrm_index_process(state, &job, &options);
+    }
+    free(job.path);
+  }
+}
+
+/* -------------------------------------------------------------------------- */
+/* -- Directory walk -- */
+
+static int vrm_index_aborted(vrm_index_state* state)
+{
+  pthread_mutex_lock(&state->queue_mutex);
+  int aborted = state->aborted;
+  pthread_mutex_unlock(&state->queue_mutex);
+  return aborted;
+}
+
+static int vrm_index_visit(const char* path, const struct stat* sb, int type, struct FTW* ftw)
+{
+  vrm_index_state* state = &g_state;
+  size_t length = strlen(path);
+  (void)ftw;
+
+  if (type != FTW_F || length < 4 || strcasecmp(path + length - 4, ".vrm") != 0)
+  {
+    return 0;
+  }
+
+  char* copy = strdup(path);
+  if (!copy)
+  {
+    return 1;
+  }
+
+  pthread_mutex_lock(&state->queue_mutex);
+  while (state->queue_count == VRM_INDEX_QUEUE_SIZE && !state->aborted)
+  {
+    pthread_cond_wait(&state->queue_not_full, &state->queue_mutex);
+  }
+  if (state->aborted)
+  {
+    pthread_mutex_unlock(&state->queue_mutex);
+    free(copy);
+    return 1;
+  }
+  vrm_index_job* job = &state->queue[(state->queue_head + state->queue_count) % VRM_INDEX_QUEUE_SIZE];
+  job->path = copy;
+  job->file_size = (sb->st_size > (off_t)UINT32_MAX) ? UINT32_MAX : (uint32_t)sb->st_size;
+  state->queue_count += 1;
+  pthread_cond_signal(&state->queue_not_empty);
+  pthread_mutex_unlock(&state->queue_mutex);
+
+  return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char** argv)
+{
+  vrm_index_state* state = &g_state;
+  pthread_t threads[VRM_INDEX_MAX_THREADS];
+  const char* prefix = "vrm_index";
+  char path[1024];
+  long thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+  int opt;
+
+  while ((opt = getopt(argc, argv, "j:o:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'j': thread_count = atol(optarg); break;
+      case 'o': prefix = optarg; break;
+      default:
+        fprintf(stderr, "usage: vrm_index [-j threads] [-o prefix] <directory>...\n");
+        return EXIT_FAILURE;
+    }
+  }
+  if (optind >= argc)
+  {
+    fprintf(stderr, "usage: vrm_index [-j threads] [-o prefix] <directory>...\n");
+    return EXIT_FAILURE;
+  }
+  if (thread_count < 1) thread_count = 1;
+  if (thread_count > VRM_INDEX_MAX_THREADS) thread_count = VRM_INDEX_MAX_THREADS;
+
+  memset(state, 0, sizeof(*state));
+  pthread_mutex_init(&state->queue_mutex, NULL);
+  pthread_mutex_init(&state->output_mutex, NULL);
+  pthread_cond_init(&state->queue_not_empty, NULL);
+  pthread_cond_init(&state->queue_not_full, NULL);
+
+  snprintf(path, sizeof(path), "%s.csv", prefix);
+  state->csv = fopen(path, "w");
+  snprintf(path, sizeof(path), "%s.vcol", prefix);
+  state->vcol = fopen(path, "wb");
+  if (!state->csv || !state->vcol)
+  {
+    fprintf(stderr, "cannot open output files with prefix '%s'\n", prefix);
+    return EXIT_FAILURE;
+  }
+  vrm_index_write_header(state);
+
+  state->start_time = state->last_report = vrm_index_now();
+
+  for (long t = 0; t < thread_count; ++t)
+  {
+    pthread_create(&threads[t], NULL, vrm_index_worker, state);
+  }
+
+  for (int a = optind; a < argc && !vrm_index_aborted(state); ++a)
+  {
+    if (nftw(argv[a], vrm_index_visit, 64, FTW_PHYS) != 0 && !vrm_index_aborted(state))
+    {
+      fprintf(stderr, "failed to walk '%s'\n", argv[a]);
+    }
+  }
+
+  pthread_mutex_lock(&state->queue_mutex);
+  state->walk_done = 1;
+  pthread_cond_broadcast(&state->queue_not_empty);
+  pthread_mutex_unlock(&state->queue_mutex);
+
+  for (long t = 0; t < thread_count; ++t)
+  {
+    pthread_join(threads[t], NULL);
+  }
+
+  if (state->aborted)
+  {
+    fprintf(stderr, "indexing stopped after %zu files, the outputs are incomplete\n", state->files);
+  }
+  else
+  {
+    vrm_index_flush_group(state);
+    state->group.rows = 0;
+    vrm_index_flush_group(state); /* terminator */
+
+    double elapsed = vrm_index_now() - state->start_time;
+    fprintf(stderr, "%zu files (%zu failed), %.1f MiB in %.2f s : %.1f files/s with %ld threads\n",
+      state->files, state->failures, state->bytes / (1024.0 * 1024.0), elapsed,
+      elapsed > 0.0 ? state->files / elapsed : 0.0, thread_count);
+  }
+
+  for (int c = 0; c < COL_COUNT; ++c)
+  {
+    free(state->group.bytes[c]);
+  }
+  fclose(state->csv);
+  fclose(state->vcol);
+
+  if (state->aborted)
+  {
+    return EXIT_FAILURE;
+  }
+  return state->failures ? 2 : EXIT_SUCCESS;
+}